@@ -1,7 +1,13 @@
 ﻿#include "pch.h"
 
 #include "ast.h"
+#include "ast_visitor.h"
+#include "ast_cache.h"
+#include "ast_share.h"
+#include "ast_normalize.h"
 #include "parser.h"
+#include "script_file.h"
+#include "incremental_parser.h"
 #include "EnvironmentDefine.h"
 #include "Environment.h"
 
@@ -10,10 +16,28 @@
 namespace dsl
 {
 
+// ReloadScript를 위해 보관하는 스크립트 정보
+struct DSLManager::ScriptSnapshot
+{
+	std::string text;			// 마지막으로 로드한 스크립트 텍스트 (UTF-8)
+	StatementRangeList ranges;	// AST 최상위 구문의 소스 범위
+
+	// 함수 이름별 정의 수. 같은 이름이 여러 번 정의되었는지 확인한다.
+	// text, ranges와 달리 다음 ReloadScript가 옮겨가므로 m_slock을 잡은 상태에서만 사용한다.
+	std::unordered_map<SymbolId, size_t> functionCount;
+};
+
 DSLManager* DSLManager::sm_pInstance;
 std::mutex DSLManager::sm_lock;
 
 DSLManager::DSLManager()
+	: m_bQuiet(false)
+	, m_bHotReload(false)
+	, m_bLazyFunctionBody(false)
+	, m_bASTCache(false)
+	, m_bShareAST(false)
+	, m_spASTShareTable(std::make_unique<ASTShareTable>())
+	, m_bNormalizeAST(false)
 {
 
 }
@@ -72,7 +96,7 @@ size_t DSLManager::GetASTFunctionCount(const std::wstring& strScriptName) const
 	if (iter == m_ASTFuncMap.end())
 		return 0;
 
-	const std::unordered_map<std::wstring, FunctionDefinitionCPtr>& funcDefinitionMap = iter->second;
+	const ASTFunctionMap& funcDefinitionMap = iter->second;
 
 	return funcDefinitionMap.size();
 }
@@ -96,40 +120,247 @@ ASTPtr DSLManager::GetAST(const std::wstring& scriptName)
 }
 
 // 스크립트 파일 하나를 로드해서 AST를 만든다.
+// 스크립트 파일은 UTF-8 이다. 파일을 메모리에 매핑해서 wchar_t 문자열로 변환하지 않고 바로 파싱한다.
 bool DSLManager::LoadScript(const std::wstring& scriptName)
 {
-	std::wifstream scriptFile(scriptName, std::ios::in | std::ios::binary);
-	if (!scriptFile)
+	// hot reload 모드에서는 전체를 파싱하면서 텍스트와 구문 범위를 보관한다.
+	if (m_bHotReload)
+		return reloadScript(scriptName, false, nullptr);
+
+	ScriptFile scriptFile;
+	if (!scriptFile.Open(scriptName))
 	{
 		std::wcout << std::format(L"스크립트 파일 열기 실패. fileName = {}", scriptName) << std::endl;
 		return false;
 	}
 
-	// 로케일 설정 (시스템 기본 로케일)
-	scriptFile.imbue(std::locale(""));
-
-	std::wstring strScript((std::istreambuf_iterator<wchar_t>(scriptFile)), std::istreambuf_iterator<wchar_t>());
-
-	std::wcout << std::format(L"FileName = {}, Content = {}", scriptName, strScript) << std::endl;
+	if (!m_bQuiet)
+		std::wcout << std::format(L"FileName = {}, Content = {}", scriptName, Utf8ToWide(scriptFile.GetText())) << std::endl;
 
-	// 스크립트로 AST 생성
-	ASTPtr spAST = makeAST(strScript);
+	// 스크립트로 AST 생성. 파서가 함수 정의를 기록하므로 AST를 다시 순회하지 않는다.
+	// AST 캐시 모드이면 캐시 파일을 먼저 읽고, 캐시가 스크립트와 맞지 않을 때만 파싱한다.
+	std::vector<FunctionDefinitionCPtr> functions;
+	const uint64_t sourceHash = m_bASTCache ? HashScriptText(scriptFile.GetText()) : 0;
+	ASTPtr spAST = m_bASTCache ? readASTCache(scriptName, scriptFile.GetText(), sourceHash, functions) : nullptr;
 	if (!spAST)
 	{
-		std::wcout << std::format(L"AST 생성 실패. FileName = {}", scriptName) << std::endl;
-		return false;
+		spAST = makeAST(scriptFile.GetText(), functions);
+		if (!spAST)
+		{
+			std::wcout << std::format(L"AST 생성 실패. FileName = {}", scriptName) << std::endl;
+			return false;
+		}
+
+		if (m_bASTCache)
+			writeASTCache(scriptName, scriptFile.GetText(), sourceHash, *spAST);
 	}
 
-	std::unique_lock lock(m_slock);
+	// 래퍼 노드를 제거한 다음 공유한다. 공유 테이블에는 정규화한 노드만 들어간다.
+	if (m_bNormalizeAST)
+		NormalizeAST(*spAST);
 
-	// AST를 순회하며 사용자 함수를 등록한다.
-	AddASTFunction(scriptName, spAST);
+	// 다른 스크립트와 구조가 같은 하위 트리는 공유 노드로 바꾼다.
+	if (m_bShareAST)
+		spAST = m_spASTShareTable->Share(*spAST, functions);
 
-	m_ASTMap[scriptName] = spAST;
+	// 사용자 함수 map은 lock 없이 만들고, AST와 함께 한 번의 lock으로 반영한다.
+	// 다시 로드한 스크립트는 사용자 함수 map 전체를 교체한다. 교체된 이전 AST와 map은 lock을 놓은 다음에 해제된다.
+	ASTFunctionMap funcDefinitionMap = makeASTFunctionMap(scriptName, functions);
+	{
+		std::unique_lock lock(m_slock);
+
+		m_ASTFuncMap[scriptName].swap(funcDefinitionMap);
+		m_ASTMap[scriptName].swap(spAST);
+		m_snapshotMap.erase(scriptName);
+	}
 
 	return true;
 }
 
+// 수정된 스크립트 파일을 다시 로드한다.
+bool DSLManager::ReloadScript(const std::wstring& scriptName, ReparseStats* pStats /*= nullptr*/)
+{
+	return reloadScript(scriptName, true, pStats);
+}
+
+// 여러 스크립트 파일을 병렬로 로드한다.
+// worker 스레드는 다음 파일 번호를 atomic 변수에서 가져가며, 파서는 스레드별 컨텍스트(ParserContext::GetThreadInstance)를 사용한다.
+bool DSLManager::LoadScripts(const std::vector<std::wstring>& scriptNames, ScriptLoadReport* pReport /*= nullptr*/, size_t threadCount /*= 0*/)
+{
+	using Clock = std::chrono::steady_clock;
+	auto elapsedMs = [](const Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+
+	const Clock::time_point totalStart = Clock::now();
+
+	if (0 == threadCount)
+		threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+	threadCount = (std::min)(threadCount, (std::max)(scriptNames.size(), static_cast<size_t>(1)));
+
+	// 파일별 결과. worker는 자기가 맡은 번호의 원소에만 쓴다.
+	std::vector<ScriptLoadResult> results(scriptNames.size());
+	std::vector<ASTPtr> asts(scriptNames.size());
+	std::vector<ASTFunctionMap> funcDefinitionMaps(scriptNames.size());
+	std::atomic<size_t> nextIndex = 0;
+
+	auto worker = [&]()
+	{
+		ScriptFile scriptFile;
+		for (size_t index = nextIndex++; index < scriptNames.size(); index = nextIndex++)
+		{
+			ScriptLoadResult& result = results[index];
+			result.scriptName = scriptNames[index];
+
+			const Clock::time_point readStart = Clock::now();
+			if (!scriptFile.Open(scriptNames[index]))
+			{
+				std::wcout << std::format(L"스크립트 파일 열기 실패. fileName = {}", scriptNames[index]) << std::endl;
+				continue;
+			}
+			result.fileSize = scriptFile.GetText().size();
+			result.readMs = elapsedMs(readStart);
+
+			const Clock::time_point parseStart = Clock::now();
+			std::vector<FunctionDefinitionCPtr> functions;
+			const uint64_t sourceHash = m_bASTCache ? HashScriptText(scriptFile.GetText()) : 0;
+			asts[index] = m_bASTCache ? readASTCache(scriptNames[index], scriptFile.GetText(), sourceHash, functions) : nullptr;
+			result.bCacheHit = nullptr != asts[index];
+			if (!result.bCacheHit)
+			{
+				ParserContext& context = ParserContext::GetThreadInstance();
+				asts[index] = context.Parse(scriptFile.GetText(), m_bLazyFunctionBody);
+				if (!asts[index])
+				{
+					std::wcout << std::format(L"AST 생성 실패. FileName = {}", scriptNames[index]) << std::endl;
+					continue;
+				}
+				functions = context.TakeLastFunctions();
+
+				if (m_bASTCache)
+					writeASTCache(scriptNames[index], scriptFile.GetText(), sourceHash, *asts[index]);
+			}
+			scriptFile.Close();
+
+			// 래퍼 노드를 제거한다. 함수 목록의 노드는 제자리에서 바뀐다.
+			if (m_bNormalizeAST)
+			{
+				const Clock::time_point normalizeStart = Clock::now();
+				ASTNormalizeStats normalizeStats;
+				NormalizeAST(*asts[index], &normalizeStats);
+				result.removedNodeCount = normalizeStats.removedNodeCount;
+				result.normalizeMs = elapsedMs(normalizeStart);
+			}
+
+			// 다른 스크립트와 구조가 같은 하위 트리는 공유 노드로 바꾼다. 테이블 lock을 잡으므로 스레드끼리 순서대로 한다.
+			if (m_bShareAST)
+			{
+				const Clock::time_point shareStart = Clock::now();
+				ASTShareStats shareStats;
+				asts[index] = m_spASTShareTable->Share(*asts[index], functions, &shareStats);
+				result.nodeCount = shareStats.nodeCount;
+				result.sharedNodeCount = shareStats.sharedNodeCount;
+				result.nodeBytesReclaimed = shareStats.GetReclaimedBytes();
+				result.shareMs = elapsedMs(shareStart);
+			}
+			result.literalCount = asts[index]->constants->GetLiteralCount();
+			result.literalBytesSaved = asts[index]->constants->GetSavedBytes();
+
+			// 사용자 함수 map은 파서가 기록한 함수 목록으로 lock 없이 미리 만들어둔다.
+			funcDefinitionMaps[index] = makeASTFunctionMap(scriptNames[index], functions);
+
+			result.parseMs = elapsedMs(parseStart);
+			result.functionCount = funcDefinitionMaps[index].size();
+			result.bSuccess = true;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (size_t i = 1; i < threadCount; ++i)
+		threads.emplace_back(worker);
+	worker();
+	for (std::thread& thread : threads)
+		thread.join();
+
+	// 한 번의 lock으로 반영한다.
+	// 다시 로드한 스크립트는 사용자 함수 map 전체를 교체한다. (스크립트에서 삭제된 함수는 제거된다.)
+	// 교체된 이전 AST는 swap으로 꺼내서 lock을 놓은 다음에 해제한다.
+	const Clock::time_point publishStart = Clock::now();
+	size_t failCount = 0;
+	size_t cacheHitCount = 0;
+	size_t sharedNodeCount = 0;
+	ptrdiff_t nodeBytesReclaimed = 0;
+	size_t removedNodeCount = 0;
+	{
+		std::unique_lock lock(m_slock);
+
+		for (size_t index = 0; index < scriptNames.size(); ++index)
+		{
+			if (!results[index].bSuccess)
+			{
+				++failCount;
+				continue;
+			}
+			if (results[index].bCacheHit)
+				++cacheHitCount;
+			sharedNodeCount += results[index].sharedNodeCount;
+			nodeBytesReclaimed += results[index].nodeBytesReclaimed;
+			removedNodeCount += results[index].removedNodeCount;
+
+			m_ASTFuncMap[scriptNames[index]].swap(funcDefinitionMaps[index]);
+			m_ASTMap[scriptNames[index]].swap(asts[index]);
+			m_snapshotMap.erase(scriptNames[index]);
+		}
+	}
+	const double publishMs = elapsedMs(publishStart);
+	asts.clear();
+	funcDefinitionMaps.clear();
+	const double totalMs = elapsedMs(totalStart);
+
+	std::wcout << std::format(L"LoadScripts. files={}, fail={}, cache hit={}, threads={}, total={:.1f}ms, publish={:.1f}ms", scriptNames.size(), failCount, cacheHitCount, threadCount, totalMs, publishMs) << std::endl;
+	if (m_bShareAST)
+		std::wcout << std::format(L"ShareAST. shared nodes={}, reclaimed={:.1f}KB", sharedNodeCount, nodeBytesReclaimed / 1024.0) << std::endl;
+	if (m_bNormalizeAST)
+		std::wcout << std::format(L"NormalizeAST. removed nodes={}", removedNodeCount) << std::endl;
+
+	if (pReport)
+	{
+		pReport->results = std::move(results);
+		pReport->threadCount = threadCount;
+		pReport->failCount = failCount;
+		pReport->cacheHitCount = cacheHitCount;
+		pReport->sharedNodeCount = sharedNodeCount;
+		pReport->nodeBytesReclaimed = nodeBytesReclaimed;
+		pReport->removedNodeCount = removedNodeCount;
+		pReport->totalMs = totalMs;
+		pReport->publishMs = publishMs;
+	}
+
+	return 0 == failCount;
+}
+
+// 폴더 안의 모든 .dsl 파일을 로드한다.
+bool DSLManager::LoadScripts(const std::wstring& directory, ScriptLoadReport* pReport /*= nullptr*/, size_t threadCount /*= 0*/)
+{
+	std::error_code error;
+	std::vector<std::wstring> scriptNames;
+	for (std::filesystem::recursive_directory_iterator iter(directory, error), end; !error && iter != end; iter.increment(error))
+	{
+		if (iter->is_regular_file() && L".dsl" == iter->path().extension())
+			scriptNames.push_back(iter->path().wstring());
+	}
+
+	if (error)
+	{
+		std::wcout << std::format(L"스크립트 폴더 읽기 실패. directory = {}", directory) << std::endl;
+		return false;
+	}
+
+	// 파일 순서를 일정하게 한다.
+	std::sort(scriptNames.begin(), scriptNames.end());
+
+	return LoadScripts(scriptNames, pReport, threadCount);
+}
+
 
 // Environment 생성
 EnvironmentPtr DSLManager::MakeEnvironment()
@@ -143,24 +374,26 @@ void DSLManager::AddASTFunction(const std::wstring& scriptName, const ASTCPtr sp
 	if (!spAST)
 		return;
 
-	std::unique_lock lock(m_slock);
-
-	auto astFuncFinder = [this, &scriptName](const BaseCPtr spBase)
-	{
-		if (!spBase)
-			return;
+	// 순회는 lock 없이 한다.
+	std::vector<FunctionDefinitionCPtr> functions;
+	collectASTFunction(spAST, functions);
 
-		if (EASTType::FunctionDefinition != spBase->GetType())
-			return;
+	AddASTFunctions(scriptName, functions);
+}
 
-		const FunctionDefinitionCPtr& spFunctionDefinition = static_pointer_cast<const FunctionDefinition>(spBase);
+// AST 함수 등록. 모든 함수를 한 번의 lock으로 등록한다.
+void DSLManager::AddASTFunctions(const std::wstring& scriptName, const std::vector<FunctionDefinitionCPtr>& functions)
+{
+	if (functions.empty())
+		return;
 
-		// AST 함수 등록
-		AddASTFunction(scriptName, spFunctionDefinition);
-	};
+	std::unique_lock lock(m_slock);
 
-	// 순회
-	spAST->Iterate(astFuncFinder);
+	for (const FunctionDefinitionCPtr& spFunctionDefinition : functions)
+	{
+		if (spFunctionDefinition)
+			insertASTFunction(scriptName, spFunctionDefinition);
+	}
 }
 
 // AST 함수 등록. 인자로 받은 함수 1개만 등록한다.
@@ -171,15 +404,7 @@ void DSLManager::AddASTFunction(const std::wstring& scriptName, const FunctionDe
 
 	std::unique_lock lock(m_slock);
 
-	std::unordered_map<std::wstring, FunctionDefinitionCPtr>& funcDefinitionMap = m_ASTFuncMap[scriptName];
-
-	const NameCPtr spName = static_pointer_cast<const Name>(spFunctionDefinition->name);
-
-	auto iter = funcDefinitionMap.find(spName->name);
-	if (iter != funcDefinitionMap.end())
-		std::wcout << std::format(L"AST function Already Exists. scriptName={}, funcName={}", scriptName, spName->name) << std::endl;
-
-	funcDefinitionMap[spName->name] = spFunctionDefinition;
+	insertASTFunction(scriptName, spFunctionDefinition);
 }
 
 // AST 함수 제거
@@ -191,33 +416,54 @@ void DSLManager::RemoveASTFunction(const std::wstring& scriptName, const std::ws
 	if (iter == m_ASTFuncMap.end())
 		return;
 
-	std::unordered_map<std::wstring, FunctionDefinitionCPtr>& funcDefinitionMap = iter->second;
+	ASTFunctionMap& funcDefinitionMap = iter->second;
 
-	funcDefinitionMap.erase(funcName);
+	funcDefinitionMap.erase(FindSymbol(funcName));
 }
 
 // AST 함수 가져오기
-const FunctionDefinitionCPtr& DSLManager::GetASTFunction(const std::wstring& scriptName, const std::wstring& funcName)
+FunctionDefinitionCPtr DSLManager::GetASTFunction(const std::wstring& scriptName, const std::wstring& funcName)
 {
-	static const FunctionDefinitionCPtr empty = nullptr;
+	return GetASTFunction(scriptName, FindSymbol(funcName));
+}
 
-	std::shared_lock lock(m_slock);
+// AST 함수 가져오기
+// 함수는 lock을 잡고 복사해서 반환한다. 다른 스레드가 스크립트를 다시 로드해서 map을 교체해도 반환한 함수는 유효하다.
+FunctionDefinitionCPtr DSLManager::GetASTFunction(const std::wstring& scriptName, const SymbolId funcId)
+{
+	FunctionDefinitionCPtr spFunctionDefinition;
+	{
+		std::shared_lock lock(m_slock);
 
-	auto iter = m_ASTFuncMap.find(scriptName);
-	if (iter == m_ASTFuncMap.end())
-		return empty;
+		auto iter = m_ASTFuncMap.find(scriptName);
+		if (iter == m_ASTFuncMap.end())
+			return nullptr;
+
+		const ASTFunctionMap& funcDefinitionMap = iter->second;
+
+		auto iter2 = funcDefinitionMap.find(funcId);
+		if (iter2 == funcDefinitionMap.end())
+			return nullptr;
 
-	const std::unordered_map<std::wstring, FunctionDefinitionCPtr>& funcDefinitionMap = iter->second;
+		spFunctionDefinition = iter2->second;
+	}
+
+	// 지연 파싱하는 함수는 처음 찾을 때 본문을 파싱한다. 다른 스레드가 파싱 중이라면 끝날 때까지 기다린다.
+	// 파싱하는 동안 로드, 다시 로드가 기다리지 않도록 lock을 놓고 파싱한다.
+	if (!spFunctionDefinition->GetBlock())
+		return nullptr;
 
-	auto iter2 = funcDefinitionMap.find(funcName);
-	if (iter2 == funcDefinitionMap.end())
-		return empty;
-		
-	return iter2->second;
+	return spFunctionDefinition;
 }
 
 // AST 함수 존재 여부 확인
 bool DSLManager::HasASTFunction(const std::wstring& scriptName, const std::wstring& funcName) const
+{
+	return HasASTFunction(scriptName, FindSymbol(funcName));
+}
+
+// AST 함수 존재 여부 확인
+bool DSLManager::HasASTFunction(const std::wstring& scriptName, const SymbolId funcId) const
 {
 	std::shared_lock lock(m_slock);
 
@@ -225,9 +471,9 @@ bool DSLManager::HasASTFunction(const std::wstring& scriptName, const std::wstri
 	if (iter == m_ASTFuncMap.end())
 		return false;
 
-	const std::unordered_map<std::wstring, FunctionDefinitionCPtr>& funcDefinitionMap = iter->second;
+	const ASTFunctionMap& funcDefinitionMap = iter->second;
 
-	return funcDefinitionMap.contains(funcName);
+	return funcDefinitionMap.contains(funcId);
 }
 
 
@@ -235,15 +481,21 @@ bool DSLManager::HasASTFunction(const std::wstring& scriptName, const std::wstri
 void DSLManager::RemoveApiFunction(const std::wstring& name)
 {
 	std::unique_lock lock(m_slock);
-	m_apiFuncMap.erase(name);
+	m_apiFuncMap.erase(FindSymbol(name));
 }
 
 // 함수 가져오기
 DSLManager::FunctionType DSLManager::GetApiFunction(const std::wstring& name)
+{
+	return GetApiFunction(FindSymbol(name));
+}
+
+// 함수 가져오기
+DSLManager::FunctionType DSLManager::GetApiFunction(const SymbolId funcId)
 {
 	std::shared_lock lock(m_slock);
 
-	auto iter = m_apiFuncMap.find(name);
+	auto iter = m_apiFuncMap.find(funcId);
 	if (iter != m_apiFuncMap.end())
 		return iter->second;
 
@@ -252,17 +504,30 @@ DSLManager::FunctionType DSLManager::GetApiFunction(const std::wstring& name)
 
 // 함수 실행 (인자값 전달)
 std::any DSLManager::ExecuteApiFunction(const std::wstring& name, const std::vector<std::any>& args)
+{
+	const SymbolId funcId = FindSymbol(name);
+	if (InvalidSymbolId == funcId)
+	{
+		std::wcout << L"API Function '" + name + L"' not found" << std::endl;
+		return 0;
+	}
+
+	return ExecuteApiFunction(funcId, args);
+}
+
+// 함수 실행 (인자값 전달)
+std::any DSLManager::ExecuteApiFunction(const SymbolId funcId, const std::vector<std::any>& args)
 {
 	std::shared_lock lock(m_slock);
 
-	auto it = m_apiFuncMap.find(name);
+	auto it = m_apiFuncMap.find(funcId);
 	if (it != m_apiFuncMap.end())
 	{
 		return it->second(args);
 	}
 	else
 	{
-		std::wcout << L"API Function '" + name + L"' not found" << std::endl;
+		std::wcout << L"API Function '" + GetSymbolName(funcId) + L"' not found" << std::endl;
 	}
 
 	return 0;
@@ -270,10 +535,16 @@ std::any DSLManager::ExecuteApiFunction(const std::wstring& name, const std::vec
 
 // 함수 존재 여부 확인
 bool DSLManager::HasApiFunction(const std::wstring& name) const
+{
+	return HasApiFunction(FindSymbol(name));
+}
+
+// 함수 존재 여부 확인
+bool DSLManager::HasApiFunction(const SymbolId funcId) const
 {
 	std::shared_lock lock(m_slock);
 
-	return m_apiFuncMap.contains(name);
+	return m_apiFuncMap.contains(funcId);
 }
 
 // API 함수 map 초기화
@@ -306,10 +577,226 @@ void DSLManager::initializeApiFunctionMap()
 	);
 }
 
+// 노드와 하위 노드를 순회하며 사용자 함수를 모은다.
+void DSLManager::collectASTFunction(const BaseCPtr& spBase, std::vector<FunctionDefinitionCPtr>& functions)
+{
+	WalkAST(spBase, [&functions](const auto& node, const auto& spNode)
+		{
+			if constexpr (std::is_same_v<std::decay_t<decltype(node)>, FunctionDefinition>)
+				functions.push_back(static_pointer_cast<const FunctionDefinition>(spNode));
+		});
+}
+
+// 함수 목록으로 사용자 함수 map을 만든다.
+DSLManager::ASTFunctionMap DSLManager::makeASTFunctionMap(const std::wstring& scriptName, const std::vector<FunctionDefinitionCPtr>& functions, std::unordered_map<SymbolId, size_t>* pFunctionCount /*= nullptr*/)
+{
+	ASTFunctionMap funcDefinitionMap;
+	funcDefinitionMap.reserve(functions.size());
+	if (pFunctionCount)
+		pFunctionCount->clear();
+
+	for (const FunctionDefinitionCPtr& spFunctionDefinition : functions)
+	{
+		const Name* pName = NodeCast<Name>(spFunctionDefinition->name);
+		if (!funcDefinitionMap.emplace(pName->id, spFunctionDefinition).second)
+		{
+			std::wcout << std::format(L"AST function Already Exists. scriptName={}, funcName={}", scriptName, pName->GetName()) << std::endl;
+			funcDefinitionMap[pName->id] = spFunctionDefinition;
+		}
+
+		if (pFunctionCount)
+			++(*pFunctionCount)[pName->id];
+	}
+
+	return funcDefinitionMap;
+}
+
+// 사용자 함수 등록. m_slock을 잡은 상태에서 호출한다.
+void DSLManager::insertASTFunction(const std::wstring& scriptName, const FunctionDefinitionCPtr& spFunctionDefinition)
+{
+	ASTFunctionMap& funcDefinitionMap = m_ASTFuncMap[scriptName];
+
+	const Name* pName = NodeCast<Name>(spFunctionDefinition->name);
+
+	auto iter = funcDefinitionMap.find(pName->id);
+	if (iter != funcDefinitionMap.end())
+		std::wcout << std::format(L"AST function Already Exists. scriptName={}, funcName={}", scriptName, pName->GetName()) << std::endl;
+
+	funcDefinitionMap[pName->id] = spFunctionDefinition;
+}
+
 // 스크립트를 파싱해서 AST를 만든다.
-ASTPtr DSLManager::makeAST(std::wstring& strScript)
+// quiet 모드에서는 AST를 출력하지 않는다.
+ASTPtr DSLManager::makeAST(std::string_view strUtf8Script, std::vector<FunctionDefinitionCPtr>& functions)
+{
+	ParserContext& context = ParserContext::GetThreadInstance();
+	ASTPtr spAST = context.Parse(strUtf8Script, m_bLazyFunctionBody);
+	functions = context.TakeLastFunctions();
+	if (!spAST || m_bQuiet)
+		return spAST;
+
+	std::wcout << L"AST Parsing Success!" << std::endl;
+	spAST->Print();
+
+	const ParseStats& stats = context.GetLastStats();
+	std::wcout << std::format(L"Constant Pool. literals={}, constants={}, saved={} bytes", stats.literalCount, stats.constantCount, stats.literalBytesSaved) << std::endl;
+
+	return spAST;
+}
+
+// AST 캐시 파일로 AST를 만든다.
+ASTPtr DSLManager::readASTCache(const std::wstring& scriptName, std::string_view strUtf8Script, const uint64_t sourceHash, std::vector<FunctionDefinitionCPtr>& functions) const
 {
-	return ParseScript(strScript);
+	ASTPtr spAST = ReadASTCache(GetASTCachePath(scriptName, m_strASTCacheDirectory), strUtf8Script, sourceHash, m_bLazyFunctionBody, functions);
+	if (!spAST || m_bQuiet)
+		return spAST;
+
+	std::wcout << L"AST Cache Hit!" << std::endl;
+	spAST->Print();
+
+	return spAST;
+}
+
+// AST 캐시 파일을 쓴다.
+void DSLManager::writeASTCache(const std::wstring& scriptName, std::string_view strUtf8Script, const uint64_t sourceHash, const AST& ast) const
+{
+	const std::wstring cachePath = GetASTCachePath(scriptName, m_strASTCacheDirectory);
+	if (!WriteASTCache(cachePath, ast, sourceHash, strUtf8Script.size()))
+		std::wcout << std::format(L"AST 캐시 쓰기 실패. FileName = {}, cachePath = {}", scriptName, cachePath) << std::endl;
+}
+
+// 스크립트를 IncrementalParser로 로드하고 텍스트를 보관한다.
+// 파싱과 사용자 함수 수집은 lock 없이 하고, 반영할 때만 lock을 한 번 잡는다.
+bool DSLManager::reloadScript(const std::wstring& scriptName, const bool bIncremental, ReparseStats* pStats)
+{
+	// 이전 AST와 텍스트
+	ASTPtr spOldAST;
+	ScriptSnapshotPtr spOldSnapshot;
+	if (bIncremental)
+	{
+		std::shared_lock lock(m_slock);
+
+		const auto iterAST = m_ASTMap.find(scriptName);
+		const auto iterSnapshot = m_snapshotMap.find(scriptName);
+		if (iterAST != m_ASTMap.end() && iterSnapshot != m_snapshotMap.end())
+		{
+			spOldAST = iterAST->second;
+			spOldSnapshot = iterSnapshot->second;
+		}
+	}
+
+	ScriptFile scriptFile;
+	if (!scriptFile.Open(scriptName))
+	{
+		std::wcout << std::format(L"스크립트 파일 열기 실패. fileName = {}", scriptName) << std::endl;
+		return false;
+	}
+
+	// 보관한 텍스트가 있으면 바뀐 구문만 파싱한다.
+	const std::string_view strScript = scriptFile.GetText();
+	ScriptSnapshotPtr spSnapshot = std::make_shared<ScriptSnapshot>();
+
+	IncrementalParser parser;
+	ASTPtr spAST = spOldSnapshot
+		? parser.Reparse(spOldSnapshot->text, strScript, spOldAST, spOldSnapshot->ranges, spSnapshot->ranges)
+		: parser.Parse(strScript, spSnapshot->ranges);
+	if (!spAST)
+	{
+		std::wcout << std::format(L"AST 생성 실패. FileName = {}", scriptName) << std::endl;
+		return false;
+	}
+	spSnapshot->text.assign(strScript);
+	scriptFile.Close();
+
+	const ReparseStats stats = parser.GetLastStats();
+
+	// 교체된 구문에 있던 함수와 새로 파싱한 구문의 함수
+	// 새로 파싱한 구문의 함수는 파서가 기록한다. 교체된 구문만 순회한다.
+	std::vector<FunctionDefinitionCPtr> removedFunctions;
+	const std::vector<FunctionDefinitionCPtr>& addedFunctions = parser.GetLastFunctions();
+	if (spOldSnapshot)
+	{
+		const std::vector<BasePtr>& oldStatements = static_cast<const Block&>(*spOldAST->block).statements;
+		for (size_t i = 0; i < stats.removedStatementCount; ++i)
+			collectASTFunction(oldStatements[stats.firstStatement + i], removedFunctions);
+	}
+
+	// 전체를 파싱했다면 함수 map도 lock 밖에서 전부 만든다.
+	ASTFunctionMap funcDefinitionMap;
+	if (!spOldSnapshot)
+		funcDefinitionMap = makeASTFunctionMap(scriptName, addedFunctions, &spSnapshot->functionCount);
+
+	// 한 번의 lock으로 반영한다.
+	// 교체된 이전 AST는 swap으로 꺼내서 lock을 놓은 다음에 해제한다.
+	{
+		std::unique_lock lock(m_slock);
+
+		ASTFunctionMap& currentFuncDefinitionMap = m_ASTFuncMap[scriptName];
+		if (!spOldSnapshot)
+		{
+			currentFuncDefinitionMap.swap(funcDefinitionMap);
+		}
+		else
+		{
+			// 파싱하는 동안 다른 곳에서 이 스크립트를 다시 로드했다면 바뀐 함수만 반영할 수 없다.
+			const auto iterSnapshot = m_snapshotMap.find(scriptName);
+			bool bRebuild = (iterSnapshot == m_snapshotMap.end() || iterSnapshot->second != spOldSnapshot);
+
+			// 바뀐 함수만 반영한다. 이전 정의 수는 옮겨받아서 바뀐 이름만 고친다.
+			if (!bRebuild)
+			{
+				spSnapshot->functionCount = std::move(spOldSnapshot->functionCount);
+				for (const FunctionDefinitionCPtr& spFunctionDefinition : removedFunctions)
+				{
+					const SymbolId funcId = NodeCast<Name>(spFunctionDefinition->name)->id;
+					const auto iterCount = spSnapshot->functionCount.find(funcId);
+					if (iterCount == spSnapshot->functionCount.end() || iterCount->second > 1)
+					{
+						bRebuild = true;
+						break;
+					}
+
+					spSnapshot->functionCount.erase(iterCount);
+					currentFuncDefinitionMap.erase(funcId);
+				}
+
+				for (const FunctionDefinitionCPtr& spFunctionDefinition : addedFunctions)
+				{
+					if (bRebuild)
+						break;
+
+					const SymbolId funcId = NodeCast<Name>(spFunctionDefinition->name)->id;
+					if (++spSnapshot->functionCount[funcId] > 1)
+						bRebuild = true;
+					currentFuncDefinitionMap[funcId] = spFunctionDefinition;
+				}
+			}
+
+			// 같은 이름의 함수가 여러 번 정의되어 있으면 구문 순서상 마지막 정의가 등록되어야 하므로 함수 map 전체를 다시 만든다.
+			// 중복 정의는 드물기 때문에 lock 안에서 만든다.
+			if (bRebuild)
+			{
+				std::vector<FunctionDefinitionCPtr> functions;
+				collectASTFunction(spAST, functions);
+				funcDefinitionMap = makeASTFunctionMap(scriptName, functions, &spSnapshot->functionCount);
+				currentFuncDefinitionMap.swap(funcDefinitionMap);
+			}
+		}
+
+		m_ASTMap[scriptName].swap(spAST);
+		m_snapshotMap[scriptName] = std::move(spSnapshot);
+	}
+
+	if (!m_bQuiet)
+	{
+		std::wcout << std::format(L"ReloadScript. FileName = {}, reused={}, parsed={}, removed={}, parsedBytes={}, functions(+{}, -{})",
+			scriptName, stats.reusedStatementCount, stats.parsedStatementCount, stats.removedStatementCount, stats.parsedLength, addedFunctions.size(), removedFunctions.size()) << std::endl;
+	}
+
+	if (pStats)
+		*pStats = stats;
+
+	return true;
 }
 
 }
\ No newline at end of file
@@ -4,6 +4,42 @@
 
 namespace dsl
 {
+	struct ReparseStats;
+	class ASTShareTable;
+
+	// 스크립트 파일 1개의 로드 결과 (LoadScripts)
+	struct ScriptLoadResult
+	{
+		std::wstring scriptName;
+		bool bSuccess = false;
+		size_t fileSize = 0;			// bytes
+		size_t functionCount = 0;		// 등록한 사용자 함수 수
+		size_t literalCount = 0;		// 문자열 리터럴 수
+		size_t literalBytesSaved = 0;	// 상수 풀에서 중복을 제거해서 줄어든 리터럴 크기 (bytes)
+		double readMs = 0.0;			// 파일 열기
+		double parseMs = 0.0;			// 파싱(또는 AST 캐시 읽기) + 정규화 + 노드 공유 + 사용자 함수 수집
+		double shareMs = 0.0;			// 노드 공유 (parseMs에 포함)
+		double normalizeMs = 0.0;		// AST 정규화 (parseMs에 포함)
+		bool bCacheHit = false;			// AST 캐시로 로드했는지 여부
+		size_t nodeCount = 0;			// AST 노드 수 (노드 공유 모드)
+		size_t sharedNodeCount = 0;		// 다른 스크립트와 공유한 노드 수 (노드 공유 모드)
+		ptrdiff_t nodeBytesReclaimed = 0;	// 노드를 공유해서 줄어든 노드 메모리 (bytes, 노드 공유 모드)
+		size_t removedNodeCount = 0;	// 제거한 래퍼 노드 수 (정규화 모드)
+	};
+
+	// 여러 스크립트 파일의 로드 결과 (LoadScripts)
+	struct ScriptLoadReport
+	{
+		std::vector<ScriptLoadResult> results;	// 요청한 파일 순서와 같다.
+		size_t threadCount = 0;
+		size_t failCount = 0;
+		size_t cacheHitCount = 0;		// AST 캐시로 로드한 파일 수
+		size_t sharedNodeCount = 0;		// 다른 스크립트와 공유한 노드 수 (노드 공유 모드)
+		ptrdiff_t nodeBytesReclaimed = 0;	// 노드를 공유해서 줄어든 노드 메모리 (bytes, 노드 공유 모드)
+		size_t removedNodeCount = 0;	// 제거한 래퍼 노드 수 (정규화 모드)
+		double totalMs = 0.0;			// 전체 시간
+		double publishMs = 0.0;			// lock을 잡고 m_ASTMap, m_ASTFuncMap에 반영한 시간
+	};
 
 	class DSLManager
 	{
@@ -23,6 +59,41 @@ namespace dsl
 	public:
 		bool Initialize();
 
+		// quiet 모드에서는 스크립트 내용과 AST를 출력하지 않는다.
+		void SetQuiet(const bool bQuiet) { m_bQuiet = bQuiet; }
+		bool IsQuiet() const { return m_bQuiet; }
+
+		// hot reload 모드에서는 LoadScript가 스크립트 텍스트와 구문 범위를 보관해서, 다음 ReloadScript가 바뀐 구문만 파싱할 수 있게 한다.
+		void SetHotReload(const bool bHotReload) { m_bHotReload = bHotReload; }
+		bool IsHotReload() const { return m_bHotReload; }
+
+		// lazy 모드에서는 LoadScript, LoadScripts가 함수 본문을 파싱하지 않고 소스 범위만 기록한다.
+		// 본문은 GetASTFunction으로 처음 찾을 때 파싱한다. hot reload 모드의 LoadScript는 항상 전체를 파싱한다.
+		void SetLazyFunctionBody(const bool bLazyFunctionBody) { m_bLazyFunctionBody = bLazyFunctionBody; }
+		bool IsLazyFunctionBody() const { return m_bLazyFunctionBody; }
+
+		// AST 캐시 모드에서는 LoadScript, LoadScripts가 파싱한 AST를 캐시 파일(.dslc)로 저장하고,
+		// 다음 로드에서 스크립트 텍스트의 해시가 같으면 파싱하지 않고 캐시 파일로 AST를 만든다. (ast_cache.h)
+		// 지연 파싱 모드의 캐시는 파싱하지 않은 함수 본문을 텍스트 범위로 저장한다. 지연 파싱 모드가 아니면 이런 캐시는 사용하지 않고 다시 파싱한다.
+		// hot reload 모드의 LoadScript는 캐시를 사용하지 않는다.
+		void SetASTCache(const bool bASTCache) { m_bASTCache = bASTCache; }
+		bool IsASTCache() const { return m_bASTCache; }
+
+		// 캐시 파일을 저장할 폴더. 비어있으면 스크립트 파일 옆에 저장한다. (기본값)
+		// 로드하는 동안 바꾸면 안 된다.
+		void SetASTCacheDirectory(const std::wstring& directory) { m_strASTCacheDirectory = directory; }
+		const std::wstring& GetASTCacheDirectory() const { return m_strASTCacheDirectory; }
+
+		// 노드 공유 모드에서는 LoadScript, LoadScripts가 로드한 AST를 다른 스크립트와 구조가 같은 하위 트리를 공유하도록 다시 만든다. (ast_share.h)
+		// 원래 AST의 아레나는 해제되고, 다른 스크립트에 없는 노드만 새로 할당한다. hot reload 모드의 LoadScript와 ReloadScript는 공유하지 않는다.
+		void SetShareAST(const bool bShareAST) { m_bShareAST = bShareAST; }
+		bool IsShareAST() const { return m_bShareAST; }
+
+		// 정규화 모드에서는 LoadScript, LoadScripts가 로드한 AST에서 Expression, Statement 같은 래퍼 노드를 제거한다. (ast_normalize.h)
+		// 캐시 파일에는 정규화하기 전의 AST를 저장한다. hot reload 모드의 LoadScript와 ReloadScript는 정규화하지 않는다.
+		void SetNormalizeAST(const bool bNormalizeAST) { m_bNormalizeAST = bNormalizeAST; }
+		bool IsNormalizeAST() const { return m_bNormalizeAST; }
+
 	public:
 		size_t GetASTFunctionCount() const;
 		size_t GetASTFunctionCount(const std::wstring& strScriptName) const;
@@ -33,14 +104,38 @@ namespace dsl
 		/* AST */
 		bool LoadScript(const std::wstring& scriptName);
 
+		// 수정된 스크립트 파일을 다시 로드한다.
+		// 이전에 보관한 텍스트와 비교해서 바뀐 최상위 구문만 다시 파싱하고, 바뀌지 않은 구문은 이전 AST의 노드를 그대로 사용한다.
+		// 사용자 함수 map은 바뀐 구문에 있던 함수와 새로 파싱한 구문의 함수만 교체한다.
+		// 보관한 텍스트가 없으면 전체를 파싱하고, 이후의 ReloadScript를 위해 텍스트를 보관한다.
+		// @pStats	: 재사용, 파싱한 구문 수 (nullptr 가능)
+		bool ReloadScript(const std::wstring& scriptName, ReparseStats* pStats = nullptr);
+
+		// 여러 스크립트 파일을 worker 스레드에서 병렬로 로드한다.
+		// 파일 읽기, 파싱, 사용자 함수 수집은 lock 없이 각 스레드에서 하고, 모두 끝난 다음 lock을 한 번만 잡고 반영한다.
+		// 실패한 파일은 반영하지 않는다. 보관한 텍스트는 버리므로 다음 ReloadScript는 전체를 파싱한다.
+		// @threadCount	: worker 스레드 수. 0이면 하드웨어 스레드 수
+		// @pReport		: 파일별, 전체 소요시간 (nullptr 가능)
+		// @return		: 모든 파일을 로드했는지 여부
+		bool LoadScripts(const std::vector<std::wstring>& scriptNames, ScriptLoadReport* pReport = nullptr, size_t threadCount = 0);
+
+		// 폴더 안의 모든 .dsl 파일을 로드한다. (하위 폴더 포함)
+		bool LoadScripts(const std::wstring& directory, ScriptLoadReport* pReport = nullptr, size_t threadCount = 0);
+
 		EnvironmentPtr MakeEnvironment();
 
 		/* AST Function */
 		void AddASTFunction(const std::wstring& scriptName, const ASTCPtr spAST);
 		void AddASTFunction(const std::wstring& scriptName, const FunctionDefinitionCPtr spFunctionDefinition);
+
+		// 여러 사용자 함수를 lock을 한 번만 잡고 등록한다. 같은 이름이 있으면 뒤의 함수가 등록된다.
+		// 파서가 기록한 함수 목록(ParserContext::GetLastFunctions)을 등록할 때 사용한다.
+		void AddASTFunctions(const std::wstring& scriptName, const std::vector<FunctionDefinitionCPtr>& functions);
 		void RemoveASTFunction(const std::wstring& scriptName, const std::wstring& funcName);
-		const FunctionDefinitionCPtr& GetASTFunction(const std::wstring& scriptName, const std::wstring& funcName);
+		FunctionDefinitionCPtr GetASTFunction(const std::wstring& scriptName, const std::wstring& funcName);
+		FunctionDefinitionCPtr GetASTFunction(const std::wstring& scriptName, const SymbolId funcId);
 		bool HasASTFunction(const std::wstring& scriptName, const std::wstring& funcName) const;
+		bool HasASTFunction(const std::wstring& scriptName, const SymbolId funcId) const;
 
 		/* API Function */
 		template<typename... Args>
@@ -48,12 +143,46 @@ namespace dsl
 
 		void RemoveApiFunction(const std::wstring& name);
 		FunctionType GetApiFunction(const std::wstring& name);
+		FunctionType GetApiFunction(const SymbolId funcId);
 		std::any ExecuteApiFunction(const std::wstring& name, const std::vector<std::any>& args = {});
+		std::any ExecuteApiFunction(const SymbolId funcId, const std::vector<std::any>& args = {});
 		bool HasApiFunction(const std::wstring& name) const;
+		bool HasApiFunction(const SymbolId funcId) const;
 
 	private:
+		// ReloadScript를 위해 보관하는 스크립트 정보. 정의는 DSLManager.cpp에 있다.
+		struct ScriptSnapshot;
+		using ScriptSnapshotPtr = std::shared_ptr<ScriptSnapshot>;
+
+		// 스크립트 하나의 사용자 함수 map. Key=함수 이름의 심볼 ID, Value=Function AST객체
+		using ASTFunctionMap = std::unordered_map<SymbolId, FunctionDefinitionCPtr>;
+
 		void initializeApiFunctionMap();
-		ASTPtr makeAST(std::wstring& strScript);
+
+		// 스크립트를 파싱해서 AST를 만든다. functions에는 파서가 기록한 함수 정의를 받는다.
+		ASTPtr makeAST(std::string_view strUtf8Script, std::vector<FunctionDefinitionCPtr>& functions);
+
+		// AST 캐시 파일로 AST를 만든다. 캐시 파일이 없거나 스크립트와 맞지 않으면 nullptr를 반환한다.
+		ASTPtr readASTCache(const std::wstring& scriptName, std::string_view strUtf8Script, const uint64_t sourceHash, std::vector<FunctionDefinitionCPtr>& functions) const;
+
+		// AST 캐시 파일을 쓴다. 실패하면 로그만 남긴다.
+		void writeASTCache(const std::wstring& scriptName, std::string_view strUtf8Script, const uint64_t sourceHash, const AST& ast) const;
+
+		// 스크립트를 IncrementalParser로 로드하고 텍스트를 보관한다.
+		// @bIncremental	: 보관한 텍스트가 있으면 바뀐 구문만 파싱한다.
+		bool reloadScript(const std::wstring& scriptName, const bool bIncremental, ReparseStats* pStats);
+
+		// 노드와 하위 노드에서 사용자 함수를 모은다. lock을 잡지 않는다.
+		// 파서가 함수 목록을 기록하므로 로드할 때는 사용하지 않는다. 외부에서 만든 AST와 hot reload에서 교체된 구문에만 사용한다.
+		static void collectASTFunction(const BaseCPtr& spBase, std::vector<FunctionDefinitionCPtr>& functions);
+
+		// 함수 목록으로 사용자 함수 map을 만든다. lock을 잡지 않는다.
+		// 같은 이름의 함수가 여러 번 정의되어 있으면 마지막 정의가 등록된다.
+		// @pFunctionCount	: 함수 이름별 정의 수 (nullptr 가능)
+		static ASTFunctionMap makeASTFunctionMap(const std::wstring& scriptName, const std::vector<FunctionDefinitionCPtr>& functions, std::unordered_map<SymbolId, size_t>* pFunctionCount = nullptr);
+
+		// 사용자 함수 등록. 호출하는 쪽에서 m_slock을 잡고 있어야 한다.
+		void insertASTFunction(const std::wstring& scriptName, const FunctionDefinitionCPtr& spFunctionDefinition);
 
 	private:
 
@@ -88,19 +217,43 @@ namespace dsl
 		// lock
 		mutable std::shared_mutex m_slock;
 
+		// 스크립트 내용, AST 출력 여부
+		std::atomic<bool> m_bQuiet;
+
+		// LoadScript에서 ReloadScript를 위한 텍스트를 보관할지 여부
+		std::atomic<bool> m_bHotReload;
+
+		// 함수 본문을 처음 사용할 때 파싱할지 여부
+		std::atomic<bool> m_bLazyFunctionBody;
+
+		// 파싱한 AST를 캐시 파일로 저장하고 다음 로드에서 사용할지 여부
+		std::atomic<bool> m_bASTCache;
+		std::wstring m_strASTCacheDirectory;
+
+		// 로드한 AST의 노드를 스크립트끼리 공유할지 여부와 공유 노드 테이블
+		std::atomic<bool> m_bShareAST;
+		std::unique_ptr<ASTShareTable> m_spASTShareTable;
+
+		// 로드한 AST의 래퍼 노드를 제거할지 여부
+		std::atomic<bool> m_bNormalizeAST;
+
 		// AST map
 		// Key=script 파일명, Value=AST
 		std::unordered_map<std::wstring, ASTPtr> m_ASTMap;
 
 		// 사용자 함수 map
 		// 사용자 함수는 스크립트 내에서 사용할 수 있는 함수이다.
-		// Key=script 파일명, Value=<Key=함수명, Value=Function AST객체>
-		std::unordered_map<std::wstring, std::unordered_map<std::wstring, FunctionDefinitionCPtr>> m_ASTFuncMap;
+		// Key=script 파일명, Value=<Key=함수 이름의 심볼 ID, Value=Function AST객체>
+		std::unordered_map<std::wstring, ASTFunctionMap> m_ASTFuncMap;
+
+		// ReloadScript를 위해 보관한 스크립트 정보
+		// Key=script 파일명, Value=마지막으로 로드한 텍스트와 구문 범위
+		std::unordered_map<std::wstring, ScriptSnapshotPtr> m_snapshotMap;
 
 		// API 함수 map
 		// API 함수는 모든 스크립트에서 공용으로 사용할 수 있는 함수이다.
-		// Key=함수명, Value=함수
-		std::unordered_map<std::wstring, FunctionType> m_apiFuncMap;
+		// Key=함수 이름의 심볼 ID, Value=함수
+		std::unordered_map<SymbolId, FunctionType> m_apiFuncMap;
 	};
 
 
@@ -120,12 +273,14 @@ namespace dsl
 				return callFunction<Args...>(func, args, std::make_index_sequence<sizeof...(Args)>{});
 			};
 
+		const SymbolId funcId = InternSymbol(funcName);
+
 		std::unique_lock lock(m_slock);
 
-		if (m_apiFuncMap.contains(funcName))
+		if (m_apiFuncMap.contains(funcId))
 			std::wcout << std::format(L"function already exists. funcName={}", funcName) << std::endl;
 
-		m_apiFuncMap[funcName] = wrapper;
+		m_apiFuncMap[funcId] = wrapper;
 	}
 
 
@@ -153,65 +153,65 @@ namespace dsl
 
 		case EASTType::AST:
 		{
-			const ASTCPtr& spAST = static_pointer_cast<const AST>(spBase);
-			m_callStack.emplace_back(spAST->block);
+			const AST& ast = static_cast<const AST&>(*spBase);
+			m_callStack.emplace_back(ast.block);
 			return true;
 		}
 
 		case EASTType::Block:
 		{
-			const BlockCPtr& spBlock = static_pointer_cast<const Block>(spBase);
-			for (size_t i = spBlock->statements.size() - 1; i <= 0; --i)
+			const Block& block = static_cast<const Block&>(*spBase);
+			for (size_t i = block.statements.size() - 1; i <= 0; --i)
 			{
-				m_callStack.emplace_back(spBlock->statements[i]);
+				m_callStack.emplace_back(block.statements[i]);
 			}
 			return true;
 		}
 
 		case EASTType::Assignment:
 		{
-			const AssignmentCPtr& spAssignment = static_pointer_cast<const Assignment>(spBase);
-			m_callStack.emplace_back(spAssignment->expression);
-			m_callStack.emplace_back(spAssignment->name);
+			const Assignment& assignment = static_cast<const Assignment&>(*spBase);
+			m_callStack.emplace_back(assignment.expression);
+			m_callStack.emplace_back(assignment.name);
 			return true;
 		}
 
 		case EASTType::Expression:
 		{
-			const ExpressionCPtr& spExpression = static_pointer_cast<const Expression>(spBase);
-			m_callStack.emplace_back(spExpression->expression);
+			const Expression& expression = static_cast<const Expression&>(*spBase);
+			m_callStack.emplace_back(expression.expression);
 			return true;
 		}
 
 		case EASTType::ExpressionList:
 		{
-			const ExpressionListCPtr& spExpressionList = static_pointer_cast<const ExpressionList>(spBase);
-			for (int i = spExpressionList->expressions.size() - 1; i <= 0; --i)
+			const ExpressionList& expressionList = static_cast<const ExpressionList&>(*spBase);
+			for (int i = expressionList.expressions.size() - 1; i <= 0; --i)
 			{
-				m_callStack.emplace_back(spExpressionList->expressions[i]);
+				m_callStack.emplace_back(expressionList.expressions[i]);
 			}
 			return true;
 		}
 
 		case EASTType::PrimaryExpression:
 		{
-			const PrimaryExpressionCPtr& spPrimaryExpression = static_pointer_cast<const PrimaryExpression>(spBase);
-			m_callStack.emplace_back(spPrimaryExpression->primaryExpression);
+			const PrimaryExpression& primaryExpression = static_cast<const PrimaryExpression&>(*spBase);
+			m_callStack.emplace_back(primaryExpression.primaryExpression);
 			return true;
 		}
 
 		case EASTType::BinaryExpression:
 		{
-			const BinaryExpressionCPtr& spBinaryExpression = static_pointer_cast<const BinaryExpression>(spBase);
-			m_callStack.emplace_back(spBinaryExpression->primaryExpression2);
-			m_callStack.emplace_back(spBinaryExpression->primaryExpression1);
+			const BinaryExpression& binaryExpression = static_cast<const BinaryExpression&>(*spBase);
+			m_callStack.emplace_back(binaryExpression.primaryExpression2);
+			m_callStack.emplace_back(binaryExpression.primaryExpression1);
 			return true;
 		}
 
 		case EASTType::UnaryExpression:
 		{
-			const UnaryExpressionCPtr& spUnaryExpression = static_pointer_cast<const UnaryExpression>(spBase);
-			m_callStack.emplace_back(spUnaryExpression->primaryExpression);
+			const UnaryExpression& unaryExpression = static_cast<const UnaryExpression&>(*spBase);
+			m_callStack.emplace_back(unaryExpression.primaryExpression);
 			return true;
 		}
 
@@ -222,30 +222,30 @@ namespace dsl
 
 		case EASTType::FunctionParameter:
 		{
-			const FunctionParameterCPtr& spFunctionParameter = static_pointer_cast<const FunctionParameter>(spBase);
-			m_callStack.emplace_back(spFunctionParameter->nameList);
+			const FunctionParameter& functionParameter = static_cast<const FunctionParameter&>(*spBase);
+			m_callStack.emplace_back(functionParameter.nameList);
 			return true;
 		}
 
 		case EASTType::FunctionCall:
 		{
-			const FunctionCallCPtr& spFunctionCall = static_pointer_cast<const FunctionCall>(spBase);
-			m_callStack.emplace_back(spFunctionCall->functionArgument);
-			m_callStack.emplace_back(spFunctionCall->name);
+			const FunctionCall& functionCall = static_cast<const FunctionCall&>(*spBase);
+			m_callStack.emplace_back(functionCall.functionArgument);
+			m_callStack.emplace_back(functionCall.name);
 			return true;
 		}
 
 		case EASTType::FunctionArgument:
 		{
-			const FunctionArgumentCPtr& spFunctionArgument = static_pointer_cast<const FunctionArgument>(spBase);
-			m_callStack.emplace_back(spFunctionArgument->expressionList);
+			const FunctionArgument& functionArgument = static_cast<const FunctionArgument&>(*spBase);
+			m_callStack.emplace_back(functionArgument.expressionList);
 			return true;
 		}
 
 		case EASTType::Statement:
 		{
-			const StatementCPtr& spStatement = static_pointer_cast<const Statement>(spBase);
-			m_callStack.emplace_back(spStatement->statement);
+			const Statement& statement = static_cast<const Statement&>(*spBase);
+			m_callStack.emplace_back(statement.statement);
 			return true;
 		}
 
@@ -311,7 +311,6 @@ namespace dsl
 
 			case EASTType::Name:
 			{
-				const NameCPtr& spName = static_pointer_cast<const Name>(inBase);
 			}
 			break;
 
@@ -323,22 +322,22 @@ namespace dsl
 
 			case EASTType::Numeral:
 			{
-				const NumeralCPtr& spNumeral = static_pointer_cast<const Numeral>(inBase);
+				const Numeral& numeral = static_cast<const Numeral&>(*inBase);
 
 				// call stack에 값이 없다면 넣어준다.
 				if (inCallStackInfo.upVal == nullptr)
 				{
-					if (spNumeral->isInteger)
+					if (numeral.isInteger)
 					{
 						EnvValIntUptr upVal = std::make_unique<EnvValInt>();
-						upVal->val = spNumeral->intValue;
+						upVal->val = numeral.intValue;
 
 						inCallStackInfo.upVal = std::move(upVal);
 					}
 					else
 					{
 						EnvValFloatUptr upVal = std::make_unique<EnvValFloat>();
-						upVal->val = spNumeral->floatValue;
+						upVal->val = numeral.floatValue;
 
 						inCallStackInfo.upVal = std::move(upVal);
 					}
@@ -354,13 +353,13 @@ namespace dsl
 
 			case EASTType::LiteralString:
 			{
-				const LiteralStringCPtr& spLiteralString = static_pointer_cast<const LiteralString>(inBase);
+				const LiteralString& literalString = static_cast<const LiteralString&>(*inBase);
 
 				// call stack에 값이 없다면 넣어준다.
+				// 문자열은 복사하지 않고 상수 풀의 버퍼를 참조한다.
 				if (inCallStackInfo.upVal == nullptr)
 				{
-					EnvValStringUptr upVal = std::make_unique<EnvValString>();
-					upVal->val = spLiteralString->value;
+					EnvValStringUptr upVal = std::make_unique<EnvValString>(literalString.value);
 
 					inCallStackInfo.upVal = std::move(upVal);
 				}
@@ -370,11 +369,11 @@ namespace dsl
 			case EASTType::AST:
 			{
 				// call stack에 block을 추가하고 run 한다.
-				const ASTCPtr& spAST = static_pointer_cast<const AST>(inBase);
-				if (!spAST->block)
+				const AST& ast = static_cast<const AST&>(*inBase);
+				if (!ast.block)
 					return false;
 
-				EnvCallStackInfo& callStackInfo = insertCallStack(spAST->block);
+				EnvCallStackInfo& callStackInfo = insertCallStack(ast.block);
 				const EEnvCallStackState eState = runCallStack(callStackInfo);
 
 				if (EEnvCallStackState::Success == eState)
@@ -386,12 +385,12 @@ namespace dsl
 
 			case EASTType::Block:
 			{
-				const BlockCPtr& spBlock = static_pointer_cast<const Block>(inBase);
+				const Block& block = static_cast<const Block&>(*inBase);
 
 				int& refLoopCount = inCallStackInfo.nLoopCount;
-				for (; refLoopCount < spBlock->statements.size(); ++refLoopCount)
+				for (; refLoopCount < block.statements.size(); ++refLoopCount)
 				{
-					const BaseCPtr& spBase = spBlock->statements[refLoopCount];
+					const BaseCPtr& spBase = block.statements[refLoopCount];
 					if (!spBase)
 						return false;
 
@@ -408,11 +407,11 @@ namespace dsl
 
 			case EASTType::Assignment:
 			{
-				const AssignmentCPtr& spAssignment = static_pointer_cast<const Assignment>(inBase);
+				const Assignment& assignment = static_cast<const Assignment&>(*inBase);
 
-				const NameCPtr& spName = static_pointer_cast<const Name>(inBase);
-				const ExpressionCPtr& spExpression = static_pointer_cast<const Expression>(inBase);
-				if (!spName || !spExpression)
+				const Name* pName = NodeCast<Name>(assignment.name);
+				const BasePtr& spExpression = assignment.expression;
+				if (!pName || !spExpression)
 					return false;
 
 				EnvCallStackInfo& callStackInfo = m_callStack.emplace_back(spExpression);
@@ -421,18 +420,18 @@ namespace dsl
 				if (EEnvCallStackState::Success != callStackInfo.eState)
 					return callStackInfo.eState;
 
-				std::unordered_map<std::wstring, EnvValBasePtr>& localVariableMap = m_localVariableStack.back();
-				localVariableMap[spName->name];
+				std::unordered_map<SymbolId, EnvValBasePtr>& localVariableMap = m_localVariableStack.back();
+				localVariableMap[pName->id];
 			}
 			break;
 
 			case EASTType::Expression:
 			{
-				const ExpressionCPtr& spExpression = static_pointer_cast<const Expression>(inBase);
-				if (!spExpression->expression)
+				const Expression& expression = static_cast<const Expression&>(*inBase);
+				if (!expression.expression)
 					return false;
 
-				EnvCallStackInfo& callStackInfo = m_callStack.emplace_back(spExpression->expression);
+				EnvCallStackInfo& callStackInfo = m_callStack.emplace_back(expression.expression);
 
 				callStackInfo.eState = runCallStack(callStackInfo);
 				if (EEnvCallStackState::Success != callStackInfo.eState)
@@ -462,9 +461,9 @@ namespace dsl
 
 			case EASTType::UnaryExpression:
 			{
-				const UnaryExpressionCPtr& spUnaryExpression = static_pointer_cast<const UnaryExpression>(inBase);
+				const UnaryExpression& unaryExpression = static_cast<const UnaryExpression&>(*inBase);
 
-				const PrimaryExpressionCPtr& spPrimaryExpression = static_pointer_cast<const PrimaryExpression>(spUnaryExpression->primaryExpression);
+				const BasePtr& spPrimaryExpression = unaryExpression.primaryExpression;
 				if (!spPrimaryExpression)
 					return false;
 
@@ -474,7 +473,7 @@ namespace dsl
 				if (EEnvCallStackState::Success != callStackInfo.eState)
 					return callStackInfo.eState;
 
-				callStackInfo.upVal = executeUnaryOperator(std::move(callStackInfo.upVal), spUnaryExpression->unaryOperator);
+				callStackInfo.upVal = executeUnaryOperator(std::move(callStackInfo.upVal), unaryExpression.unaryOperator);
 
 			}
 			break;
@@ -506,11 +505,11 @@ namespace dsl
 
 			case EASTType::Statement:
 			{
-				const StatementCPtr& spStatement = static_pointer_cast<const Statement>(inBase);
-				if (!spStatement->statement)
+				const Statement& statement = static_cast<const Statement&>(*inBase);
+				if (!statement.statement)
 					return false;
 
-				EnvCallStackInfo& callStackInfo = insertCallStack(spStatement->statement);
+				EnvCallStackInfo& callStackInfo = insertCallStack(statement.statement);
 				const EEnvCallStackState eState = runCallStack(callStackInfo);
 
 				if (EEnvCallStackState::Success == eState)
@@ -559,45 +558,54 @@ namespace dsl
 
 	// 단항 연산자를 실행한다.
 	// @upEnvValBase		: 피연산자
-	// @strOperator			: 연산자
+	// @eOperator			: 연산자
 	// @return				: 결과값
-	EnvValBaseUptr Environment::executeUnaryOperator(EnvValBaseUptr upEnvValBase, const std::wstring& strOperator)
+	EnvValBaseUptr Environment::executeUnaryOperator(EnvValBaseUptr upEnvValBase, const EOperator eOperator)
 	{
 		if (!upEnvValBase)
 			return nullptr;
 
 		const EEnvValType eEnvValType = upEnvValBase->GetValType();
 
-		if (L"not" == strOperator)
+		switch (eOperator)
 		{
-			switch (eEnvValType)
+			case EOperator::Not:
 			{
-				case EEnvValType::Bool:
+				switch (eEnvValType)
 				{
-					EnvValBoolUptr upValBool(static_cast<EnvValBool*>(upEnvValBase.release()));
-					upValBool->val = !upValBool->val;
-					return upValBool;
+					case EEnvValType::Bool:
+					{
+						EnvValBoolUptr upValBool(static_cast<EnvValBool*>(upEnvValBase.release()));
+						upValBool->val = !upValBool->val;
+						return upValBool;
+					}
 				}
 			}
-		}
-		else if (L"-" == strOperator)
-		{
-			switch (eEnvValType)
+			break;
+
+			case EOperator::Neg:
 			{
-				case EEnvValType::Int:
+				switch (eEnvValType)
 				{
-					EnvValIntUptr upValInt(static_cast<EnvValInt*>(upEnvValBase.release()));
-					upValInt->val = -upValInt->val;
-					return upValInt;
-				}
+					case EEnvValType::Int:
+					{
+						EnvValIntUptr upValInt(static_cast<EnvValInt*>(upEnvValBase.release()));
+						upValInt->val = -upValInt->val;
+						return upValInt;
+					}
 
-				case EEnvValType::Float:
-				{
-					EnvValFloatUptr upValFloat(static_cast<EnvValFloat*>(upEnvValBase.release()));
-					upValFloat->val = -upValFloat->val;
-					return upValFloat;
+					case EEnvValType::Float:
+					{
+						EnvValFloatUptr upValFloat(static_cast<EnvValFloat*>(upEnvValBase.release()));
+						upValFloat->val = -upValFloat->val;
+						return upValFloat;
+					}
 				}
 			}
+			break;
+
+			default:
+				break;
 		}
 
 		return nullptr;
@@ -605,10 +613,11 @@ namespace dsl
 
 	// 이항 연산자를 실행한다.
 	// @upLeftEnvValBase	: 왼쪽 피연산자
-	// @strOperator			: 연산자
+	// @eOperator			: 연산자
 	// @upRightEnvValBase	: 오른쪽 피연산자
 	// @return				: 결과값
-	EnvValBaseUptr executeBinaryOperator(EnvValBaseUptr upLeftEnvValBase, const std::wstring& strOperator, EnvValBaseUptr upRightEnvValBase)
+	// 연산자 코드는 연속된 값이므로 switch가 점프 테이블로 분기한다.
+	EnvValBaseUptr executeBinaryOperator(EnvValBaseUptr upLeftEnvValBase, const EOperator eOperator, EnvValBaseUptr upRightEnvValBase)
 	{
 		if (!upLeftEnvValBase || !upRightEnvValBase)
 			return nullptr;
@@ -631,98 +640,129 @@ namespace dsl
 		const EEnvValType eLeftType = upLeftEnvValBase->GetValType();
 		const EEnvValType eRightType = upLeftEnvValBase->GetValType();
 
-		if (L"*" == strOperator)
+		switch (eOperator)
 		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
+			case EOperator::Mul:
 			{
-				if (isFloat(eLeftType) || isFloat(eRightType))
-					return std::make_unique<EnvValFloat>(upLeftEnvValBase->GetFloat() * upRightEnvValBase->GetFloat());
-				else
-					return std::make_unique<EnvValInt>(upLeftEnvValBase->GetInt() * upRightEnvValBase->GetInt());
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+				{
+					if (isFloat(eLeftType) || isFloat(eRightType))
+						return std::make_unique<EnvValFloat>(upLeftEnvValBase->GetFloat() * upRightEnvValBase->GetFloat());
+					else
+						return std::make_unique<EnvValInt>(upLeftEnvValBase->GetInt() * upRightEnvValBase->GetInt());
+				}
 			}
-		}
-		else if (L"/" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
+			break;
+
+			case EOperator::Div:
 			{
-				if (upRightEnvValBase->GetInt() == 0)
-					return nullptr;
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+				{
+					if (upRightEnvValBase->GetInt() == 0)
+						return nullptr;
 
-				if (isFloat(eLeftType) || isFloat(eRightType))
-					return std::make_unique<EnvValFloat>(upLeftEnvValBase->GetFloat() / upRightEnvValBase->GetFloat());
-				else
-					return std::make_unique<EnvValInt>(upLeftEnvValBase->GetInt() / upRightEnvValBase->GetInt());
+					if (isFloat(eLeftType) || isFloat(eRightType))
+						return std::make_unique<EnvValFloat>(upLeftEnvValBase->GetFloat() / upRightEnvValBase->GetFloat());
+					else
+						return std::make_unique<EnvValInt>(upLeftEnvValBase->GetInt() / upRightEnvValBase->GetInt());
+				}
 			}
-		}
-		else if (L"%" == strOperator)
-		{
-			if (isInteger(eLeftType) && isInteger(eRightType))
+			break;
+
+			case EOperator::Mod:
 			{
-				if (upRightEnvValBase->GetInt() == 0)
-					return nullptr;
+				if (isInteger(eLeftType) && isInteger(eRightType))
+				{
+					if (upRightEnvValBase->GetInt() == 0)
+						return nullptr;
 
-				return std::make_unique<EnvValInt>(upLeftEnvValBase->GetInt() % upRightEnvValBase->GetInt());
+					return std::make_unique<EnvValInt>(upLeftEnvValBase->GetInt() % upRightEnvValBase->GetInt());
+				}
 			}
-		}
-		else if (L"+" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
+			break;
+
+			case EOperator::Add:
 			{
-				if (isFloat(eLeftType) || isFloat(eRightType))
-					return std::make_unique<EnvValFloat>(upLeftEnvValBase->GetFloat() + upRightEnvValBase->GetFloat());
-				else
-					return std::make_unique<EnvValInt>(upLeftEnvValBase->GetInt() + upRightEnvValBase->GetInt());
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+				{
+					if (isFloat(eLeftType) || isFloat(eRightType))
+						return std::make_unique<EnvValFloat>(upLeftEnvValBase->GetFloat() + upRightEnvValBase->GetFloat());
+					else
+						return std::make_unique<EnvValInt>(upLeftEnvValBase->GetInt() + upRightEnvValBase->GetInt());
+				}
 			}
-		}
-		else if (L"-" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
+			break;
+
+			case EOperator::Sub:
 			{
-				if (isFloat(eLeftType) || isFloat(eRightType))
-					return std::make_unique<EnvValFloat>(upLeftEnvValBase->GetFloat() - upRightEnvValBase->GetFloat());
-				else
-					return std::make_unique<EnvValInt>(upLeftEnvValBase->GetInt() - upRightEnvValBase->GetInt());
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+				{
+					if (isFloat(eLeftType) || isFloat(eRightType))
+						return std::make_unique<EnvValFloat>(upLeftEnvValBase->GetFloat() - upRightEnvValBase->GetFloat());
+					else
+						return std::make_unique<EnvValInt>(upLeftEnvValBase->GetInt() - upRightEnvValBase->GetInt());
+				}
 			}
-		}
-		else if (L"<" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
-				return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() < upRightEnvValBase->GetFloat());
-		}
-		else if (L">" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
-				return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() > upRightEnvValBase->GetFloat());
-		}
-		else if (L"<=" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
-				return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() <= upRightEnvValBase->GetFloat());
-		}
-		else if (L">=" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
-				return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() >= upRightEnvValBase->GetFloat());
-		}
-		else if (L"==" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
-				return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() == upRightEnvValBase->GetFloat());
-		}
-		else if (L"!=" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
-				return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() != upRightEnvValBase->GetFloat());
-		}
-		else if (L"and" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
-				return std::make_unique<EnvValBool>(upLeftEnvValBase->GetBool() && upRightEnvValBase->GetBool());
-		}
-		else if (L"or" == strOperator)
-		{
-			if (isNumeral(eLeftType) && isNumeral(eRightType))
-				return std::make_unique<EnvValBool>(upLeftEnvValBase->GetBool() || upRightEnvValBase->GetBool());
+			break;
+
+			case EOperator::Less:
+			{
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+					return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() < upRightEnvValBase->GetFloat());
+			}
+			break;
+
+			case EOperator::Greater:
+			{
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+					return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() > upRightEnvValBase->GetFloat());
+			}
+			break;
+
+			case EOperator::LessEqual:
+			{
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+					return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() <= upRightEnvValBase->GetFloat());
+			}
+			break;
+
+			case EOperator::GreaterEqual:
+			{
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+					return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() >= upRightEnvValBase->GetFloat());
+			}
+			break;
+
+			case EOperator::Equal:
+			{
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+					return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() == upRightEnvValBase->GetFloat());
+			}
+			break;
+
+			case EOperator::NotEqual:
+			{
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+					return std::make_unique<EnvValBool>(upLeftEnvValBase->GetFloat() != upRightEnvValBase->GetFloat());
+			}
+			break;
+
+			case EOperator::And:
+			{
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+					return std::make_unique<EnvValBool>(upLeftEnvValBase->GetBool() && upRightEnvValBase->GetBool());
+			}
+			break;
+
+			case EOperator::Or:
+			{
+				if (isNumeral(eLeftType) && isNumeral(eRightType))
+					return std::make_unique<EnvValBool>(upLeftEnvValBase->GetBool() || upRightEnvValBase->GetBool());
+			}
+			break;
+
+			default:
+				break;
 		}
 
 		return nullptr;
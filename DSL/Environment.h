@@ -24,8 +24,8 @@ namespace dsl
         bool prepareCallStack();
         bool runCallStack();
 
-        EnvValBaseUptr executeUnaryOperator(EnvValBaseUptr upEnvValBase, const std::wstring& strOperator);
-        EnvValBaseUptr executeBinaryOperator(EnvValBaseUptr upLeftEnvValBase, const std::wstring& strOperator, EnvValBaseUptr upRightEnvValBase);
+        EnvValBaseUptr executeUnaryOperator(EnvValBaseUptr upEnvValBase, const EOperator eOperator);
+        EnvValBaseUptr executeBinaryOperator(EnvValBaseUptr upLeftEnvValBase, const EOperator eOperator, EnvValBaseUptr upRightEnvValBase);
 
 
     private:
@@ -33,8 +33,9 @@ namespace dsl
 
         std::vector<EnvCallStackInfo> m_callStack;
 
-        std::unordered_map<std::wstring, EnvValBasePtr> m_globalVariableMap;
-        std::vector<std::unordered_map<std::wstring, EnvValBasePtr>> m_localVariableStack;
+        // 변수 map. Key=변수 이름의 심볼 ID
+        std::unordered_map<SymbolId, EnvValBasePtr> m_globalVariableMap;
+        std::vector<std::unordered_map<SymbolId, EnvValBasePtr>> m_localVariableStack;
     };
 
     using EnvironmentPtr = std::shared_ptr<Environment>;
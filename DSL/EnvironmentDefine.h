@@ -72,14 +72,16 @@ namespace dsl
     // String 변수
     struct EnvValString : EnvValBase
     {
-        EnvValString() {}
-        EnvValString(const std::wstring& inVal) : val(inVal) {}
+        EnvValString() : val(GetEmptyConstant()) {}
+        EnvValString(const std::wstring& inVal) : val(std::make_shared<const std::wstring>(inVal)) {}
+        EnvValString(const ConstantString& inVal) : val(inVal) {}
 
         virtual EEnvValType GetValType() const override { return EEnvValType::String; }
 
-        virtual std::wstring GetString() const { return val; }
+        virtual std::wstring GetString() const { return *val; }
 
-        std::wstring val;
+        // 리터럴의 값이면 상수 풀의 버퍼를 참조한다. 버퍼는 변경할 수 없으므로 값을 바꿀 때는 새 버퍼를 만든다.
+        ConstantString val;
     };
 
     using EnvValBasePtr = std::shared_ptr<EnvValBase>;
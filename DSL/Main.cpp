@@ -5,11 +5,14 @@
 #include "EnvironmentDefine.h"
 #include "Environment.h"
 #include "DSLManager.h"
+#include "benchmark.h"
 
 
 int wmain(int argc, wchar_t* argv[])
 {
-
+    // "bench <이름> [인자...]" 로 실행하면 벤치마크를 수행한다.
+    if (argc >= 2 && std::wstring(argv[1]) == L"bench")
+        return dsl::RunBenchmark(std::vector<std::wstring>(argv + 2, argv + argc));
 
     dsl::Parser2Test();
     return 0;
@@ -1,28 +1,134 @@
 ﻿#include "pch.h"
 
 #include "ast.h"
+#include "ast_visitor.h"
+#include "token_parser.h"
 
 
 namespace dsl
 {
-    void Name::Print(const int indent /*= 0*/) const
+    const std::wstring& GetOperatorName(const EOperator eOperator)
     {
-        std::wcout << std::wstring(indent, ' ') << L"Name: " << name << std::endl;
-    }
+        // EOperator 순서
+        static const std::wstring operatorNames[] =
+        {
+            L"",
+            L"*", L"/", L"%", L"+", L"-", L"<", L">", L"<=", L">=", L"==", L"!=", L"and", L"or", L"*=", L"/=", L"+=", L"-=",
+            L"not", L"-"
+        };
+        static_assert(std::size(operatorNames) == static_cast<size_t>(EOperator::Count));
 
-    void Name::Iterate(const FuncASTIterateCallback& callback) const
-    {
-        return;
+        const size_t index = static_cast<size_t>(eOperator);
+        return index < std::size(operatorNames) ? operatorNames[index] : operatorNames[0];
     }
 
-    void NameList::Print(const int indent /*= 0*/) const
+    // AST 출력 visitor
+    // 노드마다 한 줄을 출력하고, 깊이만큼 들여쓴다. 이항연산자는 왼쪽 항을 출력한 다음 연산자를 출력한다.
+    class ASTPrinter
     {
-        std::wcout << std::wstring(indent, ' ') << L"NameList:" << std::endl;
-        for (const BasePtr& name : names)
+    public:
+        explicit ASTPrinter(const int indent) : m_indent(indent) {}
+
+        template <typename T>
+        EVisitResult Enter(const T& node)
         {
-            if (name)
-                name->Print(indent + 2);
+            const int indent = m_indent + static_cast<int>(m_stack.size()) * 2;
+            m_stack.push_back(Frame{ &node, 0 });
+
+            std::wcout << std::wstring(indent, ' ');
+            if constexpr (std::is_same_v<T, Name>)
+                std::wcout << L"Name: " << node.GetName() << std::endl;
+            else if constexpr (std::is_same_v<T, NameList>)
+                std::wcout << L"NameList:" << std::endl;
+            else if constexpr (std::is_same_v<T, Numeral>)
+            {
+                if (node.isInteger)
+                    std::wcout << L"Numeral (int): " << node.intValue << std::endl;
+                else
+                    std::wcout << L"Numeral (float): " << node.floatValue << std::endl;
+            }
+            else if constexpr (std::is_same_v<T, Boolean>)
+                std::wcout << L"Boolean: " << node.value << std::endl;
+            else if constexpr (std::is_same_v<T, LiteralString>)
+                std::wcout << L"LiteralString: " << node.GetValue() << std::endl;
+            else if constexpr (std::is_same_v<T, AST>)
+                std::wcout << L"AST:" << std::endl;
+            else if constexpr (std::is_same_v<T, Block>)
+                std::wcout << L"Block:" << std::endl;
+            else if constexpr (std::is_same_v<T, UnaryExpression>)
+            {
+                std::wcout << L"UnaryExpression: " << std::endl;
+                std::wcout << std::wstring(indent + 2, ' ') << L"unaryOperator: " << GetOperatorName(node.unaryOperator) << std::endl;
+            }
+            else if constexpr (std::is_same_v<T, Base>)
+                std::wcout << L"Base: " << std::endl;
+            else
+                std::wcout << getName(node) << L": " << std::endl;
+
+            // 아래 노드는 자식을 출력하지 않는다.
+            if constexpr (std::is_same_v<T, PrimaryExpression> || std::is_same_v<T, Return> || std::is_same_v<T, Break> || std::is_same_v<T, While> || std::is_same_v<T, For>)
+                return EVisitResult::SkipChildren;
+            else
+                return EVisitResult::Continue;
         }
+
+        template <typename T>
+        void Leave(const T& node)
+        {
+            const int indent = m_indent + static_cast<int>(m_stack.size() - 1) * 2;
+            m_stack.pop_back();
+
+            // 출력하기 위해 본문을 파싱하지는 않는다.
+            if constexpr (std::is_same_v<T, FunctionDefinition>)
+            {
+                if (node.lazyBody && !node.IsMaterialized())
+                    std::wcout << std::wstring(indent + 2, ' ') << L"Block: (lazy, " << node.lazyBody->GetLength() << L" bytes)" << std::endl;
+            }
+
+            if (m_stack.empty())
+                return;
+
+            Frame& parent = m_stack.back();
+            if (EASTType::BinaryExpression == parent.pNode->GetType() && 1 == ++parent.childCount)
+                std::wcout << std::wstring(indent, ' ') << L"binaryOperator: " << GetOperatorName(static_cast<const BinaryExpression*>(parent.pNode)->binaryOperator) << std::endl;
+        }
+
+    private:
+        static const wchar_t* getName(const Assignment&) { return L"Assignment"; }
+        static const wchar_t* getName(const Expression&) { return L"Expression"; }
+        static const wchar_t* getName(const ExpressionList&) { return L"ExpressionList"; }
+        static const wchar_t* getName(const PrimaryExpression&) { return L"PrimaryExpression"; }
+        static const wchar_t* getName(const BinaryExpression&) { return L"BinaryExpression"; }
+        static const wchar_t* getName(const FunctionDefinition&) { return L"FunctionDefinition"; }
+        static const wchar_t* getName(const FunctionParameter&) { return L"FunctionParameter"; }
+        static const wchar_t* getName(const FunctionArgument&) { return L"FunctionArgument"; }
+        static const wchar_t* getName(const FunctionCall&) { return L"FunctionCall"; }
+        static const wchar_t* getName(const Statement&) { return L"Statement"; }
+        static const wchar_t* getName(const Return&) { return L"Return"; }
+        static const wchar_t* getName(const Break&) { return L"Break"; }
+        static const wchar_t* getName(const While&) { return L"While"; }
+        static const wchar_t* getName(const If&) { return L"If"; }
+        static const wchar_t* getName(const For&) { return L"For"; }
+
+    private:
+        struct Frame
+        {
+            const Base* pNode;
+            int childCount;     // 출력을 마친 자식 수
+        };
+
+        int m_indent;
+        std::vector<Frame> m_stack;     // 출력 중인 노드와 조상 노드
+    };
+
+    void Base::Print(const int indent /*= 0*/) const
+    {
+        WalkAST(*this, ASTPrinter(indent));
+    }
+
+    void Name::Iterate(const FuncASTIterateCallback& callback) const
+    {
+        return;
     }
 
     void NameList::Iterate(const FuncASTIterateCallback& callback) const
@@ -36,46 +142,21 @@ namespace dsl
         }
     }
 
-    void Numeral::Print(const int indent /*= 0*/) const
-    {
-        if (isInteger)
-            std::wcout << std::wstring(indent, ' ') << L"Numeral (int): " << intValue << std::endl;
-        else
-            std::wcout << std::wstring(indent, ' ') << L"Numeral (float): " << floatValue << std::endl;
-    }
-
     void Numeral::Iterate(const FuncASTIterateCallback& callback) const
     {
         return;
     }
 
-    void Boolean::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"Boolean: " << value << std::endl;
-    }
-
     void Boolean::Iterate(const FuncASTIterateCallback& callback) const
     {
         return;
     }
 
-    void LiteralString::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"LiteralString: " << value << std::endl;
-    }
-
     void LiteralString::Iterate(const FuncASTIterateCallback& callback) const
     {
         return;
     }
 
-    void AST::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"AST:" << std::endl;
-        if(block)
-            block->Print(indent + 2);
-    }
-
     void AST::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(block);
@@ -84,16 +165,6 @@ namespace dsl
             block->Iterate(callback);
     }
 
-    void Block::Print(const int indent /*= 0*/) const
-    {
-       std::wcout << std::wstring(indent, ' ') << L"Block:" << std::endl;
-       for (const BasePtr& statement : statements)
-       {
-           if (statement)
-               statement->Print(indent + 2);
-       }
-    }
-
     void Block::Iterate(const FuncASTIterateCallback& callback) const
     {
         for (const BaseCPtr& statement : statements)
@@ -105,15 +176,6 @@ namespace dsl
         }
     }
 
-    void Assignment::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"Assignment: " << std::endl;
-        if (name)
-            name->Print(indent + 2);
-        if (expression)
-            expression->Print(indent + 2);
-    }
-
     void Assignment::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(name);
@@ -125,13 +187,6 @@ namespace dsl
             expression->Iterate(callback);
     }
 
-    void Expression::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"Expression: " << std::endl;
-        if (expression)
-            expression->Print(indent + 2);
-    }
-
     void Expression::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(expression);
@@ -140,16 +195,6 @@ namespace dsl
             expression->Iterate(callback);
     }
 
-    void ExpressionList::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"ExpressionList: " << std::endl;
-        for (const BasePtr& expression : expressions)
-        {
-            if (expression)
-                expression->Print(indent + 2);
-        }
-    }
-
     void ExpressionList::Iterate(const FuncASTIterateCallback& callback) const
     {
         for (const BaseCPtr& expression : expressions)
@@ -161,12 +206,6 @@ namespace dsl
         }
     }
 
-    void PrimaryExpression::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"PrimaryExpression: " << std::endl;
-
-    }
-
     void PrimaryExpression::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(primaryExpression);
@@ -175,16 +214,6 @@ namespace dsl
             primaryExpression->Iterate(callback);
     }
 
-    void BinaryExpression::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"BinaryExpression: " << std::endl;
-        if (primaryExpression1) 
-            primaryExpression1->Print(indent + 2);
-        std::wcout << std::wstring(indent + 2, ' ') << L"binaryOperator: " << binaryOperator << std::endl;
-        if (primaryExpression2)
-            primaryExpression2->Print(indent + 2);
-    }
-
     void BinaryExpression::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(primaryExpression1);
@@ -198,14 +227,6 @@ namespace dsl
             primaryExpression2->Iterate(callback);
     }
 
-    void UnaryExpression::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"UnaryExpression: " << std::endl;
-        std::wcout << std::wstring(indent + 2, ' ') << L"unaryOperator: " << unaryOperator << std::endl;
-        if (primaryExpression)
-            primaryExpression->Print(indent + 2);
-    }
-
     void UnaryExpression::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(primaryExpression);
@@ -214,16 +235,27 @@ namespace dsl
             primaryExpression->Iterate(callback);
     }
 
-    void FunctionDefinition::Print(const int indent /*= 0*/) const
+    BasePtr FunctionDefinition::GetBlock() const
     {
-        std::wcout << std::wstring(indent, ' ') << L"FunctionDefinition: " << std::endl;
+        if (lazyBody)
+            return lazyBody->Materialize();
 
-        if (name)
-            name->Print(indent + 2);
-        if (functionParameter)
-            functionParameter->Print(indent + 2);
-        if (block)
-            block->Print(indent + 2);
+        return block;
+    }
+
+    bool FunctionDefinition::IsMaterialized() const
+    {
+        return !lazyBody || lazyBody->IsMaterialized();
+    }
+
+    const BasePtr& FunctionDefinition::GetParsedBlock() const
+    {
+        static const BasePtr spEmpty;
+        if (!lazyBody)
+            return block;
+
+        // 파싱한 다음의 Materialize는 기다리지 않고 바로 Block을 반환한다.
+        return lazyBody->IsMaterialized() ? lazyBody->Materialize() : spEmpty;
     }
 
     void FunctionDefinition::Iterate(const FuncASTIterateCallback& callback) const
@@ -236,17 +268,11 @@ namespace dsl
         if (functionParameter)
             functionParameter->Iterate(callback);
 
-        callback(block);
-        if (block)
-            block->Iterate(callback);
-    }
-
-    void FunctionParameter::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"FunctionParameter: " << std::endl;
-
-        if (nameList)
-            nameList->Print(indent + 2);
+        // 파싱하지 않은 본문은 순회하지 않는다.
+        const BasePtr spBlock = lazyBody ? lazyBody->GetBlock() : block;
+        callback(spBlock);
+        if (spBlock)
+            spBlock->Iterate(callback);
     }
 
     void FunctionParameter::Iterate(const FuncASTIterateCallback& callback) const
@@ -256,13 +282,6 @@ namespace dsl
             nameList->Iterate(callback);
     }
 
-    void FunctionArgument::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"FunctionArgument: " << std::endl;
-        if (expressionList)
-            expressionList->Print(indent + 2);
-    }
-
     void FunctionArgument::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(expressionList);
@@ -270,15 +289,6 @@ namespace dsl
             expressionList->Iterate(callback);
     }
 
-    void FunctionCall::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"FunctionCall: " << std::endl;
-        if (name)
-            name->Print(indent + 2);
-        if (functionArgument)
-            functionArgument->Print(indent + 2);
-    }
-
     void FunctionCall::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(name);
@@ -290,13 +300,6 @@ namespace dsl
             functionArgument->Iterate(callback);
     }
 
-    void Statement::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"Statement: " << std::endl;
-        if (statement)
-            statement->Print(indent + 2);
-    }
-
     void Statement::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(statement);
@@ -304,11 +307,6 @@ namespace dsl
             statement->Iterate(callback);
     }
 
-    void Return::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"Return: " << std::endl;
-    }
-
     void Return::Iterate(const FuncASTIterateCallback& callback) const
     {
         for (const BaseCPtr& expression : expressions)
@@ -320,21 +318,11 @@ namespace dsl
         }
     }
 
-    void Break::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"Break: " << std::endl;
-    }
-
     void Break::Iterate(const FuncASTIterateCallback& callback) const
     {
         return;
     }
 
-    void While::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"While: " << std::endl;
-    }
-
     void While::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(expression);
@@ -346,17 +334,6 @@ namespace dsl
             statDo->Iterate(callback);
     }
 
-    void If::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"If: " << std::endl;
-        if (expression)
-            expression->Print(indent + 2);
-        if(block)
-            block->Print(indent + 2);
-        if (statIf)
-            statIf->Print(indent + 2);
-    }
-
     void If::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(expression);
@@ -372,11 +349,6 @@ namespace dsl
             statIf->Iterate(callback);
     }
 
-    void For::Print(const int indent /*= 0*/) const
-    {
-        std::wcout << std::wstring(indent, ' ') << L"For: " << std::endl;
-    }
-
     void For::Iterate(const FuncASTIterateCallback& callback) const
     {
         callback(name);
@@ -1,5 +1,9 @@
 ﻿#pragma once
 
+#include "symbol_table.h"
+#include "constant_pool.h"
+#include "ast_arena.h"
+
 /*
 AST는 Abstract Syntax Tree (추상 구문 트리)를 의미한다.
 파싱한 결과를 구조화한 트리 형태의 데이터 구조이다.
@@ -39,6 +43,42 @@ namespace dsl
         For
     };
 
+    // 이항/단항 연산자
+    // 노드에 문자열 대신 연산자 코드를 저장한다. 실행할 때 문자열을 비교하지 않고 switch로 분기한다.
+    // 값은 AST 캐시(.dslc)에 그대로 기록하므로 순서를 바꾸면 AST_CACHE_VERSION을 올린다.
+    enum class EOperator : uint8_t
+    {
+        None,
+
+        // 이항 연산자
+        Mul,            // *
+        Div,            // /
+        Mod,            // %
+        Add,            // +
+        Sub,            // -
+        Less,           // <
+        Greater,        // >
+        LessEqual,      // <=
+        GreaterEqual,   // >=
+        Equal,          // ==
+        NotEqual,       // !=
+        And,            // and
+        Or,             // or
+        MulAssign,      // *=
+        DivAssign,      // /=
+        AddAssign,      // +=
+        SubAssign,      // -=
+
+        // 단항 연산자
+        Not,            // not
+        Neg,            // -
+
+        Count
+    };
+
+    // 스크립트에 쓰는 연산자 문자열. None이나 범위 밖의 값은 빈 문자열
+    const std::wstring& GetOperatorName(const EOperator eOperator);
+
     struct Base;
 
     struct Name;
@@ -68,6 +108,8 @@ namespace dsl
     struct If;
     struct For;
 
+    class LazyFunctionBody;
+
     using BasePtr = std::shared_ptr<Base>;
     using BaseCPtr = std::shared_ptr<const Base>;
 
@@ -127,38 +169,54 @@ namespace dsl
 
     struct Base
     {
-        virtual EASTType GetType() const { return EASTType::Base; }
-        virtual void Print(const int indent = 0) const = 0;
+        // 노드 타입 태그. 가상 함수를 호출하지 않고 타입을 읽을 수 있도록 생성할 때 저장한다.
+        const EASTType type;
+
+        explicit Base(const EASTType _type) : type(_type) {}
+
+        EASTType GetType() const { return type; }
+
+        // 노드와 하위 노드를 출력한다. (WalkAST)
+        void Print(const int indent = 0) const;
+
         virtual void Iterate(const FuncASTIterateCallback& callback) const = 0;
     };
 
+    // 노드 타입별 기반 클래스. 노드 타입 태그를 지정한다.
+    template <EASTType Type>
+    struct NodeBase : public Base
+    {
+        static constexpr EASTType NodeType = Type;
+
+        NodeBase() : Base(Type) {}
+    };
+
 
 
-    struct Name : public Base
+    struct Name : public NodeBase<EASTType::Name>
     {
-        std::wstring name;
+        SymbolId id = InvalidSymbolId;  // 이름의 심볼 ID. 문자열은 GetName()으로 얻는다.
 
         Name() {}
-        Name(const std::wstring& val) : name(val) {}
+        Name(const std::wstring& val) : id(InternSymbol(val)) {}
+        Name(const SymbolId _id) : id(_id) {}
+
+        const std::wstring& GetName() const { return GetSymbolName(id); }
 
-        virtual EASTType GetType() const override { return EASTType::Name; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct NameList : public Base
+    struct NameList : public NodeBase<EASTType::NameList>
     {
         std::vector<BasePtr> names;
 
         NameList() {}
         NameList(const std::vector<BasePtr>& val) : names(val) {}
 
-        virtual EASTType GetType() const override { return EASTType::NameList; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct Numeral : public Base
+    struct Numeral : public NodeBase<EASTType::Numeral>
     {
         bool isInteger = true;
         __int64 intValue = 0;
@@ -168,60 +226,55 @@ namespace dsl
         Numeral(__int64 val) : isInteger(true), intValue(val), floatValue(0.0) {}
         Numeral(double val) : isInteger(false), intValue(0), floatValue(val) {}
 
-        virtual EASTType GetType() const override { return EASTType::Numeral; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct Boolean : public Base
+    struct Boolean : public NodeBase<EASTType::Boolean>
     {
         bool value = false;
 
         Boolean() {}
         Boolean(bool val) : value(val) {}
 
-        virtual EASTType GetType() const override { return EASTType::Boolean; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct LiteralString : public Base
+    struct LiteralString : public NodeBase<EASTType::LiteralString>
     {
-        std::wstring value;
+        ConstantString value;   // 스크립트 상수 풀의 버퍼. 같은 내용의 리터럴은 버퍼를 공유한다.
+
+        LiteralString() : value(GetEmptyConstant()) {}
+        LiteralString(const std::wstring& val) : value(InternConstant(val)) {}
 
-        LiteralString() {}
-        LiteralString(const std::wstring& val) : value(val) {}
+        const std::wstring& GetValue() const { return *value; }
 
-        virtual EASTType GetType() const override { return EASTType::LiteralString; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct AST : public Base
+    struct AST : public NodeBase<EASTType::AST>
     {
         BasePtr block;
+        ConstantPoolPtr constants;  // 문자열 리터럴의 상수 풀
+        ASTArenaPtr arena;          // 노드를 할당한 아레나. 아레나를 사용하지 않았다면 nullptr
 
         AST() {}
         AST(const BasePtr& val) : block(val) {}
+        AST(const BasePtr& val, const ConstantPoolPtr& _constants) : block(val), constants(_constants) {}
 
-        virtual EASTType GetType() const override { return EASTType::AST; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct Block : public Base
+    struct Block : public NodeBase<EASTType::Block>
     {
        std::vector<BasePtr> statements;
 
        Block() {}
        Block(const std::vector<BasePtr>& val) : statements(val) {}
        
-       virtual EASTType GetType() const override { return EASTType::Block; }
-       virtual void Print(const int indent = 0) const override;
        virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct Assignment : public Base
+    struct Assignment : public NodeBase<EASTType::Assignment>
     {
         BasePtr name;
         BasePtr expression;
@@ -229,110 +282,103 @@ namespace dsl
         Assignment() {}
         Assignment(const BasePtr& _name, const BasePtr& _expression) : name(_name), expression(_expression) {}
 
-        virtual EASTType GetType() const override { return EASTType::Assignment; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct Expression : public Base
+    struct Expression : public NodeBase<EASTType::Expression>
     {
         BasePtr expression;
 
         Expression() {}
         Expression(const BasePtr& val) : expression(val) {}
 
-        virtual EASTType GetType() const override { return EASTType::Expression; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct ExpressionList : public Base
+    struct ExpressionList : public NodeBase<EASTType::ExpressionList>
     {
         std::vector<BasePtr> expressions;
 
         ExpressionList() {}
         ExpressionList(const std::vector<BasePtr>& val) : expressions(val) {}
 
-        virtual EASTType GetType() const override { return EASTType::ExpressionList; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct PrimaryExpression : public Base
+    struct PrimaryExpression : public NodeBase<EASTType::PrimaryExpression>
     {
         BasePtr primaryExpression;
 
-        virtual EASTType GetType() const override { return EASTType::PrimaryExpression; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct BinaryExpression : public Base
+    struct BinaryExpression : public NodeBase<EASTType::BinaryExpression>
     {
         BasePtr primaryExpression1;
-        std::wstring binaryOperator;
+        EOperator binaryOperator = EOperator::None;
         BasePtr primaryExpression2;
 
         BinaryExpression() {}
-        BinaryExpression(const BasePtr& ex1, const std::wstring& op, const BasePtr& ex2) : primaryExpression1(ex1), binaryOperator(op), primaryExpression2(ex2) {}
+        BinaryExpression(const BasePtr& ex1, const EOperator op, const BasePtr& ex2) : primaryExpression1(ex1), binaryOperator(op), primaryExpression2(ex2) {}
 
-        virtual EASTType GetType() const override { return EASTType::BinaryExpression; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct UnaryExpression : public Base
+    struct UnaryExpression : public NodeBase<EASTType::UnaryExpression>
     {
-        std::wstring unaryOperator;
+        EOperator unaryOperator = EOperator::None;
         BasePtr primaryExpression;
 
         UnaryExpression() {}
-        UnaryExpression(const std::wstring& op, const BasePtr& ex) : unaryOperator(op), primaryExpression(ex) {}
+        UnaryExpression(const EOperator op, const BasePtr& ex) : unaryOperator(op), primaryExpression(ex) {}
 
-        virtual EASTType GetType() const override { return EASTType::UnaryExpression; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct FunctionDefinition : public Base
+    struct FunctionDefinition : public NodeBase<EASTType::FunctionDefinition>
     {
         BasePtr name;
         BasePtr functionParameter;
-        BasePtr block;
+        BasePtr block;                                  // 본문을 지연 파싱하는 함수는 nullptr 이다. GetBlock()을 사용한다.
+        std::shared_ptr<LazyFunctionBody> lazyBody;     // 지연 파싱하는 본문. 바로 파싱한 함수는 nullptr 이다.
 
         FunctionDefinition() {}
         FunctionDefinition(const BasePtr& _name, const BasePtr& _functionParameter, const BasePtr& _block) : name(_name), functionParameter(_functionParameter), block(_block) {}
 
-        virtual EASTType GetType() const override { return EASTType::FunctionDefinition; }
-        virtual void Print(const int indent = 0) const override;
+        // 함수 본문. 지연 파싱하는 함수는 처음 호출할 때 본문을 파싱한다. 파싱에 실패하면 nullptr를 반환한다.
+        // 여러 스레드에서 동시에 호출해도 본문은 한 번만 파싱한다.
+        BasePtr GetBlock() const;
+
+        // 본문을 파싱했는지 여부
+        bool IsMaterialized() const;
+
+        // 이미 파싱한 본문. 지연 파싱하는 함수의 본문을 아직 파싱하지 않았다면 nullptr이며, 이 때 본문을 파싱하지 않는다.
+        const BasePtr& GetParsedBlock() const;
+
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct FunctionParameter : public Base
+    struct FunctionParameter : public NodeBase<EASTType::FunctionParameter>
     {
         BasePtr nameList;
 
         FunctionParameter() {}
         FunctionParameter(const BasePtr& _nameList) : nameList(_nameList) {}
 
-        virtual EASTType GetType() const override { return EASTType::FunctionParameter; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct FunctionArgument : public Base
+    struct FunctionArgument : public NodeBase<EASTType::FunctionArgument>
     {
         BasePtr expressionList;
 
         FunctionArgument() {}
         FunctionArgument(const BasePtr& _expressionList) : expressionList(_expressionList) {}
 
-        virtual EASTType GetType() const override { return EASTType::FunctionArgument; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct FunctionCall : public Base
+    struct FunctionCall : public NodeBase<EASTType::FunctionCall>
     {
         BasePtr name;
         BasePtr functionArgument;
@@ -340,52 +386,42 @@ namespace dsl
         FunctionCall() {}
         FunctionCall(const BasePtr& _name, const BasePtr& _functionArgument) : name(_name), functionArgument(_functionArgument) {}
 
-        virtual EASTType GetType() const override { return EASTType::FunctionCall; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct Statement : public Base
+    struct Statement : public NodeBase<EASTType::Statement>
     {
         BasePtr statement;
 
         Statement() {}
         Statement(const BasePtr& _statement) : statement(_statement) {}
 
-        virtual EASTType GetType() const override { return EASTType::Statement; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct Return : public Base
+    struct Return : public NodeBase<EASTType::Return>
     {
         std::vector<BasePtr> expressions;
 
-        virtual EASTType GetType() const override { return EASTType::Return; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct Break : public Base
+    struct Break : public NodeBase<EASTType::Break>
     {
         std::wstring value;
 
-        virtual EASTType GetType() const override { return EASTType::Break; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct While : public Base
+    struct While : public NodeBase<EASTType::While>
     {
         BasePtr expression;
         BasePtr statDo;
 
-        virtual EASTType GetType() const override { return EASTType::While; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct If : public Base
+    struct If : public NodeBase<EASTType::If>
     {
         BasePtr expression;
         BasePtr block;
@@ -394,25 +430,68 @@ namespace dsl
         If() {}
         If(const BasePtr& _expression, const BasePtr& _block, const BasePtr& _statIf) : expression(_expression), block(_block), statIf(_statIf) {}
 
-        virtual EASTType GetType() const override { return EASTType::If; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
-    struct For : public Base
+    struct For : public NodeBase<EASTType::For>
     {
         BasePtr name;
         BasePtr expression1;
         BasePtr expression2;
         BasePtr expression3;
 
-        virtual EASTType GetType() const override { return EASTType::For; }
-        virtual void Print(const int indent = 0) const override;
         virtual void Iterate(const FuncASTIterateCallback& callback) const override;
     };
 
 
+    // 노드 타입별 방문
+    // 노드의 타입 태그로 한 번 분기한 다음 실제 타입의 참조로 visitor를 호출한다. 가상 함수 호출과 shared_ptr 복사가 없고, visitor는 인라인될 수 있다.
+    // visitor는 모든 노드 타입의 const 참조를 받을 수 있어야 하고(generic lambda 등), 모든 호출의 반환 타입이 같아야 한다.
+    // 알 수 없는 태그는 const Base& 로 호출한다.
+    template <typename Visitor>
+    decltype(auto) VisitNode(const Base& node, Visitor&& visitor)
+    {
+        switch (node.GetType())
+        {
+        case EASTType::Name:                return visitor(static_cast<const Name&>(node));
+        case EASTType::NameList:            return visitor(static_cast<const NameList&>(node));
+        case EASTType::Numeral:             return visitor(static_cast<const Numeral&>(node));
+        case EASTType::Boolean:             return visitor(static_cast<const Boolean&>(node));
+        case EASTType::LiteralString:       return visitor(static_cast<const LiteralString&>(node));
+        case EASTType::AST:                 return visitor(static_cast<const AST&>(node));
+        case EASTType::Block:               return visitor(static_cast<const Block&>(node));
+        case EASTType::Assignment:          return visitor(static_cast<const Assignment&>(node));
+        case EASTType::Expression:          return visitor(static_cast<const Expression&>(node));
+        case EASTType::ExpressionList:      return visitor(static_cast<const ExpressionList&>(node));
+        case EASTType::PrimaryExpression:   return visitor(static_cast<const PrimaryExpression&>(node));
+        case EASTType::BinaryExpression:    return visitor(static_cast<const BinaryExpression&>(node));
+        case EASTType::UnaryExpression:     return visitor(static_cast<const UnaryExpression&>(node));
+        case EASTType::FunctionDefinition:  return visitor(static_cast<const FunctionDefinition&>(node));
+        case EASTType::FunctionParameter:   return visitor(static_cast<const FunctionParameter&>(node));
+        case EASTType::FunctionCall:        return visitor(static_cast<const FunctionCall&>(node));
+        case EASTType::FunctionArgument:    return visitor(static_cast<const FunctionArgument&>(node));
+        case EASTType::Statement:           return visitor(static_cast<const Statement&>(node));
+        case EASTType::Return:              return visitor(static_cast<const Return&>(node));
+        case EASTType::Break:               return visitor(static_cast<const Break&>(node));
+        case EASTType::While:               return visitor(static_cast<const While&>(node));
+        case EASTType::If:                  return visitor(static_cast<const If&>(node));
+        case EASTType::For:                 return visitor(static_cast<const For&>(node));
+        default:                            return visitor(node);
+        }
+    }
+
+    // 노드를 실제 타입으로 변환한다. 타입이 다르거나 nullptr이면 nullptr를 반환한다.
+    // static_pointer_cast와 달리 참조 카운트를 바꾸지 않는다.
+    template <typename T>
+    const T* NodeCast(const Base* pBase)
+    {
+        return pBase && T::NodeType == pBase->GetType() ? static_cast<const T*>(pBase) : nullptr;
+    }
 
-
-
+    // BasePtr, BaseCPtr 모두 참조로 받는다. BaseCPtr만 받으면 BasePtr를 넘길 때 임시 shared_ptr가 만들어져 참조 카운트가 바뀐다.
+    template <typename T, typename U>
+    const T* NodeCast(const std::shared_ptr<U>& spBase)
+    {
+        return NodeCast<T>(static_cast<const Base*>(spBase.get()));
+    }
 }
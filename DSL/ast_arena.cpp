@@ -0,0 +1,94 @@
+﻿#include "pch.h"
+
+#include "ast_arena.h"
+
+namespace dsl
+{
+
+ASTArena::ASTArena(const size_t firstBlockSize)
+	: m_refCount(1)
+	, m_pCursor(nullptr)
+	, m_pEnd(nullptr)
+	, m_nextBlockSize((std::min)(firstBlockSize, MAX_BLOCK_SIZE))
+	, m_usedBytes(0)
+	, m_reservedBytes(0)
+	, m_allocationCount(0)
+{
+}
+
+ASTArenaPtr ASTArena::Create(const size_t firstBlockSize /*= FIRST_BLOCK_SIZE*/)
+{
+	return ASTArenaPtr(new ASTArena(firstBlockSize), [](ASTArena* pArena) { pArena->Release(); });
+}
+
+void* ASTArena::Allocate(const size_t size, const size_t align)
+{
+	++m_allocationCount;
+	m_refCount.fetch_add(1, std::memory_order_relaxed);
+
+	// 현재 블록에 들어가면 커서만 옮긴다.
+	// align은 2의 거듭제곱이므로 나눗셈 대신 비트 연산으로 패딩을 구한다.
+	const size_t padding = getPadding(m_pCursor, align);
+	if (m_pCursor && padding + size <= static_cast<size_t>(m_pEnd - m_pCursor))
+	{
+		std::byte* pMemory = m_pCursor + padding;
+		m_pCursor = pMemory + size;
+		m_usedBytes += padding + size;
+		return pMemory;
+	}
+
+	// 블록 크기보다 큰 요청은 전용 블록에 할당한다. 현재 블록은 계속 사용한다.
+	// new[]로 할당한 블록은 max_align_t 단위로 정렬되어 있다.
+	if (size + align > m_nextBlockSize)
+	{
+		m_blocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(size + align));
+		std::byte* pBlock = m_blocks.back().get();
+		m_reservedBytes += size + align;
+		m_usedBytes += size;
+		return pBlock + getPadding(pBlock, align);
+	}
+
+	// 새 블록. 스크립트가 클수록 블록 수가 적도록 최대 크기까지 두 배씩 늘린다.
+	m_blocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(m_nextBlockSize));
+	m_pCursor = m_blocks.back().get();
+	m_pEnd = m_pCursor + m_nextBlockSize;
+	m_reservedBytes += m_nextBlockSize;
+	m_nextBlockSize = (std::min)(m_nextBlockSize * 2, MAX_BLOCK_SIZE);
+
+	const size_t blockPadding = getPadding(m_pCursor, align);
+	std::byte* pMemory = m_pCursor + blockPadding;
+	m_pCursor = pMemory + size;
+	m_usedBytes += blockPadding + size;
+	return pMemory;
+}
+
+void ASTArena::Release()
+{
+	// 다른 스레드에서 해제한 노드의 소멸이 삭제보다 먼저 일어나도록 한다. (shared_ptr 제어 블록과 같은 방식)
+	if (1 == m_refCount.fetch_sub(1, std::memory_order_acq_rel))
+		delete this;
+}
+
+ASTArena::Scope::Scope(ASTArenaPtr spArena)
+	: m_spPrevArena(std::move(current()))
+{
+	current() = std::move(spArena);
+}
+
+ASTArena::Scope::~Scope()
+{
+	current() = std::move(m_spPrevArena);
+}
+
+const ASTArenaPtr& ASTArena::GetCurrent()
+{
+	return current();
+}
+
+ASTArenaPtr& ASTArena::current()
+{
+	static thread_local ASTArenaPtr spCurrent;
+	return spCurrent;
+}
+
+}
@@ -0,0 +1,125 @@
+﻿#pragma once
+
+/*
+AST 노드 아레나.
+스크립트 하나의 노드를 큰 블록에 차례로 할당하는 bump allocator이다. 노드마다 힙에 할당하지 않으므로 파싱이 빠르고,
+노드를 해제할 때 메모리를 돌려주지 않고 마지막 노드가 해제될 때 블록을 한 번에 해제한다.
+
+노드는 AST보다 오래 살아있을 수 있다. (IncrementalParser가 재사용하는 구문, DSLManager에 등록한 함수 정의, 실행 중인 Environment)
+그래서 자식 노드는 shared_ptr로 연결하고, 노드와 제어 블록을 std::allocate_shared로 아레나에 함께 할당한다.
+아레나는 살아있는 노드 수를 직접 센다. allocator는 포인터만 가지고 있어서 복사 비용이 없고, 할당할 때 1 증가, 해제할 때 1 감소한다.
+ASTArenaPtr도 하나의 참조로 센다. 따라서 아레나는 노드나 ASTArenaPtr가 하나라도 남아있는 동안 유지된다.
+
+파서는 스크립트를 파싱하는 동안 ASTArena::Scope로 현재 스레드의 아레나를 지정하고, 노드는 MakeNode로 생성한다.
+아레나가 지정되지 않았다면 MakeNode는 std::make_shared와 같다.
+*/
+
+namespace dsl
+{
+	class ASTArena;
+	using ASTArenaPtr = std::shared_ptr<ASTArena>;
+
+
+	// AST 노드 아레나. 한 스레드에서만 할당해야 한다. 해제(Release)는 어느 스레드에서 해도 된다.
+	class ASTArena
+	{
+	public:
+		// 아레나 생성. 반환한 ASTArenaPtr가 모두 해제되고 아레나에 할당한 노드도 모두 해제되면 아레나가 삭제된다.
+		// @firstBlockSize	: 첫 블록 크기. 노드를 조금만 할당하는 아레나는 작게 지정한다.
+		static ASTArenaPtr Create(const size_t firstBlockSize = FIRST_BLOCK_SIZE);
+
+		ASTArena(const ASTArena&) = delete;
+		ASTArena& operator=(const ASTArena&) = delete;
+
+	public:
+		// size 바이트를 align 단위로 정렬해서 할당한다. 블록이 부족하면 새 블록을 추가한다.
+		// 할당한 메모리마다 Release를 한 번 호출해야 한다.
+		void* Allocate(const size_t size, const size_t align);
+
+		// 참조 하나를 해제한다. 마지막 참조였다면 모든 블록과 함께 아레나를 삭제한다.
+		void Release();
+
+		size_t GetUsedBytes() const { return m_usedBytes; }				// 할당한 바이트 수 (정렬로 버린 공간 포함)
+		size_t GetReservedBytes() const { return m_reservedBytes; }		// 블록 크기의 합
+		size_t GetBlockCount() const { return m_blocks.size(); }
+		size_t GetAllocationCount() const { return m_allocationCount; }
+
+	public:
+		// 현재 스레드의 아레나를 지정한다. 소멸할 때 이전 아레나로 되돌린다.
+		class Scope
+		{
+		public:
+			explicit Scope(ASTArenaPtr spArena);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			ASTArenaPtr m_spPrevArena;
+		};
+
+		// 현재 스레드의 아레나. 지정하지 않았다면 nullptr
+		static const ASTArenaPtr& GetCurrent();
+
+	private:
+		explicit ASTArena(const size_t firstBlockSize);
+		~ASTArena() = default;
+
+		static ASTArenaPtr& current();
+
+		// pAddress를 align 단위로 맞추기 위한 바이트 수. align은 2의 거듭제곱이다.
+		static size_t getPadding(const std::byte* pAddress, const size_t align) { return (0 - reinterpret_cast<uintptr_t>(pAddress)) & (align - 1); }
+
+	private:
+		std::atomic<size_t>	m_refCount;		// 살아있는 노드 수 + 1 (ASTArenaPtr)
+
+		static constexpr size_t FIRST_BLOCK_SIZE = 4 * 1024;
+		static constexpr size_t MAX_BLOCK_SIZE = 1024 * 1024;
+
+		std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+		std::byte*	m_pCursor;			// 현재 블록에서 다음에 할당할 위치
+		std::byte*	m_pEnd;				// 현재 블록의 끝
+		size_t		m_nextBlockSize;
+
+		size_t		m_usedBytes;
+		size_t		m_reservedBytes;
+		size_t		m_allocationCount;
+	};
+
+
+	// 아레나에 할당하는 allocator. 해제하면 메모리는 돌려주지 않고 아레나의 참조만 해제한다.
+	template <typename T>
+	class ASTArenaAllocator
+	{
+	public:
+		using value_type = T;
+
+		explicit ASTArenaAllocator(ASTArena* pArena) : m_pArena(pArena) {}
+
+		template <typename U>
+		ASTArenaAllocator(const ASTArenaAllocator<U>& other) : m_pArena(other.GetArena()) {}
+
+		T* allocate(const size_t n) { return static_cast<T*>(m_pArena->Allocate(n * sizeof(T), alignof(T))); }
+		void deallocate(T*, const size_t) { m_pArena->Release(); }
+
+		ASTArena* GetArena() const { return m_pArena; }
+
+		template <typename U>
+		bool operator==(const ASTArenaAllocator<U>& other) const { return m_pArena == other.GetArena(); }
+
+	private:
+		ASTArena* m_pArena;
+	};
+
+
+	// AST 노드 생성. 현재 스레드의 아레나가 있으면 아레나에 할당한다.
+	template <typename T, typename... Args>
+	std::shared_ptr<T> MakeNode(Args&&... args)
+	{
+		if (const ASTArenaPtr& spArena = ASTArena::GetCurrent())
+			return std::allocate_shared<T>(ASTArenaAllocator<T>(spArena.get()), std::forward<Args>(args)...);
+
+		return std::make_shared<T>(std::forward<Args>(args)...);
+	}
+}
@@ -0,0 +1,708 @@
+﻿#include "pch.h"
+
+#include <cstring>
+
+#include "ast_cache.h"
+#include "token_parser.h"
+#include "script_file.h"
+
+namespace dsl
+{
+
+static constexpr char AST_CACHE_MAGIC[4] = { 'D', 'S', 'L', 'C' };
+
+// 파일에 저장한 함수 정의 하나의 최소 크기 (bytes)
+static constexpr size_t MIN_FUNCTION_BYTES = 5;
+
+// 스크립트 텍스트의 내용 해시
+// 8바이트씩 읽어서 곱셈으로 섞고, 마지막에 모든 비트가 결과에 고르게 퍼지도록 한 번 더 섞는다. (MurmurHash3 fmix64)
+uint64_t HashScriptText(std::string_view strUtf8Script)
+{
+	constexpr uint64_t prime = 0x100000001B3ull;
+	uint64_t hash = 0xCBF29CE484222325ull ^ strUtf8Script.size();
+
+	const char* pCur = strUtf8Script.data();
+	const char* const pEnd = pCur + strUtf8Script.size();
+	for (; 8 <= pEnd - pCur; pCur += 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, pCur, sizeof(word));
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 29;
+	}
+	for (; pCur < pEnd; ++pCur)
+		hash = (hash ^ static_cast<uint8_t>(*pCur)) * prime;
+
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDull;
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB9FE1A85EC53ull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+// 스크립트의 캐시 파일 경로
+// 캐시 폴더에는 여러 폴더의 스크립트가 모이므로 같은 파일 이름이 겹치지 않도록 스크립트 경로의 해시를 붙인다.
+std::wstring GetASTCachePath(const std::wstring& scriptName, const std::wstring& cacheDirectory)
+{
+	std::filesystem::path scriptPath(scriptName);
+	if (cacheDirectory.empty())
+		return scriptPath.replace_extension(L".dslc").wstring();
+
+	const uint64_t pathHash = HashScriptText(WideToUtf8(std::filesystem::absolute(scriptPath).lexically_normal().wstring()));
+	return (std::filesystem::path(cacheDirectory) / std::format(L"{}.{:016x}.dslc", scriptPath.stem().wstring(), pathHash)).wstring();
+}
+
+
+// AST 직렬화
+// 노드를 전위 순회하면서 노드 버퍼에 쓰고, 이름과 문자열은 처음 나올 때 테이블에 추가한다.
+class ASTCacheWriter
+{
+public:
+	void Write(const AST& ast, const uint64_t sourceHash, const uint64_t sourceLength, std::string& outData)
+	{
+		writeNode(ast);
+
+		ASTCacheHeader header;
+		std::memcpy(header.magic, AST_CACHE_MAGIC, sizeof(header.magic));
+		header.version = AST_CACHE_VERSION;
+		header.sourceHash = sourceHash;
+		header.sourceLength = sourceLength;
+		header.nodeCount = m_nodeCount;
+		header.functionCount = m_functionCount;
+		header.lazyFunctionCount = m_lazyFunctionCount;
+		header.symbolCount = static_cast<uint32_t>(m_symbols.size());
+		header.stringCount = static_cast<uint32_t>(m_strings.size());
+		header.reserved = 0;
+
+		outData.clear();
+		outData.reserve(sizeof(header) + m_tableBytes + m_nodes.size());
+		outData.append(reinterpret_cast<const char*>(&header), sizeof(header));
+		writeTable(m_symbols, outData);
+		writeTable(m_strings, outData);
+		outData.append(m_nodes);
+	}
+
+private:
+	template <typename T>
+	void writeValue(const T value)
+	{
+		m_nodes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void writeType(const EASTType eType)
+	{
+		writeValue(static_cast<uint8_t>(eType));
+	}
+
+	void writeChild(const BasePtr& spChild)
+	{
+		if (spChild)
+			writeNode(*spChild);
+		else
+			writeType(EASTType::Base);
+	}
+
+	void writeChildren(const std::vector<BasePtr>& children)
+	{
+		writeValue(static_cast<uint32_t>(children.size()));
+		for (const BasePtr& spChild : children)
+			writeChild(spChild);
+	}
+
+	void writeNode(const Base& node)
+	{
+		++m_nodeCount;
+		writeType(node.GetType());
+
+		VisitNode(node, [this](const auto& typedNode)
+			{
+				using T = std::decay_t<decltype(typedNode)>;
+				if constexpr (std::is_same_v<T, Name>)
+					writeValue(addSymbol(typedNode.id));
+				else if constexpr (std::is_same_v<T, NameList>)
+					writeChildren(typedNode.names);
+				else if constexpr (std::is_same_v<T, Numeral>)
+				{
+					writeValue(static_cast<uint8_t>(typedNode.isInteger));
+					if (typedNode.isInteger)
+						writeValue(static_cast<int64_t>(typedNode.intValue));
+					else
+						writeValue(typedNode.floatValue);
+				}
+				else if constexpr (std::is_same_v<T, Boolean>)
+					writeValue(static_cast<uint8_t>(typedNode.value));
+				else if constexpr (std::is_same_v<T, LiteralString>)
+					writeValue(addString(typedNode.GetValue()));
+				else if constexpr (std::is_same_v<T, AST>)
+					writeChild(typedNode.block);
+				else if constexpr (std::is_same_v<T, Block>)
+					writeChildren(typedNode.statements);
+				else if constexpr (std::is_same_v<T, Assignment>)
+				{
+					writeChild(typedNode.name);
+					writeChild(typedNode.expression);
+				}
+				else if constexpr (std::is_same_v<T, Expression>)
+					writeChild(typedNode.expression);
+				else if constexpr (std::is_same_v<T, ExpressionList>)
+					writeChildren(typedNode.expressions);
+				else if constexpr (std::is_same_v<T, PrimaryExpression>)
+					writeChild(typedNode.primaryExpression);
+				else if constexpr (std::is_same_v<T, BinaryExpression>)
+				{
+					writeValue(static_cast<uint8_t>(typedNode.binaryOperator));
+					writeChild(typedNode.primaryExpression1);
+					writeChild(typedNode.primaryExpression2);
+				}
+				else if constexpr (std::is_same_v<T, UnaryExpression>)
+				{
+					writeValue(static_cast<uint8_t>(typedNode.unaryOperator));
+					writeChild(typedNode.primaryExpression);
+				}
+				else if constexpr (std::is_same_v<T, FunctionDefinition>)
+					writeFunctionDefinition(typedNode);
+				else if constexpr (std::is_same_v<T, FunctionParameter>)
+					writeChild(typedNode.nameList);
+				else if constexpr (std::is_same_v<T, FunctionArgument>)
+					writeChild(typedNode.expressionList);
+				else if constexpr (std::is_same_v<T, FunctionCall>)
+				{
+					writeChild(typedNode.name);
+					writeChild(typedNode.functionArgument);
+				}
+				else if constexpr (std::is_same_v<T, Statement>)
+					writeChild(typedNode.statement);
+				else if constexpr (std::is_same_v<T, Return>)
+					writeChildren(typedNode.expressions);
+				else if constexpr (std::is_same_v<T, Break>)
+					writeValue(addString(typedNode.value));
+				else if constexpr (std::is_same_v<T, While>)
+				{
+					writeChild(typedNode.expression);
+					writeChild(typedNode.statDo);
+				}
+				else if constexpr (std::is_same_v<T, If>)
+				{
+					writeChild(typedNode.expression);
+					writeChild(typedNode.block);
+					writeChild(typedNode.statIf);
+				}
+				else if constexpr (std::is_same_v<T, For>)
+				{
+					writeChild(typedNode.name);
+					writeChild(typedNode.expression1);
+					writeChild(typedNode.expression2);
+					writeChild(typedNode.expression3);
+				}
+			});
+	}
+
+	// 본문은 [uint8 지연 여부] 다음에 Block 노드 또는 [uint64 offset][uint64 length]
+	// 지연 파싱하는 본문을 아직 파싱하지 않았거나 파싱에 실패했다면 텍스트 범위를 저장한다. 캐시를 쓰기 위해 본문을 파싱하지 않는다.
+	void writeFunctionDefinition(const FunctionDefinition& functionDefinition)
+	{
+		++m_functionCount;
+		writeChild(functionDefinition.name);
+		writeChild(functionDefinition.functionParameter);
+
+		const LazyFunctionBody* pLazyBody = functionDefinition.lazyBody.get();
+		if (pLazyBody && !pLazyBody->GetBlock())
+		{
+			++m_lazyFunctionCount;
+			writeValue(static_cast<uint8_t>(1));
+			writeValue(static_cast<uint64_t>(pLazyBody->GetOffset()));
+			writeValue(static_cast<uint64_t>(pLazyBody->GetLength()));
+			return;
+		}
+
+		writeValue(static_cast<uint8_t>(0));
+		writeChild(functionDefinition.GetParsedBlock());
+	}
+
+	uint32_t addSymbol(const SymbolId id)
+	{
+		const auto [iter, bInserted] = m_symbolIndex.emplace(id, static_cast<uint32_t>(m_symbols.size()));
+		if (bInserted)
+			addTableEntry(m_symbols, GetSymbolName(id));
+		return iter->second;
+	}
+
+	uint32_t addString(const std::wstring& str)
+	{
+		const auto [iter, bInserted] = m_stringIndex.emplace(str, static_cast<uint32_t>(m_strings.size()));
+		if (bInserted)
+			addTableEntry(m_strings, str);
+		return iter->second;
+	}
+
+	void addTableEntry(std::vector<std::string>& table, const std::wstring& str)
+	{
+		table.push_back(WideToUtf8(str));
+		m_tableBytes += sizeof(uint32_t) + table.back().size();
+	}
+
+	static void writeTable(const std::vector<std::string>& table, std::string& outData)
+	{
+		for (const std::string& str : table)
+		{
+			const uint32_t length = static_cast<uint32_t>(str.size());
+			outData.append(reinterpret_cast<const char*>(&length), sizeof(length));
+			outData.append(str);
+		}
+	}
+
+private:
+	std::string m_nodes;
+	uint32_t m_nodeCount = 0;
+	uint32_t m_functionCount = 0;
+	uint32_t m_lazyFunctionCount = 0;
+
+	std::vector<std::string> m_symbols;
+	std::unordered_map<SymbolId, uint32_t> m_symbolIndex;
+	std::vector<std::string> m_strings;
+	std::unordered_map<std::wstring, uint32_t> m_stringIndex;
+	size_t m_tableBytes = 0;
+};
+
+
+// AST 역직렬화
+// 데이터를 앞에서부터 읽으면서 노드를 만든다. 범위를 벗어나거나 값이 잘못되었으면 m_bFailed를 설정하고 멈춘다.
+class ASTCacheReader
+{
+public:
+	ASTCacheReader(std::string_view data, std::string_view strUtf8Script, std::vector<FunctionDefinitionCPtr>& functions)
+		: m_pCur(data.data())
+		, m_pEnd(data.data() + data.size())
+		, m_strUtf8Script(strUtf8Script)
+		, m_functions(functions)
+	{
+	}
+
+	ASTPtr Read(const uint64_t sourceHash, const bool bLazyFunctionBody)
+	{
+		ASTCacheHeader header;
+		if (!readValue(header))
+			return nullptr;
+
+		if (0 != std::memcmp(header.magic, AST_CACHE_MAGIC, sizeof(header.magic)) || AST_CACHE_VERSION != header.version)
+			return nullptr;
+		if (sourceHash != header.sourceHash || m_strUtf8Script.size() != header.sourceLength)
+			return nullptr;
+		if (!bLazyFunctionBody && 0 < header.lazyFunctionCount)
+			return nullptr;
+
+		// 헤더의 개수는 파일을 믿을 수 없으므로, 버퍼를 할당하기 전에 남은 크기로 확인한다.
+		// 이름과 문자열은 길이(4바이트) 이상이고, 함수 정의는 타입, 이름, 파라미터, 지연 여부, 본문으로 5바이트 이상이다.
+		const size_t remainBytes = static_cast<size_t>(m_pEnd - m_pCur);
+		if (remainBytes / sizeof(uint32_t) < static_cast<size_t>(header.symbolCount) + header.stringCount
+			|| remainBytes / MIN_FUNCTION_BYTES < header.functionCount
+			|| remainBytes < header.nodeCount)
+			return nullptr;
+
+		// 이름은 이 프로세스의 심볼 ID로 바꿔둔다.
+		m_symbols.resize(header.symbolCount);
+		for (SymbolId& id : m_symbols)
+		{
+			std::string_view str;
+			if (!readString(str))
+				return nullptr;
+			id = InternSymbol(Utf8ToWide(str));
+		}
+
+		ConstantPoolPtr spPool = std::make_shared<ConstantPool>();
+		m_strings.resize(header.stringCount);
+		for (std::wstring& str : m_strings)
+		{
+			std::string_view strUtf8;
+			if (!readString(strUtf8))
+				return nullptr;
+			str = Utf8ToWide(strUtf8);
+		}
+		m_pPool = spPool.get();
+
+		m_functions.clear();
+		m_functions.reserve(header.functionCount);
+
+		// 지연 파싱하는 본문은 생성할 때 현재 스레드의 상수 풀을 보관한다.
+		ConstantPool::Scope poolScope(spPool);
+		const ASTArenaPtr spArena = ASTArena::Create();
+		ASTArena::Scope arenaScope(spArena);
+
+		BasePtr spRoot = readNode();
+		if (m_bFailed || !spRoot || EASTType::AST != spRoot->GetType() || m_pCur != m_pEnd || header.nodeCount != m_nodeCount)
+		{
+			m_functions.clear();
+			return nullptr;
+		}
+
+		ASTPtr spAST = std::static_pointer_cast<AST>(spRoot);
+		spAST->constants = std::move(spPool);
+		spAST->arena = spArena;
+		return spAST;
+	}
+
+private:
+	template <typename T>
+	bool readValue(T& value)
+	{
+		if (m_bFailed || static_cast<size_t>(m_pEnd - m_pCur) < sizeof(T))
+			return fail();
+
+		std::memcpy(&value, m_pCur, sizeof(T));
+		m_pCur += sizeof(T);
+		return true;
+	}
+
+	bool readString(std::string_view& str)
+	{
+		uint32_t length = 0;
+		if (!readValue(length) || static_cast<size_t>(m_pEnd - m_pCur) < length)
+			return fail();
+
+		str = std::string_view(m_pCur, length);
+		m_pCur += length;
+		return true;
+	}
+
+	bool readIndex(const size_t count, uint32_t& index)
+	{
+		return readValue(index) && (index < count || fail());
+	}
+
+	bool readOperator(EOperator& eOperator)
+	{
+		uint8_t value = 0;
+		if (!readValue(value) || (value >= static_cast<uint8_t>(EOperator::Count) && fail()))
+			return false;
+
+		eOperator = static_cast<EOperator>(value);
+		return true;
+	}
+
+	bool fail()
+	{
+		m_bFailed = true;
+		return false;
+	}
+
+	void readChildren(std::vector<BasePtr>& children)
+	{
+		uint32_t count = 0;
+		// 자식 노드는 1바이트 이상이므로 남은 크기보다 많을 수 없다.
+		if (!readValue(count) || static_cast<size_t>(m_pEnd - m_pCur) < count)
+		{
+			fail();
+			return;
+		}
+
+		children.reserve(count);
+		for (uint32_t i = 0; i < count && !m_bFailed; ++i)
+			children.push_back(readNode());
+	}
+
+	// 지연 파싱하는 본문. 파서의 lazy 모드처럼 스크립트 텍스트를 복사해서 본문들이 공유한다.
+	std::shared_ptr<LazyFunctionBody> readLazyBody()
+	{
+		uint64_t offset = 0;
+		uint64_t length = 0;
+		if (!readValue(offset) || !readValue(length) || m_strUtf8Script.size() < offset || m_strUtf8Script.size() - offset < length)
+		{
+			fail();
+			return nullptr;
+		}
+
+		if (!m_spLazySource)
+			m_spLazySource = std::make_shared<const std::string>(m_strUtf8Script);
+
+		return std::make_shared<LazyFunctionBody>(m_spLazySource, static_cast<size_t>(offset), static_cast<size_t>(length));
+	}
+
+	// 노드 하나와 하위 노드를 읽는다. nullptr로 저장된 자식이거나 실패하면 nullptr를 반환한다.
+	BasePtr readNode()
+	{
+		uint8_t type = 0;
+		if (!readValue(type))
+			return nullptr;
+
+		const EASTType eType = static_cast<EASTType>(type);
+		if (EASTType::Base == eType)
+			return nullptr;
+
+		++m_nodeCount;
+		switch (eType)
+		{
+		case EASTType::Name:
+		{
+			uint32_t index = 0;
+			if (!readIndex(m_symbols.size(), index))
+				return nullptr;
+			return MakeNode<Name>(m_symbols[index]);
+		}
+		case EASTType::NameList:
+		{
+			NameListPtr spNode = MakeNode<NameList>();
+			readChildren(spNode->names);
+			return spNode;
+		}
+		case EASTType::Numeral:
+		{
+			uint8_t isInteger = 0;
+			if (!readValue(isInteger))
+				return nullptr;
+
+			if (isInteger)
+			{
+				int64_t value = 0;
+				readValue(value);
+				return MakeNode<Numeral>(static_cast<__int64>(value));
+			}
+
+			double value = 0.0;
+			readValue(value);
+			return MakeNode<Numeral>(value);
+		}
+		case EASTType::Boolean:
+		{
+			uint8_t value = 0;
+			readValue(value);
+			return MakeNode<Boolean>(0 != value);
+		}
+		case EASTType::LiteralString:
+		{
+			uint32_t index = 0;
+			if (!readIndex(m_strings.size(), index))
+				return nullptr;
+
+			// 파싱할 때처럼 리터럴마다 상수 풀에서 버퍼를 얻는다. 상수 풀의 통계가 파싱한 AST와 같아진다.
+			LiteralStringPtr spNode = MakeNode<LiteralString>();
+			spNode->value = m_pPool->Intern(m_strings[index]);
+			return spNode;
+		}
+		case EASTType::AST:
+		{
+			ASTPtr spNode = MakeNode<AST>();
+			spNode->block = readNode();
+			return spNode;
+		}
+		case EASTType::Block:
+		{
+			BlockPtr spNode = MakeNode<Block>();
+			readChildren(spNode->statements);
+			return spNode;
+		}
+		case EASTType::Assignment:
+		{
+			AssignmentPtr spNode = MakeNode<Assignment>();
+			spNode->name = readNode();
+			spNode->expression = readNode();
+			return spNode;
+		}
+		case EASTType::Expression:
+		{
+			ExpressionPtr spNode = MakeNode<Expression>();
+			spNode->expression = readNode();
+			return spNode;
+		}
+		case EASTType::ExpressionList:
+		{
+			ExpressionListPtr spNode = MakeNode<ExpressionList>();
+			readChildren(spNode->expressions);
+			return spNode;
+		}
+		case EASTType::PrimaryExpression:
+		{
+			PrimaryExpressionPtr spNode = MakeNode<PrimaryExpression>();
+			spNode->primaryExpression = readNode();
+			return spNode;
+		}
+		case EASTType::BinaryExpression:
+		{
+			EOperator eOperator = EOperator::None;
+			if (!readOperator(eOperator))
+				return nullptr;
+
+			BinaryExpressionPtr spNode = MakeNode<BinaryExpression>();
+			spNode->binaryOperator = eOperator;
+			spNode->primaryExpression1 = readNode();
+			spNode->primaryExpression2 = readNode();
+			return spNode;
+		}
+		case EASTType::UnaryExpression:
+		{
+			EOperator eOperator = EOperator::None;
+			if (!readOperator(eOperator))
+				return nullptr;
+
+			UnaryExpressionPtr spNode = MakeNode<UnaryExpression>();
+			spNode->unaryOperator = eOperator;
+			spNode->primaryExpression = readNode();
+			return spNode;
+		}
+		case EASTType::FunctionDefinition:
+		{
+			// 바깥 함수가 안쪽 함수보다 앞에 오도록 자리를 먼저 잡는다.
+			const size_t functionIndex = m_functions.size();
+			m_functions.emplace_back();
+
+			FunctionDefinitionPtr spNode = MakeNode<FunctionDefinition>();
+			spNode->name = readNode();
+			spNode->functionParameter = readNode();
+
+			uint8_t bLazy = 0;
+			if (!readValue(bLazy))
+				return nullptr;
+
+			if (bLazy)
+				spNode->lazyBody = readLazyBody();
+			else
+				spNode->block = readNode();
+
+			if (m_bFailed || EASTType::Name != (spNode->name ? spNode->name->GetType() : EASTType::Base))
+			{
+				fail();
+				return nullptr;
+			}
+
+			m_functions[functionIndex] = spNode;
+			return spNode;
+		}
+		case EASTType::FunctionParameter:
+		{
+			FunctionParameterPtr spNode = MakeNode<FunctionParameter>();
+			spNode->nameList = readNode();
+			return spNode;
+		}
+		case EASTType::FunctionArgument:
+		{
+			FunctionArgumentPtr spNode = MakeNode<FunctionArgument>();
+			spNode->expressionList = readNode();
+			return spNode;
+		}
+		case EASTType::FunctionCall:
+		{
+			FunctionCallPtr spNode = MakeNode<FunctionCall>();
+			spNode->name = readNode();
+			spNode->functionArgument = readNode();
+			return spNode;
+		}
+		case EASTType::Statement:
+		{
+			StatementPtr spNode = MakeNode<Statement>();
+			spNode->statement = readNode();
+			return spNode;
+		}
+		case EASTType::Return:
+		{
+			ReturnPtr spNode = MakeNode<Return>();
+			readChildren(spNode->expressions);
+			return spNode;
+		}
+		case EASTType::Break:
+		{
+			uint32_t index = 0;
+			if (!readIndex(m_strings.size(), index))
+				return nullptr;
+
+			BreakPtr spNode = MakeNode<Break>();
+			spNode->value = m_strings[index];
+			return spNode;
+		}
+		case EASTType::While:
+		{
+			WhilePtr spNode = MakeNode<While>();
+			spNode->expression = readNode();
+			spNode->statDo = readNode();
+			return spNode;
+		}
+		case EASTType::If:
+		{
+			IfPtr spNode = MakeNode<If>();
+			spNode->expression = readNode();
+			spNode->block = readNode();
+			spNode->statIf = readNode();
+			return spNode;
+		}
+		case EASTType::For:
+		{
+			ForPtr spNode = MakeNode<For>();
+			spNode->name = readNode();
+			spNode->expression1 = readNode();
+			spNode->expression2 = readNode();
+			spNode->expression3 = readNode();
+			return spNode;
+		}
+		default:
+			fail();
+			return nullptr;
+		}
+	}
+
+private:
+	const char* m_pCur;
+	const char* const m_pEnd;
+	bool m_bFailed = false;
+	uint32_t m_nodeCount = 0;
+
+	std::string_view m_strUtf8Script;
+	std::shared_ptr<const std::string> m_spLazySource;	// 지연 파싱하는 본문이 공유하는 스크립트 텍스트. 처음 필요할 때 복사한다.
+
+	std::vector<SymbolId> m_symbols;			// 파일의 심볼 번호별 심볼 ID
+	std::vector<std::wstring> m_strings;		// 파일의 문자열 번호별 문자열
+	ConstantPool* m_pPool = nullptr;			// 만들고 있는 AST의 상수 풀
+
+	std::vector<FunctionDefinitionCPtr>& m_functions;
+};
+
+
+void SerializeAST(const AST& ast, const uint64_t sourceHash, const uint64_t sourceLength, std::string& outData)
+{
+	ASTCacheWriter().Write(ast, sourceHash, sourceLength, outData);
+}
+
+ASTPtr DeserializeAST(std::string_view data, std::string_view strUtf8Script, const uint64_t sourceHash, const bool bLazyFunctionBody, std::vector<FunctionDefinitionCPtr>& functions)
+{
+	return ASTCacheReader(data, strUtf8Script, functions).Read(sourceHash, bLazyFunctionBody);
+}
+
+// 캐시 파일을 쓴다.
+// 여러 스레드나 프로세스가 같은 캐시를 쓸 수 있으므로 임시 파일 이름에 스레드 ID를 붙인다.
+bool WriteASTCache(const std::wstring& cachePath, const AST& ast, const uint64_t sourceHash, const uint64_t sourceLength)
+{
+	std::string data;
+	SerializeAST(ast, sourceHash, sourceLength, data);
+
+	const std::filesystem::path path(cachePath);
+	const std::filesystem::path tempPath = path.wstring() + std::format(L".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+	std::error_code error;
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path(), error);
+
+	{
+		std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.write(data.data(), data.size()))
+			return false;
+	}
+
+	std::filesystem::rename(tempPath, path, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	return true;
+}
+
+// 캐시 파일을 메모리에 매핑해서 읽는다. 노드를 만든 다음에는 매핑이 필요없으므로 바로 닫는다.
+ASTPtr ReadASTCache(const std::wstring& cachePath, std::string_view strUtf8Script, const uint64_t sourceHash, const bool bLazyFunctionBody, std::vector<FunctionDefinitionCPtr>& functions)
+{
+	ScriptFile cacheFile;
+	if (!cacheFile.Open(cachePath))
+		return nullptr;
+
+	return DeserializeAST(cacheFile.GetText(), strUtf8Script, sourceHash, bLazyFunctionBody, functions);
+}
+
+}
@@ -0,0 +1,63 @@
+﻿#pragma once
+
+#include "ast.h"
+
+/*
+AST 캐시 (.dslc)
+파싱한 AST를 바이너리로 저장해 두었다가, 다음에 같은 스크립트를 로드할 때 파싱하지 않고 노드를 다시 만든다.
+캐시 파일은 메모리에 매핑해서(ScriptFile) 읽는다. 노드는 스크립트를 파싱할 때처럼 스크립트 전용 아레나와 상수 풀에 만든다.
+
+캐시 파일은 형식 버전과 스크립트 텍스트의 내용 해시를 가지고 있다. 버전이나 해시가 다르거나 파일이 손상되었으면 읽지 않는다.
+이 때 호출한 쪽은 스크립트를 파싱하고 캐시를 다시 쓴다.
+
+파일 형식 (리틀 엔디언)
+  헤더			: ASTCacheHeader
+  심볼 테이블		: 이름 수만큼 [uint32 길이][UTF-8]. 심볼 ID는 프로세스마다 다르므로 이름을 저장하고 읽을 때 다시 발급한다.
+  문자열 테이블	: 문자열 수만큼 [uint32 길이][UTF-8]. 문자열 리터럴, Break의 값
+  노드			: 전위 순회 순서. 노드마다 [uint8 EASTType] 다음에 값과 자식 노드가 온다. nullptr인 자식은 EASTType::Base로 저장한다. 연산자는 [uint8 EOperator]로 저장한다.
+				  파싱하지 않은 지연 함수 본문은 노드 대신 스크립트 텍스트의 범위를 저장하고, 읽을 때 다시 LazyFunctionBody를 만든다.
+*/
+
+namespace dsl
+{
+	// 캐시 파일 형식 버전. 노드 구조나 파일 형식이 바뀌면 올린다.
+	inline constexpr uint32_t AST_CACHE_VERSION = 2;
+
+	// 캐시 파일 헤더
+	struct ASTCacheHeader
+	{
+		char		magic[4];			// "DSLC"
+		uint32_t	version;			// AST_CACHE_VERSION
+		uint64_t	sourceHash;			// 스크립트 텍스트의 내용 해시 (HashScriptText)
+		uint64_t	sourceLength;		// 스크립트 텍스트 크기 (bytes)
+		uint32_t	nodeCount;
+		uint32_t	functionCount;
+		uint32_t	lazyFunctionCount;	// 본문을 텍스트 범위로 저장한 함수 수
+		uint32_t	symbolCount;
+		uint32_t	stringCount;
+		uint32_t	reserved;			// 0
+	};
+
+
+	// 스크립트 텍스트의 내용 해시. 8바이트씩 섞는 64비트 해시이다.
+	uint64_t HashScriptText(std::string_view strUtf8Script);
+
+	// 스크립트의 캐시 파일 경로
+	// @cacheDirectory	: 비어있으면 스크립트 파일 옆에 확장자를 .dslc로 바꾼 경로. 지정하면 그 폴더 안에 스크립트 경로의 해시를 붙인 파일 이름
+	std::wstring GetASTCachePath(const std::wstring& scriptName, const std::wstring& cacheDirectory);
+
+	// AST를 캐시 형식으로 직렬화한다. 지연 파싱하는 함수 본문은 파싱하지 않고, 아직 파싱하지 않았다면 텍스트 범위를 저장한다.
+	void SerializeAST(const AST& ast, const uint64_t sourceHash, const uint64_t sourceLength, std::string& outData);
+
+	// 캐시 데이터로 AST를 만든다. 버전, 해시, 크기가 다르거나 데이터가 손상되었으면 nullptr를 반환한다.
+	// @strUtf8Script		: 캐시를 만든 스크립트 텍스트. 지연 파싱하는 함수 본문이 복사해서 보관한다.
+	// @bLazyFunctionBody	: false이면 지연 파싱하는 함수 본문이 있는 캐시는 사용하지 않는다. 호출한 쪽이 스크립트를 파싱해서 캐시를 다시 쓴다.
+	// @functions			: 함수 정의. 파서가 기록하는 함수 목록과 같이 전위 순회 순서이다. (ParserContext::GetLastFunctions)
+	ASTPtr DeserializeAST(std::string_view data, std::string_view strUtf8Script, const uint64_t sourceHash, const bool bLazyFunctionBody, std::vector<FunctionDefinitionCPtr>& functions);
+
+	// 캐시 파일을 쓴다. 임시 파일에 쓴 다음 이름을 바꾸므로, 읽는 쪽이 쓰다 만 파일을 보지 않는다.
+	bool WriteASTCache(const std::wstring& cachePath, const AST& ast, const uint64_t sourceHash, const uint64_t sourceLength);
+
+	// 캐시 파일을 메모리에 매핑해서 AST를 만든다. 파일이 없거나 DeserializeAST가 실패하면 nullptr를 반환한다.
+	ASTPtr ReadASTCache(const std::wstring& cachePath, std::string_view strUtf8Script, const uint64_t sourceHash, const bool bLazyFunctionBody, std::vector<FunctionDefinitionCPtr>& functions);
+}
@@ -0,0 +1,186 @@
+﻿#include "pch.h"
+
+#include "ast_normalize.h"
+#include "token_parser.h"
+
+namespace dsl
+{
+
+// 래퍼 노드의 안쪽 노드. 래퍼 노드가 아니면 nullptr
+static BasePtr* getWrappedNode(Base& node)
+{
+	switch (node.GetType())
+	{
+	case EASTType::Expression:			return &static_cast<Expression&>(node).expression;
+	case EASTType::PrimaryExpression:	return &static_cast<PrimaryExpression&>(node).primaryExpression;
+	case EASTType::Statement:			return &static_cast<Statement&>(node).statement;
+	case EASTType::FunctionArgument:	return &static_cast<FunctionArgument&>(node).expressionList;
+	case EASTType::FunctionParameter:	return &static_cast<FunctionParameter&>(node).nameList;
+	default:							return nullptr;
+	}
+}
+
+// 안쪽 노드가 없는 래퍼를 대신할 빈 노드. 인자가 없는 FunctionArgument는 빈 ExpressionList, 파라미터가 없는 FunctionParameter는 빈 NameList가 된다.
+// 다른 래퍼는 nullptr (그대로 둔다)
+static BasePtr makeEmptyWrappedNode(const Base& node)
+{
+	switch (node.GetType())
+	{
+	case EASTType::FunctionArgument:	return MakeNode<ExpressionList>();
+	case EASTType::FunctionParameter:	return MakeNode<NameList>();
+	default:							return nullptr;
+	}
+}
+
+static void normalizeNode(BasePtr& spNode, ASTNormalizeStats& stats);
+
+static void normalizeChildren(std::vector<BasePtr>& children, ASTNormalizeStats& stats)
+{
+	for (BasePtr& spChild : children)
+		normalizeNode(spChild, stats);
+}
+
+// 노드의 자식을 정규화한다. 자식의 순서는 Iterate와 같다.
+static void normalizeChildren(Base& node, ASTNormalizeStats& stats)
+{
+	switch (node.GetType())
+	{
+	case EASTType::NameList:
+		normalizeChildren(static_cast<NameList&>(node).names, stats);
+		break;
+	case EASTType::AST:
+		normalizeNode(static_cast<AST&>(node).block, stats);
+		break;
+	case EASTType::Block:
+		normalizeChildren(static_cast<Block&>(node).statements, stats);
+		break;
+	case EASTType::Assignment:
+	{
+		Assignment& assignment = static_cast<Assignment&>(node);
+		normalizeNode(assignment.name, stats);
+		normalizeNode(assignment.expression, stats);
+		break;
+	}
+	case EASTType::ExpressionList:
+		normalizeChildren(static_cast<ExpressionList&>(node).expressions, stats);
+		break;
+	case EASTType::BinaryExpression:
+	{
+		BinaryExpression& binaryExpression = static_cast<BinaryExpression&>(node);
+		normalizeNode(binaryExpression.primaryExpression1, stats);
+		normalizeNode(binaryExpression.primaryExpression2, stats);
+		break;
+	}
+	case EASTType::UnaryExpression:
+		normalizeNode(static_cast<UnaryExpression&>(node).primaryExpression, stats);
+		break;
+	case EASTType::FunctionDefinition:
+	{
+		FunctionDefinition& functionDefinition = static_cast<FunctionDefinition&>(node);
+		normalizeNode(functionDefinition.name, stats);
+		normalizeNode(functionDefinition.functionParameter, stats);
+		normalizeNode(functionDefinition.block, stats);
+
+		// 지연 파싱하는 본문은 파싱할 때 정규화한다.
+		if (functionDefinition.lazyBody)
+			functionDefinition.lazyBody->SetNormalize();
+		break;
+	}
+	case EASTType::FunctionCall:
+	{
+		FunctionCall& functionCall = static_cast<FunctionCall&>(node);
+		normalizeNode(functionCall.name, stats);
+		normalizeNode(functionCall.functionArgument, stats);
+		break;
+	}
+	case EASTType::Return:
+		normalizeChildren(static_cast<Return&>(node).expressions, stats);
+		break;
+	case EASTType::While:
+	{
+		While& statWhile = static_cast<While&>(node);
+		normalizeNode(statWhile.expression, stats);
+		normalizeNode(statWhile.statDo, stats);
+		break;
+	}
+	case EASTType::If:
+	{
+		If& statIf = static_cast<If&>(node);
+		normalizeNode(statIf.expression, stats);
+		normalizeNode(statIf.block, stats);
+		normalizeNode(statIf.statIf, stats);
+		break;
+	}
+	case EASTType::For:
+	{
+		For& statFor = static_cast<For&>(node);
+		normalizeNode(statFor.name, stats);
+		normalizeNode(statFor.expression1, stats);
+		normalizeNode(statFor.expression2, stats);
+		normalizeNode(statFor.expression3, stats);
+		break;
+	}
+	default:
+		break;	// Name, Numeral, Boolean, LiteralString, Break, 안쪽 노드가 없는 Expression, PrimaryExpression, Statement
+	}
+}
+
+// 래퍼 노드를 안쪽 노드로 바꾼 다음 자식을 정규화한다.
+static void normalizeNode(BasePtr& spNode, ASTNormalizeStats& stats)
+{
+	while (spNode)
+	{
+		BasePtr* pspWrapped = getWrappedNode(*spNode);
+		if (!pspWrapped)
+			break;
+
+		// 빈 인자, 빈 파라미터도 다른 함수 호출, 정의와 같은 모양이 되도록 빈 목록 노드로 바꾼다.
+		if (!*pspWrapped)
+		{
+			if (BasePtr spEmpty = makeEmptyWrappedNode(*spNode))
+				spNode = std::move(spEmpty);
+			break;
+		}
+
+		// 안쪽 노드를 먼저 복사한다. spNode를 바꾸면 래퍼 노드가 해제된다.
+		BasePtr spWrapped = *pspWrapped;
+		spNode = std::move(spWrapped);
+		++stats.removedNodeCount;
+	}
+
+	if (!spNode)
+		return;
+
+	++stats.nodeCount;
+	normalizeChildren(*spNode, stats);
+}
+
+void NormalizeAST(BasePtr& spNode, ASTNormalizeStats* pStats /*= nullptr*/)
+{
+	ASTNormalizeStats stats;
+	normalizeNode(spNode, stats);
+
+	if (pStats)
+	{
+		pStats->nodeCount += stats.nodeCount;
+		pStats->removedNodeCount += stats.removedNodeCount;
+	}
+}
+
+void NormalizeAST(AST& ast, ASTNormalizeStats* pStats /*= nullptr*/)
+{
+	// 빈 인자, 빈 파라미터를 대신하는 노드는 AST의 아레나에 할당한다.
+	ASTArena::Scope scope(ast.arena);
+
+	ASTNormalizeStats stats;
+	++stats.nodeCount;
+	normalizeNode(ast.block, stats);
+
+	if (pStats)
+	{
+		pStats->nodeCount += stats.nodeCount;
+		pStats->removedNodeCount += stats.removedNodeCount;
+	}
+}
+
+}
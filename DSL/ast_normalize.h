@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include "ast.h"
+
+/*
+AST 정규화
+파서는 grammar 규칙마다 노드를 만들기 때문에 안쪽 노드 하나만 가지고 있는 래퍼 노드가 많다.
+  Expression, PrimaryExpression, Statement	: 식, 구문
+  FunctionArgument						: FunctionCall의 ExpressionList
+  FunctionParameter						: FunctionDefinition의 NameList
+래퍼 노드는 노드 하나만큼의 메모리를 쓰고, Environment에서는 call stack을 한 번 더 넣고 빼야 한다.
+
+NormalizeAST는 래퍼 노드를 가리키는 자식을 안쪽 노드로 바꾼다.
+정규화한 Block은 구문(Assignment, FunctionCall 등)을 바로 가지고, FunctionCall은 인자 식의 ExpressionList를 바로 가지며,
+ExpressionList와 BinaryExpression 등은 식 노드를 바로 가진다.
+인자가 없는 FunctionArgument는 빈 ExpressionList로, 파라미터가 없는 FunctionParameter는 빈 NameList로 바꾸므로
+정규화한 FunctionCall의 인자는 항상 ExpressionList, FunctionDefinition의 파라미터는 항상 NameList이다.
+노드를 다른 타입의 자식으로 바꿀 뿐 노드 구조체는 그대로이므로, 노드 타입으로 분기하는 코드(Environment, 출력, 캐시, 공유)는 그대로 사용한다.
+
+노드를 제자리에서 바꾸므로 다른 스레드가 AST를 보기 전(파싱하거나 캐시를 읽은 직후)에 호출한다.
+제거한 래퍼 노드는 해제되지만, 아레나에 할당한 노드의 메모리는 아레나를 해제할 때 돌려준다. (노드 공유 모드는 남은 노드만 새 아레나에 복사한다.)
+파싱하지 않은 지연 함수 본문은 본문을 파싱할 때 정규화한다.
+*/
+
+namespace dsl
+{
+	// 정규화 결과
+	struct ASTNormalizeStats
+	{
+		size_t nodeCount = 0;			// 정규화한 다음의 노드 수
+		size_t removedNodeCount = 0;	// 제거한 래퍼 노드 수
+	};
+
+	// 하위 트리의 래퍼 노드를 제거한다. 노드 자체가 래퍼면 spNode를 안쪽 노드로 바꾼다.
+	// @pStats	: 노드 수 (nullptr 가능). 결과를 더한다.
+	void NormalizeAST(BasePtr& spNode, ASTNormalizeStats* pStats = nullptr);
+
+	// AST의 래퍼 노드를 제거한다.
+	void NormalizeAST(AST& ast, ASTNormalizeStats* pStats = nullptr);
+}
@@ -0,0 +1,348 @@
+﻿#include "pch.h"
+
+#include <bit>
+#include <optional>
+#include <span>
+
+#include "ast_share.h"
+
+namespace dsl
+{
+
+// 테이블이 이 크기보다 작으면 만료된 항목을 지우지 않는다.
+static constexpr size_t MIN_PURGE_SIZE = 4096;
+
+// 공유하지 않는 노드의 아레나의 첫 블록 크기. 파싱하지 않은 지연 함수만 할당하므로 파서의 아레나보다 작게 시작한다.
+static constexpr size_t SHARE_ARENA_FIRST_BLOCK_SIZE = 512;
+
+// 공유 노드를 힙에 할당하면서 할당한 크기(제어 블록 포함)를 더하는 allocator
+template <typename T>
+class ShareHeapAllocator
+{
+public:
+	using value_type = T;
+
+	explicit ShareHeapAllocator(size_t* pBytes) : m_pBytes(pBytes) {}
+
+	template <typename U>
+	ShareHeapAllocator(const ShareHeapAllocator<U>& other) : m_pBytes(other.m_pBytes) {}
+
+	T* allocate(const size_t n)
+	{
+		*m_pBytes += n * sizeof(T);
+		return std::allocator<T>().allocate(n);
+	}
+
+	void deallocate(T* p, const size_t n) { std::allocator<T>().deallocate(p, n); }
+
+	template <typename U>
+	bool operator==(const ShareHeapAllocator<U>& other) const { return m_pBytes == other.m_pBytes; }
+
+private:
+	template <typename U>
+	friend class ShareHeapAllocator;
+
+	size_t* m_pBytes;	// 할당한 크기를 더할 곳. 할당할 때만 사용하므로 노드보다 먼저 사라져도 된다.
+};
+
+// 노드의 자식. 값이 nullptr인 자식도 포함하며, 순서는 ForEachChild와 같다.
+// 자식 목록(std::vector)이 있는 노드는 span, 나머지는 자식 참조의 배열을 반환한다.
+template <typename T>
+static auto getChildren(T& node)
+{
+	using Node = std::remove_const_t<T>;
+	using Ref = std::reference_wrapper<std::conditional_t<std::is_const_v<T>, const BasePtr, BasePtr>>;
+
+	if constexpr (std::is_same_v<Node, NameList>)
+		return std::span(node.names);
+	else if constexpr (std::is_same_v<Node, Block>)
+		return std::span(node.statements);
+	else if constexpr (std::is_same_v<Node, ExpressionList> || std::is_same_v<Node, Return>)
+		return std::span(node.expressions);
+	else if constexpr (std::is_same_v<Node, AST>)
+		return std::array<Ref, 1>{ node.block };
+	else if constexpr (std::is_same_v<Node, Assignment>)
+		return std::array<Ref, 2>{ node.name, node.expression };
+	else if constexpr (std::is_same_v<Node, Expression>)
+		return std::array<Ref, 1>{ node.expression };
+	else if constexpr (std::is_same_v<Node, PrimaryExpression> || std::is_same_v<Node, UnaryExpression>)
+		return std::array<Ref, 1>{ node.primaryExpression };
+	else if constexpr (std::is_same_v<Node, BinaryExpression>)
+		return std::array<Ref, 2>{ node.primaryExpression1, node.primaryExpression2 };
+	else if constexpr (std::is_same_v<Node, FunctionDefinition>)
+		return std::array<Ref, 3>{ node.name, node.functionParameter, node.block };
+	else if constexpr (std::is_same_v<Node, FunctionParameter>)
+		return std::array<Ref, 1>{ node.nameList };
+	else if constexpr (std::is_same_v<Node, FunctionArgument>)
+		return std::array<Ref, 1>{ node.expressionList };
+	else if constexpr (std::is_same_v<Node, FunctionCall>)
+		return std::array<Ref, 2>{ node.name, node.functionArgument };
+	else if constexpr (std::is_same_v<Node, Statement>)
+		return std::array<Ref, 1>{ node.statement };
+	else if constexpr (std::is_same_v<Node, While>)
+		return std::array<Ref, 2>{ node.expression, node.statDo };
+	else if constexpr (std::is_same_v<Node, If>)
+		return std::array<Ref, 3>{ node.expression, node.block, node.statIf };
+	else if constexpr (std::is_same_v<Node, For>)
+		return std::array<Ref, 4>{ node.name, node.expression1, node.expression2, node.expression3 };
+	else
+		return std::array<Ref, 0>{};	// Name, Numeral, Boolean, LiteralString, Break
+}
+
+// 자식을 제외한 노드의 값이 같은지 여부
+template <typename T>
+static bool isSameValue(const T& lhs, const T& rhs)
+{
+	if constexpr (std::is_same_v<T, Name>)
+		return lhs.id == rhs.id;
+	else if constexpr (std::is_same_v<T, Numeral>)
+		return lhs.isInteger == rhs.isInteger && lhs.intValue == rhs.intValue && std::bit_cast<uint64_t>(lhs.floatValue) == std::bit_cast<uint64_t>(rhs.floatValue);
+	else if constexpr (std::is_same_v<T, Boolean>)
+		return lhs.value == rhs.value;
+	else if constexpr (std::is_same_v<T, LiteralString>)
+		return lhs.value == rhs.value || *lhs.value == *rhs.value;
+	else if constexpr (std::is_same_v<T, BinaryExpression>)
+		return lhs.binaryOperator == rhs.binaryOperator;
+	else if constexpr (std::is_same_v<T, UnaryExpression>)
+		return lhs.unaryOperator == rhs.unaryOperator;
+	else if constexpr (std::is_same_v<T, Break>)
+		return lhs.value == rhs.value;
+	else if constexpr (std::is_same_v<T, FunctionDefinition>)
+		return lhs.lazyBody == rhs.lazyBody;
+	else
+		return true;
+}
+
+static size_t mixHash(const size_t seed, const size_t value)
+{
+	return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
+
+// 자식을 제외한 노드 값의 해시
+template <typename T>
+static size_t hashValue(const T& node)
+{
+	if constexpr (std::is_same_v<T, Name>)
+		return std::hash<SymbolId>()(node.id);
+	else if constexpr (std::is_same_v<T, Numeral>)
+		return node.isInteger ? std::hash<__int64>()(node.intValue) : std::hash<uint64_t>()(std::bit_cast<uint64_t>(node.floatValue)) + 1;
+	else if constexpr (std::is_same_v<T, Boolean>)
+		return node.value ? 1 : 0;
+	else if constexpr (std::is_same_v<T, LiteralString>)
+		return std::hash<std::wstring>()(*node.value);
+	else if constexpr (std::is_same_v<T, BinaryExpression>)
+		return static_cast<size_t>(node.binaryOperator);
+	else if constexpr (std::is_same_v<T, UnaryExpression>)
+		return static_cast<size_t>(node.unaryOperator);
+	else if constexpr (std::is_same_v<T, Break>)
+		return std::hash<std::wstring>()(node.value);
+	else
+		return 0;
+}
+
+// 노드의 값과 자식 노드 주소의 해시
+template <typename T>
+static size_t hashNode(const T& node)
+{
+	size_t hash = mixHash(static_cast<size_t>(T::NodeType), hashValue(node));
+	for (const BasePtr& spChild : getChildren(node))
+		hash = mixHash(hash, std::hash<const Base*>()(spChild.get()));
+
+	return hash;
+}
+
+
+// AST 하나를 공유 노드로 다시 만든다. 테이블 lock을 잡은 상태에서 사용한다.
+class ASTShareTable::Builder
+{
+public:
+	Builder(ASTShareTable& table, ASTShareStats& stats)
+		: m_table(table)
+		, m_stats(stats)
+	{
+	}
+
+	// 노드를 공유 노드로 바꾼다. 알 수 없는 타입의 노드는 그대로 사용한다.
+	BasePtr Share(const BasePtr& spNode)
+	{
+		if (!spNode)
+			return nullptr;
+
+		return VisitNode(*spNode, [this, &spNode](const auto& node) -> BasePtr
+			{
+				if constexpr (std::is_same_v<std::decay_t<decltype(node)>, Base>)
+					return spNode;
+				else
+					return shareNode(node);
+			});
+	}
+
+	// 공유하지 않는 노드의 아레나. 그런 노드가 없으면 nullptr
+	const ASTArenaPtr& GetArena() const { return m_spArena; }
+
+	// 테이블에 넣을 공유 노드를 힙에 할당한다.
+	// 다른 스크립트가 이 노드를 공유해도 노드 하나만 남는다. 아레나에 할당하면 노드 하나가 아레나 전체를 붙잡는다.
+	template <typename T>
+	std::shared_ptr<T> MakeSharedCopy(T&& node)
+	{
+		return std::allocate_shared<T>(ShareHeapAllocator<T>(&m_stats.heapBytes), std::move(node));
+	}
+
+	// 공유하지 않는 노드를 스크립트의 아레나에 할당한다. 아레나는 처음 할당하는 노드가 있을 때 만든다.
+	template <typename T>
+	std::shared_ptr<T> MakeCopy(T&& node)
+	{
+		if (!m_arenaScope)
+			m_arenaScope.emplace(m_spArena = ASTArena::Create(SHARE_ARENA_FIRST_BLOCK_SIZE));
+
+		return MakeNode<T>(std::move(node));
+	}
+
+	// 원래 AST의 함수 정의로 새 AST의 함수 정의를 찾는다.
+	FunctionDefinitionCPtr FindFunction(const FunctionDefinitionCPtr& spFunctionDefinition) const
+	{
+		const auto iter = m_functionMap.find(spFunctionDefinition.get());
+		return iter != m_functionMap.end() ? iter->second : spFunctionDefinition;
+	}
+
+private:
+	template <typename T>
+	BasePtr shareNode(const T& node)
+	{
+		++m_stats.nodeCount;
+
+		// 노드를 복사하고 자식을 공유 노드로 바꾼다.
+		T copy(node);
+		bool bShareable = true;
+		if constexpr (std::is_same_v<T, FunctionDefinition>)
+		{
+			// 파싱하지 않은 지연 함수는 본문을 비교할 수 없다.
+			if (!node.IsMaterialized())
+			{
+				bShareable = false;
+			}
+			else
+			{
+				copy.block = node.GetParsedBlock();
+				copy.lazyBody = nullptr;
+			}
+		}
+
+		for (BasePtr& spChild : getChildren(copy))
+			spChild = Share(spChild);
+
+		const size_t hash = bShareable ? hashNode(copy) : 0;
+		BasePtr spShared = bShareable ? find(hash, copy) : nullptr;
+		if (spShared)
+		{
+			++m_stats.sharedNodeCount;
+		}
+		else if (bShareable)
+		{
+			spShared = MakeSharedCopy(std::move(copy));
+			m_table.m_nodeMap.emplace(hash, spShared);
+		}
+		else
+		{
+			spShared = MakeCopy(std::move(copy));
+		}
+
+		if constexpr (std::is_same_v<T, FunctionDefinition>)
+			m_functionMap.emplace(&node, static_pointer_cast<const FunctionDefinition>(spShared));
+
+		return spShared;
+	}
+
+	// 테이블에서 값과 자식 노드가 같은 노드를 찾는다.
+	template <typename T>
+	BasePtr find(const size_t hash, const T& node) const
+	{
+		const auto [begin, end] = m_table.m_nodeMap.equal_range(hash);
+		for (auto iter = begin; iter != end; ++iter)
+		{
+			BasePtr spShared = iter->second.lock();
+			if (!spShared || T::NodeType != spShared->GetType())
+				continue;
+
+			const T& shared = static_cast<const T&>(*spShared);
+			if (isSameValue(shared, node) && std::ranges::equal(getChildren(shared), getChildren(node), [](const BasePtr& lhs, const BasePtr& rhs) { return lhs == rhs; }))
+				return spShared;
+		}
+
+		return nullptr;
+	}
+
+private:
+	ASTShareTable& m_table;
+	ASTShareStats& m_stats;
+
+	ASTArenaPtr m_spArena;
+	std::optional<ASTArena::Scope> m_arenaScope;
+
+	// Key=원래 AST의 함수 정의, Value=새 AST의 함수 정의
+	std::unordered_map<const FunctionDefinition*, FunctionDefinitionCPtr> m_functionMap;
+};
+
+
+ASTShareTable::ASTShareTable()
+	: m_purgeSize(MIN_PURGE_SIZE)
+{
+}
+
+// AST를 공유 노드로 다시 만든다.
+// 테이블에 새로 넣는 노드는 노드마다 힙에 할당하므로, 스크립트를 해제하면 다른 스크립트가 공유하지 않는 노드만 해제된다.
+// 공유하지 않는 노드(파싱하지 않은 지연 함수)만 스크립트의 아레나에 할당하고, 그런 노드가 없으면 아레나를 만들지 않는다. 루트 노드는 힙에 할당한다.
+ASTPtr ASTShareTable::Share(const AST& ast, std::vector<FunctionDefinitionCPtr>& functions, ASTShareStats* pStats /*= nullptr*/)
+{
+	ASTShareStats stats;
+	stats.sourceArenaBytes = ast.arena ? ast.arena->GetReservedBytes() : 0;
+
+	// 호출한 스레드의 아레나에 할당하지 않는다.
+	ASTArena::Scope arenaScope(nullptr);
+
+	ASTPtr spAST;
+	{
+		std::lock_guard<std::mutex> lockGuard(m_lock);
+
+		// 만료된 항목을 지운다.
+		if (m_nodeMap.size() >= m_purgeSize)
+		{
+			std::erase_if(m_nodeMap, [](const auto& entry) { return entry.second.expired(); });
+			m_purgeSize = (std::max)(m_nodeMap.size() * 2, MIN_PURGE_SIZE);
+		}
+
+		Builder builder(*this, stats);
+		AST copy(ast);
+		copy.block = builder.Share(ast.block);
+		copy.arena = builder.GetArena();
+		++stats.nodeCount;
+		spAST = MakeNode<AST>(std::move(copy));
+
+		for (FunctionDefinitionCPtr& spFunctionDefinition : functions)
+			spFunctionDefinition = builder.FindFunction(spFunctionDefinition);
+
+		stats.arenaBytes = builder.GetArena() ? builder.GetArena()->GetReservedBytes() : 0;
+	}
+
+	if (pStats)
+		*pStats = stats;
+
+	return spAST;
+}
+
+// 테이블의 항목 수
+size_t ASTShareTable::GetEntryCount() const
+{
+	std::lock_guard<std::mutex> lockGuard(m_lock);
+	return m_nodeMap.size();
+}
+
+// 테이블을 비운다.
+void ASTShareTable::Clear()
+{
+	std::lock_guard<std::mutex> lockGuard(m_lock);
+	m_nodeMap.clear();
+	m_purgeSize = MIN_PURGE_SIZE;
+}
+
+}
@@ -0,0 +1,71 @@
+﻿#pragma once
+
+#include "ast.h"
+
+/*
+AST 노드 공유 (hash-consing)
+템플릿으로 만든 스크립트에는 같은 식, 리터럴, 이름, 함수가 스크립트마다 반복된다.
+ASTShareTable은 구조가 같은 하위 트리를 모든 스크립트가 하나의 노드로 공유하도록 AST를 다시 만든다.
+로드한 AST는 변경하지 않으므로(ASTCPtr) 노드를 공유해도 실행 결과는 같다.
+
+AST를 후위 순서로 다시 만든다. 노드마다 자식을 먼저 공유 노드로 바꾼 다음, 노드의 값과 자식 노드의 주소가 같은 노드가 테이블에 있으면 그 노드를 사용한다.
+자식이 이미 공유 노드이므로 구조 비교는 자식의 주소 비교로 끝난다.
+테이블에 없는 노드만 새로 복사한다. 원래 AST의 아레나는 더 이상 참조하는 노드가 없으므로 한 번에 해제된다.
+테이블에 넣는 노드는 노드마다 힙에 할당한다. 스크립트별 아레나에 할당하면 다른 스크립트가 노드 하나만 공유해도 아레나 전체가 남기 때문이다.
+
+테이블은 노드를 weak_ptr로 가지고 있으므로 스크립트를 해제하면 그 스크립트만 사용하던 노드는 해제된다.
+다만 만료된 항목은 테이블에서 지울 때까지 노드의 메모리를 붙잡고 있으므로, 테이블 크기가 마지막으로 지웠을 때의 두 배가 되면 지운다.
+
+AST 노드(루트)와 파싱하지 않은 지연 함수는 스크립트마다 다르므로 공유하지 않고 복사한다. 지연 함수는 스크립트의 아레나에, 루트 노드는 힙에 할당한다.
+지연 함수의 이름과 파라미터는 공유한다.
+이미 파싱한 지연 함수는 바로 파싱한 함수와 같은 노드로 만든다.
+*/
+
+namespace dsl
+{
+	// AST 하나를 공유 노드로 다시 만든 결과
+	struct ASTShareStats
+	{
+		size_t nodeCount = 0;			// 원래 AST의 노드 수
+		size_t sharedNodeCount = 0;		// 테이블의 공유 노드로 바꾼 노드 수
+		size_t sourceArenaBytes = 0;	// 원래 AST의 아레나 크기 (bytes). 아레나를 사용하지 않았다면 0
+		size_t arenaBytes = 0;			// 공유하지 않는 노드의 아레나 크기 (bytes)
+		size_t heapBytes = 0;			// 테이블에 새로 넣은 노드의 힙 할당 크기 (bytes, shared_ptr 제어 블록 포함)
+
+		// 줄어든 노드 메모리 (bytes). 원래 아레나 크기에서 새로 할당한 아레나와 힙 크기를 뺀다.
+		ptrdiff_t GetReclaimedBytes() const { return static_cast<ptrdiff_t>(sourceArenaBytes) - static_cast<ptrdiff_t>(arenaBytes + heapBytes); }
+	};
+
+
+	// 구조가 같은 노드의 테이블. 여러 스레드에서 동시에 Share를 호출해도 된다. (테이블 lock을 잡고 AST 하나를 다시 만든다.)
+	class ASTShareTable
+	{
+	public:
+		ASTShareTable();
+
+		ASTShareTable(const ASTShareTable&) = delete;
+		ASTShareTable& operator=(const ASTShareTable&) = delete;
+
+	public:
+		// AST를 공유 노드로 다시 만든다. 원래 AST는 바꾸지 않는다.
+		// @functions	: 원래 AST의 함수 정의 목록. 새 AST의 함수 정의로 바꾼다.
+		// @pStats		: 노드 수, 아레나 크기 (nullptr 가능)
+		ASTPtr Share(const AST& ast, std::vector<FunctionDefinitionCPtr>& functions, ASTShareStats* pStats = nullptr);
+
+		// 테이블의 항목 수 (만료된 항목 포함)
+		size_t GetEntryCount() const;
+
+		// 테이블을 비운다. 이미 공유한 노드는 그대로 남는다.
+		void Clear();
+
+	private:
+		class Builder;
+
+		mutable std::mutex m_lock;
+
+		// Key=노드의 값과 자식 노드 주소의 해시, Value=공유 노드
+		std::unordered_multimap<size_t, std::weak_ptr<Base>> m_nodeMap;
+
+		size_t m_purgeSize;		// 만료된 항목을 지울 테이블 크기
+	};
+}
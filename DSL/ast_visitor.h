@@ -0,0 +1,185 @@
+﻿#pragma once
+
+#include "ast.h"
+
+/*
+AST 방문자.
+Base::Iterate는 자식마다 std::function을 호출하므로 콜백을 인라인할 수 없고, 순회를 멈추거나 하위 트리를 건너뛸 수 없다.
+WalkAST는 노드의 타입 태그로 분기해서(VisitNode) 실제 타입의 참조로 visitor를 호출하는 템플릿이므로 콜백이 인라인된다.
+
+visitor 형식
+  EVisitResult Enter(const T& node, const Ptr& spNode)	: 노드에 들어갈 때 (전위). 반환값으로 자식을 방문할지, 순회를 멈출지 정한다.
+  void Leave(const T& node, const Ptr& spNode)			: 자식을 모두 방문한 다음 (후위). 없어도 된다.
+  T는 노드의 실제 타입이고, spNode는 노드를 가진 Base의 shared_ptr(BasePtr 또는 BaseCPtr)이다. spNode가 필요 없으면 Enter(const T& node) 처럼 생략해도 된다.
+  Enter가 void를 반환하면 Continue로 처리한다. Enter 대신 함수 객체(generic lambda 등)를 전달하면 Enter로 사용한다.
+
+자식의 순서는 Iterate와 같다. Iterate와 달리 nullptr인 자식은 방문하지 않고, 루트 노드도 방문한다.
+순서는 항상 전위 순서이다. (Iterate는 Assignment 처럼 자식을 모두 먼저 방문한 다음 손자 노드로 내려가는 노드가 있다.)
+지연 파싱하는 함수 본문은 이미 파싱한 경우에만 방문한다.
+*/
+
+namespace dsl
+{
+	// Enter의 반환값
+	enum class EVisitResult
+	{
+		Continue,		// 자식을 방문한다.
+		SkipChildren,	// 자식을 방문하지 않는다. Leave는 호출한다.
+		Stop,			// 순회를 멈춘다. 이 노드와 조상 노드의 Leave는 호출하지 않는다.
+	};
+
+
+	// 노드의 자식을 Iterate와 같은 순서로 방문한다. nullptr인 자식은 건너뛴다.
+	// 실제 타입의 참조로 호출하면 분기 없이 자식을 읽고, Base로 호출하면 타입 태그로 한 번 분기한다.
+	// @callback	: bool(const BasePtr& spChild). false를 반환하면 멈춘다.
+	// @return		: 모든 자식을 방문했으면 true, callback이 멈췄으면 false
+	template <typename T, typename Callback>
+	bool ForEachChild(const T& node, Callback&& callback)
+	{
+		if constexpr (std::is_same_v<T, Base>)
+		{
+			return VisitNode(node, [&callback](const auto& typedNode)
+				{
+					if constexpr (std::is_same_v<std::decay_t<decltype(typedNode)>, Base>)
+						return true;
+					else
+						return ForEachChild(typedNode, callback);
+				});
+		}
+		else
+		{
+			auto visitChild = [&callback](const BasePtr& spChild) { return !spChild || callback(spChild); };
+			auto visitChildren = [&visitChild](const std::vector<BasePtr>& children)
+			{
+				for (const BasePtr& spChild : children)
+				{
+					if (!visitChild(spChild))
+						return false;
+				}
+				return true;
+			};
+
+			if constexpr (std::is_same_v<T, NameList>)
+				return visitChildren(node.names);
+			else if constexpr (std::is_same_v<T, AST>)
+				return visitChild(node.block);
+			else if constexpr (std::is_same_v<T, Block>)
+				return visitChildren(node.statements);
+			else if constexpr (std::is_same_v<T, Assignment>)
+				return visitChild(node.name) && visitChild(node.expression);
+			else if constexpr (std::is_same_v<T, Expression>)
+				return visitChild(node.expression);
+			else if constexpr (std::is_same_v<T, ExpressionList>)
+				return visitChildren(node.expressions);
+			else if constexpr (std::is_same_v<T, PrimaryExpression>)
+				return visitChild(node.primaryExpression);
+			else if constexpr (std::is_same_v<T, BinaryExpression>)
+				return visitChild(node.primaryExpression1) && visitChild(node.primaryExpression2);
+			else if constexpr (std::is_same_v<T, UnaryExpression>)
+				return visitChild(node.primaryExpression);
+			else if constexpr (std::is_same_v<T, FunctionDefinition>)
+				return visitChild(node.name) && visitChild(node.functionParameter) && visitChild(node.GetParsedBlock());
+			else if constexpr (std::is_same_v<T, FunctionParameter>)
+				return visitChild(node.nameList);
+			else if constexpr (std::is_same_v<T, FunctionArgument>)
+				return visitChild(node.expressionList);
+			else if constexpr (std::is_same_v<T, FunctionCall>)
+				return visitChild(node.name) && visitChild(node.functionArgument);
+			else if constexpr (std::is_same_v<T, Statement>)
+				return visitChild(node.statement);
+			else if constexpr (std::is_same_v<T, Return>)
+				return visitChildren(node.expressions);
+			else if constexpr (std::is_same_v<T, While>)
+				return visitChild(node.expression) && visitChild(node.statDo);
+			else if constexpr (std::is_same_v<T, If>)
+				return visitChild(node.expression) && visitChild(node.block) && visitChild(node.statIf);
+			else if constexpr (std::is_same_v<T, For>)
+				return visitChild(node.name) && visitChild(node.expression1) && visitChild(node.expression2) && visitChild(node.expression3);
+			else
+				return true;	// Name, Numeral, Boolean, LiteralString, Break
+		}
+	}
+
+
+	namespace detail
+	{
+		template <typename Visitor, typename T, typename Ptr>
+		EVisitResult enterNode(Visitor& visitor, const T& node, const Ptr& spNode)
+		{
+			auto call = [&]()
+			{
+				if constexpr (requires { visitor.Enter(node, spNode); })
+					return visitor.Enter(node, spNode);
+				else if constexpr (requires { visitor.Enter(node); })
+					return visitor.Enter(node);
+				else if constexpr (requires { visitor(node, spNode); })
+					return visitor(node, spNode);
+				else
+					return visitor(node);
+			};
+
+			if constexpr (std::is_void_v<decltype(call())>)
+			{
+				call();
+				return EVisitResult::Continue;
+			}
+			else
+			{
+				return call();
+			}
+		}
+
+		template <typename Visitor, typename T, typename Ptr>
+		void leaveNode(Visitor& visitor, const T& node, const Ptr& spNode)
+		{
+			if constexpr (requires { visitor.Leave(node, spNode); })
+				visitor.Leave(node, spNode);
+			else if constexpr (requires { visitor.Leave(node); })
+				visitor.Leave(node);
+		}
+
+		template <typename Visitor, typename Ptr>
+		bool walkNode(const Base& node, const Ptr& spNode, Visitor& visitor)
+		{
+			return VisitNode(node, [&visitor, &spNode](const auto& typedNode)
+				{
+					const EVisitResult eResult = enterNode(visitor, typedNode, spNode);
+					if (EVisitResult::Stop == eResult)
+						return false;
+
+					if (EVisitResult::Continue == eResult)
+					{
+						const bool bCompleted = ForEachChild(typedNode, [&visitor](const BasePtr& spChild) { return walkNode(*spChild, spChild, visitor); });
+						if (!bCompleted)
+							return false;
+					}
+
+					leaveNode(visitor, typedNode, spNode);
+					return true;
+				});
+		}
+	}
+
+
+	// 노드와 하위 노드를 전위 순회한다.
+	// @return	: 모든 노드를 방문했으면 true, visitor가 순회를 멈췄으면 false
+	template <typename T, typename Visitor>
+	bool WalkAST(const std::shared_ptr<T>& spRoot, Visitor&& visitor)
+	{
+		if (!spRoot)
+			return true;
+
+		// 루트 노드도 자식 노드처럼 Base의 shared_ptr로 전달한다. visitor가 spNode를 실제 타입으로 변환할 수 있어야 하기 때문이다.
+		using RootPtr = std::conditional_t<std::is_const_v<T>, BaseCPtr, BasePtr>;
+		const RootPtr spBase = spRoot;
+		return detail::walkNode(*spBase, spBase, visitor);
+	}
+
+	// 노드를 가진 shared_ptr가 없을 때. 루트 노드의 spNode는 nullptr이다.
+	template <typename Visitor>
+	bool WalkAST(const Base& root, Visitor&& visitor)
+	{
+		static const BasePtr spEmpty;
+		return detail::walkNode(root, spEmpty, visitor);
+	}
+}
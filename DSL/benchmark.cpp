@@ -0,0 +1,2286 @@
+﻿#include "pch.h"
+
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Psapi.h>
+#endif
+
+#include <boost/spirit/include/qi_numeric.hpp>
+#include <boost/spirit/include/qi_parse.hpp>
+
+#include "ast.h"
+#include "lexer.h"
+#include "scan.h"
+#include "numeral.h"
+#include "token_parser.h"
+#include "parser.h"
+#include "script_file.h"
+#include "stream_parser.h"
+#include "incremental_parser.h"
+#include "EnvironmentDefine.h"
+#include "Environment.h"
+#include "DSLManager.h"
+
+#include "benchmark.h"
+#include "parse_bench.h"
+#include "flat_ast.h"
+#include "ast_visitor.h"
+#include "ast_cache.h"
+#include "ast_share.h"
+#include "ast_normalize.h"
+
+namespace dsl
+{
+
+using BenchClock = std::chrono::steady_clock;
+
+// 시작 시각부터 현재까지 경과시간(us)
+static double elapsedUs(const BenchClock::time_point start)
+{
+	return std::chrono::duration<double, std::micro>(BenchClock::now() - start).count();
+}
+
+// 측정하는 동안 std::cerr 출력을 막는다. (DSL_PARSER_TRACE 빌드에서는 BOOST_SPIRIT_DEBUG 트레이스가 std::cerr로 출력됨)
+struct BenchTraceMute
+{
+	BenchTraceMute() { std::cerr.setstate(std::ios::badbit); }
+	~BenchTraceMute() { std::cerr.clear(); }
+};
+
+// AST 출력 결과를 문자열로 받는다. 두 AST가 같은지 비교할 때 사용한다.
+static std::wstring printAST(const BaseCPtr& spNode)
+{
+	std::wostringstream oss;
+	std::wstreambuf* pOriginal = std::wcout.rdbuf(oss.rdbuf());
+	if (spNode)
+		spNode->Print();
+	std::wcout.rdbuf(pOriginal);
+	return oss.str();
+}
+
+// 두 AST의 구조와 값이 같은지 평탄화한 배열을 비교해서 확인한다.
+// printAST는 깊이만큼 들여쓰기를 하므로 깊게 중첩된 식에서는 출력이 깊이의 제곱으로 커진다.
+static bool isSameAST(const BaseCPtr& spLeft, const BaseCPtr& spRight)
+{
+	const FlatASTPtr spLeftFlat = FlattenAST(spLeft);
+	const FlatASTPtr spRightFlat = FlattenAST(spRight);
+	if (!spLeftFlat || !spRightFlat)
+		return spLeftFlat == spRightFlat;
+
+	const FlatAST& left = *spLeftFlat;
+	const FlatAST& right = *spRightFlat;
+	if (left.GetNodeCount() != right.GetNodeCount())
+		return false;
+
+	const FlatNodeIndex count = static_cast<FlatNodeIndex>(left.GetNodeCount());
+	for (FlatNodeIndex index = 0; index < count; ++index)
+	{
+		const EASTType eKind = left.GetKind(index);
+		if (eKind != right.GetKind(index) || left.GetOperator(index) != right.GetOperator(index)
+			|| left.GetFirstChild(index) != right.GetFirstChild(index) || left.GetNextSibling(index) != right.GetNextSibling(index))
+			return false;
+
+		switch (eKind)
+		{
+		case EASTType::Name:
+			if (left.GetSymbol(index) != right.GetSymbol(index))
+				return false;
+			break;
+		case EASTType::Numeral:
+		{
+			const NumeralValue& leftValue = left.GetNumeral(index);
+			const NumeralValue& rightValue = right.GetNumeral(index);
+			if (leftValue.isInteger != rightValue.isInteger || leftValue.intValue != rightValue.intValue || leftValue.floatValue != rightValue.floatValue)
+				return false;
+			break;
+		}
+		case EASTType::Boolean:
+			if (left.GetBoolean(index) != right.GetBoolean(index))
+				return false;
+			break;
+		case EASTType::LiteralString:
+			if (*left.GetString(index) != *right.GetString(index))
+				return false;
+			break;
+		default:
+			break;
+		}
+	}
+	return true;
+}
+
+int RunBenchmark(const std::vector<std::wstring>& args)
+{
+	if (args.empty())
+	{
+		std::wcout << L"usage: bench <parse|setup|throughput|scan|expr|numeral|load|loadall|stream|reload|lazy|profile|symbol|constant|register|arena|flat|visit|walk|cache|share|normalize|operator> [args...]" << std::endl;
+		return 1;
+	}
+
+	const std::wstring& name = args[0];
+
+	// 파서 처리량 벤치마크 모음. 결과는 JSON으로 출력한다. (parse_bench.h)
+	if (L"parse" == name)
+		return RunParseBenchSuite(std::vector<std::wstring>(args.begin() + 1, args.end()));
+
+	auto argInt = [&args](const size_t index, const int defaultValue)
+	{
+		return index < args.size() ? std::stoi(args[index]) : defaultValue;
+	};
+
+	if (L"setup" == name)
+	{
+		BenchmarkParserSetup(argInt(1, 1000));
+		return 0;
+	}
+
+	if (L"throughput" == name)
+	{
+		BenchmarkParseThroughput(argInt(1, 1024));
+		return 0;
+	}
+
+	if (L"profile" == name)
+	{
+		BenchmarkProfile(argInt(1, 1024));
+		return 0;
+	}
+
+	if (L"scan" == name)
+	{
+		BenchmarkScan(argInt(1, 8));
+		return 0;
+	}
+
+	if (L"expr" == name)
+	{
+		BenchmarkExpression(argInt(1, 200));
+		return 0;
+	}
+
+	if (L"numeral" == name)
+	{
+		BenchmarkNumeral(argInt(1, 1024));
+		return 0;
+	}
+
+	if (L"load" == name)
+	{
+		BenchmarkScriptLoad(1 < args.size() ? args[1] : L"mmap", argInt(2, 10000));
+		return 0;
+	}
+
+	if (L"loadall" == name)
+	{
+		BenchmarkLoadScripts(argInt(1, 8000), argInt(2, static_cast<int>((std::max)(std::thread::hardware_concurrency(), 1u))));
+		return 0;
+	}
+
+	if (L"stream" == name)
+	{
+		BenchmarkStreamParse(1 < args.size() ? args[1] : L"stream", argInt(2, 64));
+		return 0;
+	}
+
+	if (L"reload" == name)
+	{
+		BenchmarkReload(argInt(1, 160));
+		return 0;
+	}
+
+	if (L"lazy" == name)
+	{
+		BenchmarkLazyFunction(argInt(1, 1600), argInt(2, 8));
+		return 0;
+	}
+
+	if (L"symbol" == name)
+	{
+		BenchmarkSymbol(argInt(1, 1600), argInt(2, 100));
+		return 0;
+	}
+
+	if (L"register" == name)
+	{
+		BenchmarkRegisterFunction(argInt(1, 1600), argInt(2, 20));
+		return 0;
+	}
+
+	if (L"constant" == name)
+	{
+		BenchmarkConstantPool(argInt(1, 1024), argInt(2, 64));
+		return 0;
+	}
+
+	if (L"arena" == name)
+	{
+		BenchmarkNodeArena(argInt(1, 1024), argInt(2, 5));
+		return 0;
+	}
+
+	if (L"flat" == name)
+	{
+		BenchmarkFlatAST(argInt(1, 1024), argInt(2, 10));
+		return 0;
+	}
+
+	if (L"visit" == name)
+	{
+		BenchmarkNodeDispatch(argInt(1, 1024), argInt(2, 20));
+		return 0;
+	}
+
+	if (L"walk" == name)
+	{
+		BenchmarkWalkAST(argInt(1, 1024), argInt(2, 20));
+		return 0;
+	}
+
+	if (L"cache" == name)
+	{
+		BenchmarkASTCache(argInt(1, 2000), argInt(2, 1), 0 != argInt(3, 0));
+		return 0;
+	}
+
+	if (L"share" == name)
+	{
+		BenchmarkShareAST(argInt(1, 2000), argInt(2, 1), 0 != argInt(3, 0));
+		return 0;
+	}
+
+	if (L"normalize" == name)
+	{
+		BenchmarkNormalizeAST(argInt(1, 2000), argInt(2, 1));
+		return 0;
+	}
+
+	if (L"operator" == name)
+	{
+		BenchmarkOperator(argInt(1, 5000), argInt(2, 20));
+		return 0;
+	}
+
+	std::wcout << std::format(L"unknown benchmark. name={}", name) << std::endl;
+	return 1;
+}
+
+// 파서 준비시간 벤치마크
+// 작은 스크립트를 nIteration번 파싱하면서 grammar 생성에 걸린 시간과 전체 파싱시간을 측정한다.
+void BenchmarkParserSetup(const int nIteration)
+{
+	const std::wstring strScript = L"val = 1\nx = val + 2 * 3\n";
+
+	BenchTraceMute mute;
+
+	// 기존 방식: 파싱할 때마다 grammar와 skipper를 새로 생성한다.
+	double setupUsBefore = 0.0;
+	double totalUsBefore = 0.0;
+	for (int i = 0; i < nIteration; ++i)
+	{
+		const BenchClock::time_point start = BenchClock::now();
+		ParserContext context;
+		setupUsBefore += elapsedUs(start);
+
+		context.Parse(strScript);
+		totalUsBefore += elapsedUs(start);
+	}
+
+	// 개선 방식: 스레드별 컨텍스트를 재사용한다. 최초 1회만 grammar를 생성한다.
+	double setupUsAfter = 0.0;
+	double totalUsAfter = 0.0;
+	for (int i = 0; i < nIteration; ++i)
+	{
+		const BenchClock::time_point start = BenchClock::now();
+		ParserContext& context = ParserContext::GetThreadInstance();
+		setupUsAfter += elapsedUs(start);
+
+		context.Parse(strScript);
+		totalUsAfter += elapsedUs(start);
+	}
+
+	std::wcout << std::format(L"[setup] iterations={}", nIteration) << std::endl;
+	std::wcout << std::format(L"  before: setup/parse={:.3f}us, total/parse={:.3f}us", setupUsBefore / nIteration, totalUsBefore / nIteration) << std::endl;
+	std::wcout << std::format(L"  after : setup/parse={:.3f}us, total/parse={:.3f}us", setupUsAfter / nIteration, totalUsAfter / nIteration) << std::endl;
+}
+
+// 파싱 처리량 벤치마크
+// 약 scriptKB 크기의 스크립트를 각 파서로 파싱하고 처리량(MB/s)을 출력한다.
+void BenchmarkParseThroughput(const size_t scriptKB)
+{
+	const std::wstring strScript = MakeBenchmarkScript(scriptKB * 1024);
+	const double scriptMB = static_cast<double>(strScript.size()) / (1024.0 * 1024.0);
+
+	ParserContext& context = ParserContext::GetThreadInstance();
+
+	auto measure = [&](const EParserBackend eBackend, const wchar_t* backendName)
+	{
+		BenchTraceMute mute;
+
+		// 첫 파싱은 아레나 블록과 페이지를 처음 건드리는 비용이 섞이므로 여러 번 파싱하고 가장 짧은 시간을 사용한다.
+		ASTPtr spAST;
+		double seconds = (std::numeric_limits<double>::max)();
+		for (int i = 0; i < 5; ++i)
+		{
+			spAST = nullptr;
+			const BenchClock::time_point start = BenchClock::now();
+			spAST = context.Parse(strScript, eBackend);
+			seconds = (std::min)(seconds, elapsedUs(start) / 1000000.0);
+		}
+
+		const ParseStats& stats = context.GetLastStats();
+		std::wcout << std::format(L"  {:<7}: {}, {:.3f}s, {:.2f} MB/s, scan ratio={:.3f}", backendName, spAST ? L"ok" : L"fail", seconds, scriptMB / seconds, stats.GetScanRatio()) << std::endl;
+		return spAST;
+	};
+
+	std::wcout << std::format(L"[throughput] script={:.2f}MB", scriptMB) << std::endl;
+	const ASTPtr spQiAST = measure(EParserBackend::Spirit, L"spirit");
+	const ASTPtr spX3AST = measure(EParserBackend::SpiritX3, L"x3");
+	measure(EParserBackend::Token, L"token");
+
+	// X3 grammar는 Qi grammar와 같은 AST를 만들어야 한다. 실패하는 스크립트는 둘 다 실패해야 한다.
+	const std::wstring edgeCases[] =
+	{
+		L"endx = 1\niffy = true_value or false\n",
+		L"x = -(a + b) * not c % 0x1F - .5e-3\n",
+		L"a += 1\nb = f(g(1, 2), \"문자열 -- 주석 아님\") -- 주석\n",
+		L"function f() x = 1 end\nfunction g(a, b) if a <= b then return1 = a end end\n",
+		L"1 = 2\n",
+		L"(a) = 3\n",
+		L"a == b\n",
+		L"x = +5\ny = -5 - +.5e1 * f(+0x1F)\n",
+		L"x = + 5\n",
+		L"function (a) end\n",
+		L"s = \"unterminated\n",
+	};
+	size_t nIdentical = 0;
+	size_t nParsed = 0;
+	{
+		BenchTraceMute mute;
+		std::wostringstream oss;
+		std::wstreambuf* pOriginal = std::wcout.rdbuf(oss.rdbuf());
+		for (const std::wstring& strEdge : edgeCases)
+		{
+			const ASTPtr spQiEdge = context.Parse(strEdge, EParserBackend::Spirit);
+			if (spQiEdge)
+				++nParsed;
+			if (printAST(spQiEdge) == printAST(context.Parse(strEdge, EParserBackend::SpiritX3)))
+				++nIdentical;
+		}
+		std::wcout.rdbuf(pOriginal);
+	}
+	std::wcout << std::format(L"  x3 identical to spirit: script={}, edge cases={}/{} (parsed {})", printAST(spQiAST) == printAST(spX3AST), nIdentical, std::size(edgeCases), nParsed) << std::endl;
+}
+
+// rule 프로파일 벤치마크
+// 프로파일 모드를 끄고 켠 상태에서 같은 스크립트를 파싱한다. 프로파일 결과는 누적 시간 순으로 출력한다.
+void BenchmarkProfile(const size_t scriptKB)
+{
+	const std::wstring strScript = MakeBenchmarkScript(scriptKB * 1024);
+	const double scriptMB = static_cast<double>(strScript.size()) / (1024.0 * 1024.0);
+
+	ParserContext& context = ParserContext::GetThreadInstance();
+	BenchTraceMute mute;
+
+	auto measure = [&](const bool bProfile)
+	{
+		context.SetProfile(bProfile);
+		const BenchClock::time_point start = BenchClock::now();
+		const ASTPtr spAST = context.Parse(strScript, EParserBackend::Spirit);
+		const double seconds = elapsedUs(start) / 1000000.0;
+		context.SetProfile(false);
+
+		std::wcout << std::format(L"  profile {:<3}: {}, {:.3f}s, {:.2f} MB/s", bProfile ? L"on" : L"off", spAST ? L"ok" : L"fail", seconds, scriptMB / seconds) << std::endl;
+	};
+
+	std::wcout << std::format(L"[profile] script={:.2f}MB", scriptMB) << std::endl;
+	measure(false);
+	measure(true);
+
+	std::vector<RuleStats> ruleStats = context.GetLastStats().ruleStats;
+	std::sort(ruleStats.begin(), ruleStats.end(), [](const RuleStats& a, const RuleStats& b) { return a.elapsedUs > b.elapsedUs; });
+
+	std::wcout << std::format(L"  {:<28}{:>12}{:>12}{:>12}{:>12}", L"rule", L"attempts", L"successes", L"backtracks", L"time(ms)") << std::endl;
+	for (const RuleStats& stats : ruleStats)
+		std::wcout << std::format(L"  {:<28}{:>12}{:>12}{:>12}{:>12.3f}", Utf8ToWide(stats.name), stats.attemptCount, stats.successCount, stats.backtrackCount, stats.elapsedUs / 1000.0) << std::endl;
+}
+
+// 스캔 벤치마크
+// 각 입력을 약 scriptMB 크기로 만들고, CPU가 지원하는 스캔 명령어 집합마다 Tokenize 처리량을 측정한다.
+void BenchmarkScan(const size_t scriptMB)
+{
+	const size_t targetLength = scriptMB * 1024 * 1024;
+
+	auto repeat = [targetLength](const std::wstring& strChunk)
+	{
+		std::wstring strScript;
+		strScript.reserve(targetLength + strChunk.size());
+		while (strScript.size() < targetLength)
+			strScript += strChunk;
+		return strScript;
+	};
+
+	const std::wstring strText(120, L'x');
+	const std::pair<const wchar_t*, std::wstring> inputs[] =
+	{
+		{ L"comment", repeat(L"-- " + strText + L" comment line\nv = 1\n") },
+		{ L"string", repeat(L"s = \"" + strText + strText + L"\"\n") },
+		{ L"space", repeat(L"v = 1" + std::wstring(64, L' ') + L"\n\t\t\t\t\t\t\t\t") },
+		{ L"name", repeat(L"very_long_variable_name_" + strText + L" = another_long_name_for_a_value_0123456789\n") },
+		{ L"mixed", MakeBenchmarkScript(targetLength) },
+	};
+
+	const EScanLevel eOriginalLevel = GetScanLevel();
+	const EScanLevel eSupportedLevel = GetSupportedScanLevel();
+
+	TokenList tokens;
+	size_t errorOffset = 0;
+
+	std::wcout << std::format(L"[scan] input={}MB, supported={}", scriptMB, GetScanLevelName(eSupportedLevel)) << std::endl;
+	for (const auto& [inputName, strScript] : inputs)
+	{
+		const double inputMB = static_cast<double>(strScript.size()) / (1024.0 * 1024.0);
+
+		for (EScanLevel eLevel : { EScanLevel::Scalar, EScanLevel::SSE42, EScanLevel::AVX2 })
+		{
+			if (eSupportedLevel < eLevel)
+				break;
+
+			SetScanLevel(eLevel);
+
+			const BenchClock::time_point start = BenchClock::now();
+			const bool bSuccess = Tokenize(strScript, tokens, errorOffset);
+			const double seconds = elapsedUs(start) / 1000000.0;
+
+			std::wcout << std::format(L"  {:<8} {:<7}: {}, tokens={}, {:.2f} MB/s", inputName, GetScanLevelName(eLevel), bSuccess ? L"ok" : L"fail", tokens.size(), inputMB / seconds) << std::endl;
+		}
+	}
+
+	SetScanLevel(eOriginalLevel);
+}
+
+// 표현식 파싱 벤치마크
+// 같은 토큰 배열을 두 방식으로 파싱하므로 렉서 시간은 포함되지 않는다. 두 방식이 만든 AST의 출력 결과도 비교한다.
+void BenchmarkExpression(const int nTerm)
+{
+	static const wchar_t* const operators[] = { L"+", L"-", L"*", L"/", L"%", L"<", L">=", L"==", L"!=", L"and", L"or" };
+	constexpr size_t nOperator = sizeof(operators) / sizeof(operators[0]);
+	constexpr int nStatement = 200;
+
+	// 평평한 식: 한 줄에 nTerm개의 항이 여러 연산자로 연결되어 있다.
+	std::wstring strFlat;
+	for (int line = 0; line < nStatement; ++line)
+	{
+		strFlat += std::format(L"v{} = a", line);
+		for (int term = 1; term < nTerm; ++term)
+			strFlat += std::format(L" {} {}", operators[(line + term) % nOperator], (0 == term % 3) ? std::format(L"f({})", term) : std::format(L"{}", term));
+		strFlat += L"\n";
+	}
+
+	// 중첩된 식: 괄호가 nTerm 단계로 중첩되어 있다.
+	std::wstring strNested;
+	for (int line = 0; line < nStatement; ++line)
+	{
+		strNested += std::format(L"v{} = ", line);
+		for (int depth = 0; depth < nTerm; ++depth)
+			strNested += L"(";
+		strNested += L"x";
+		for (int depth = 0; depth < nTerm; ++depth)
+			strNested += std::format(L" {} {})", operators[(line + depth) % nOperator], depth);
+		strNested += L"\n";
+	}
+
+	// 리터럴: 연산자가 없는 식
+	std::wstring strLiteral;
+	for (int line = 0; line < nStatement * nTerm / 4; ++line)
+		strLiteral += std::format(L"v{} = {}\n", line, line);
+
+	const std::pair<const wchar_t*, const std::wstring*> inputs[] =
+	{
+		{ L"flat", &strFlat },
+		{ L"nested", &strNested },
+		{ L"literal", &strLiteral },
+	};
+
+	std::wcout << std::format(L"[expr] terms={}, statements={}", nTerm, nStatement) << std::endl;
+	for (const auto& [inputName, pScript] : inputs)
+	{
+		TokenList tokens;
+		size_t errorOffset = 0;
+		if (!Tokenize(*pScript, tokens, errorOffset))
+		{
+			std::wcout << std::format(L"  {:<7}: tokenize fail. offset={}", inputName, errorOffset) << std::endl;
+			continue;
+		}
+
+		// 여러 번 파싱하고 가장 짧은 시간을 사용한다.
+		auto measure = [&](const EExpressionParser eExpressionParser, ASTPtr& spAST)
+		{
+			double bestUs = (std::numeric_limits<double>::max)();
+			for (int i = 0; i < 5; ++i)
+			{
+				const BenchClock::time_point start = BenchClock::now();
+				spAST = TokenParser(*pScript, tokens, eExpressionParser).ParseAST();
+				bestUs = (std::min)(bestUs, elapsedUs(start));
+			}
+			return bestUs;
+		};
+
+		ASTPtr spCascade;
+		ASTPtr spPrecedence;
+		const double cascadeUs = measure(EExpressionParser::Cascade, spCascade);
+		const double precedenceUs = measure(EExpressionParser::Precedence, spPrecedence);
+		const bool bSame = spCascade && spPrecedence && isSameAST(spCascade, spPrecedence);
+
+		std::wcout << std::format(L"  {:<7}: tokens={}, cascade={:.0f}us, precedence={:.0f}us, speedup={:.2f}x, {}"
+			, inputName, tokens.size(), cascadeUs, precedenceUs, cascadeUs / precedenceUs, bSame ? L"same AST" : L"DIFFERENT AST") << std::endl;
+	}
+}
+
+// 숫자 리터럴 벤치마크
+// 스크립트를 토큰으로 분리한 다음, 숫자 토큰만 각 방식으로 변환해서 시간을 비교한다.
+//   qi      : 기존 ruleNumeral과 같이 qi::double_을 먼저 시도하고 실패하면 qi::long_long (Spirit 백엔드)
+//   stod    : 토큰 문자열을 복사해서 std::stod로 변환 (기존 Token 백엔드)
+//   numeral : ScanNumeral로 정수/실수를 구분해서 한 번에 변환
+void BenchmarkNumeral(const size_t scriptKB)
+{
+	static const wchar_t* const values[] = { L"0", L"7", L"42", L"1024", L"65535", L"123456789", L"9007199254740993", L"3.14", L"0.5", L"2.5e-3", L"1e10", L"0x1F", L"0xFFFF" };
+	constexpr size_t nValue = sizeof(values) / sizeof(values[0]);
+
+	// 숫자가 많은 데이터 스크립트
+	std::wstring strScript;
+	const size_t targetLength = scriptKB * 1024;
+	for (size_t line = 0; strScript.size() < targetLength; ++line)
+	{
+		strScript += std::format(L"row{} = Row({}", line, line);
+		for (size_t column = 0; column < 8; ++column)
+			strScript += std::format(L", {}", values[(line + column) % nValue]);
+		strScript += L")\n";
+	}
+
+	TokenList tokens;
+	size_t errorOffset = 0;
+	if (!Tokenize(strScript, tokens, errorOffset))
+	{
+		std::wcout << std::format(L"[numeral] tokenize fail. offset={}", errorOffset) << std::endl;
+		return;
+	}
+
+	std::vector<std::wstring_view> literals;
+	for (const Token& token : tokens)
+	{
+		if (ETokenType::Number == token.eType)
+			literals.push_back(std::wstring_view(strScript).substr(token.offset, token.length));
+	}
+
+	// 변환 함수는 리터럴 하나를 변환하고, 정수로 변환되었는지 여부를 반환한다.
+	// 여러 번 실행해서 가장 짧은 시간을 출력한다.
+	auto measure = [&literals](const wchar_t* name, const auto& convert)
+	{
+		double bestUs = (std::numeric_limits<double>::max)();
+		size_t nInteger = 0;
+		double checksum = 0.0;
+		for (int i = 0; i < 5; ++i)
+		{
+			nInteger = 0;
+			checksum = 0.0;
+
+			const BenchClock::time_point start = BenchClock::now();
+			for (const std::wstring_view& literal : literals)
+			{
+				if (convert(literal, checksum))
+					++nInteger;
+			}
+			bestUs = (std::min)(bestUs, elapsedUs(start));
+		}
+
+		std::wcout << std::format(L"  {:<7}: {:.0f}us, {:.2f} ns/literal, integers={}, checksum={:.6g}", name, bestUs, bestUs * 1000.0 / literals.size(), nInteger, checksum) << std::endl;
+	};
+
+	std::wcout << std::format(L"[numeral] script={}KB, literals={}", strScript.size() / 1024, literals.size()) << std::endl;
+
+	// 기존 Spirit 백엔드. 모든 숫자가 실수가 된다. 16진수는 "0"까지만 변환된다.
+	measure(L"qi", [](const std::wstring_view& literal, double& checksum)
+	{
+		const wchar_t* first = literal.data();
+		const wchar_t* const last = first + literal.size();
+
+		double floatValue = 0.0;
+		__int64 intValue = 0;
+		if (boost::spirit::qi::parse(first, last, boost::spirit::qi::double_, floatValue))
+		{
+			checksum += floatValue;
+			return false;
+		}
+		if (boost::spirit::qi::parse(first, last, boost::spirit::qi::long_long, intValue))
+		{
+			checksum += static_cast<double>(intValue);
+			return true;
+		}
+		return false;
+	});
+
+	// 기존 Token 백엔드. 모든 숫자가 실수가 된다.
+	measure(L"stod", [](const std::wstring_view& literal, double& checksum)
+	{
+		checksum += std::stod(std::wstring(literal));
+		return false;
+	});
+
+	measure(L"numeral", [](const std::wstring_view& literal, double& checksum)
+	{
+		const wchar_t* first = literal.data();
+		const wchar_t* const last = first + literal.size();
+
+		NumeralValue value;
+		ScanNumeral(first, last, &value);
+		checksum += value.isInteger ? static_cast<double>(value.intValue) : value.floatValue;
+		return value.isInteger;
+	});
+
+	// 정밀도 확인. 2^53 + 1은 double로 표현할 수 없다.
+	const std::wstring strPrecision = L"9007199254740993";
+	const wchar_t* first = strPrecision.data();
+	double precisionBefore = 0.0;
+	boost::spirit::qi::parse(first, strPrecision.data() + strPrecision.size(), boost::spirit::qi::double_, precisionBefore);
+
+	first = strPrecision.data();
+	NumeralValue precisionAfter;
+	ScanNumeral(first, strPrecision.data() + strPrecision.size(), &precisionAfter);
+
+	std::wcout << std::format(L"  {} -> qi: {:.0f}, numeral: {}", strPrecision, precisionBefore, precisionAfter.intValue) << std::endl;
+}
+
+// 로드 벤치마크용 스크립트 파일
+// 임시 폴더에 UTF-8 스크립트 파일을 count개 만든다. 이미 있으면 재사용한다. 한글 문자열과 주석을 포함한다.
+static std::vector<std::wstring> makeLoadCorpus(const int count)
+{
+	const std::filesystem::path corpusPath = std::filesystem::temp_directory_path() / std::format(L"dsl_load_corpus_{}", count);
+
+	std::vector<std::wstring> files;
+	files.reserve(count);
+	std::filesystem::create_directories(corpusPath);
+	for (int i = 0; i < count; ++i)
+	{
+		const std::filesystem::path filePath = corpusPath / std::format(L"script{}.dsl", i);
+		files.push_back(filePath.wstring());
+		if (std::filesystem::exists(filePath))
+			continue;
+
+		std::wstring strScript = std::format(L"-- 스크립트 {}\n", i);
+		strScript += MakeBenchmarkScript(2048 + (i % 16) * 256);
+		strScript += std::format(L"greeting{} = \"안녕하세요 {}번 스크립트\"\n", i, i);
+
+		const std::string strUtf8 = WideToUtf8(strScript);
+		std::ofstream file(filePath, std::ios::out | std::ios::binary);
+		file.write(strUtf8.data(), strUtf8.size());
+	}
+
+	return files;
+}
+
+// 스크립트 로드 벤치마크
+// 모든 파일을 로드해서 AST를 보관한다.
+void BenchmarkScriptLoad(const std::wstring& mode, const int count)
+{
+	const std::vector<std::wstring> files = makeLoadCorpus(count);
+
+	size_t totalBytes = 0;
+	for (const std::wstring& file : files)
+		totalBytes += static_cast<size_t>(std::filesystem::file_size(file));
+
+	const size_t peakBefore = GetPeakMemoryUsage();
+	std::vector<ASTPtr> asts;
+	asts.reserve(count);
+	int nFail = 0;
+
+	DSLManager* pManager = DSLManager::GetInstance();
+	pManager->SetQuiet(true);
+
+	const BenchClock::time_point start = BenchClock::now();
+	if (L"wifstream" == mode)
+	{
+		// 기존 LoadScript와 같은 방식. 사용자 함수 등록도 똑같이 한다.
+		for (const std::wstring& file : files)
+		{
+			std::wifstream scriptFile(std::filesystem::path(file), std::ios::in | std::ios::binary);
+			scriptFile.imbue(std::locale(""));
+			std::wstring strScript((std::istreambuf_iterator<wchar_t>(scriptFile)), std::istreambuf_iterator<wchar_t>());
+
+			ASTPtr spAST = ParserContext::GetThreadInstance().Parse(strScript);
+			if (!spAST)
+				++nFail;
+			pManager->AddASTFunction(file, spAST);
+			asts.push_back(spAST);
+		}
+	}
+	else if (L"mmap" == mode || L"lazy" == mode)
+	{
+		pManager->SetLazyFunctionBody(L"lazy" == mode);
+		for (const std::wstring& file : files)
+		{
+			if (!pManager->LoadScript(file))
+				++nFail;
+			asts.push_back(pManager->GetAST(file));
+		}
+	}
+	else
+	{
+		std::wcout << std::format(L"[load] unknown mode. mode={}", mode) << std::endl;
+		return;
+	}
+	const double loadUs = elapsedUs(start);
+
+	const size_t peakAfter = GetPeakMemoryUsage();
+	std::wcout << std::format(L"[load] mode={}, scripts={}, total={:.1f}MB, fail={}", mode, count, totalBytes / (1024.0 * 1024.0), nFail) << std::endl;
+	std::wcout << std::format(L"  load time: {:.1f}ms ({:.1f}us/script, {:.1f}MB/s)", loadUs / 1000.0, loadUs / count, totalBytes / loadUs) << std::endl;
+	std::wcout << std::format(L"  peak memory: {:.1f}MB (before load {:.1f}MB)", peakAfter / (1024.0 * 1024.0), peakBefore / (1024.0 * 1024.0)) << std::endl;
+}
+
+// 병렬 로드 벤치마크
+// 스레드 수를 1, 2, 4, ... maxThreads 로 늘리면서 같은 파일들을 LoadScripts로 로드한다.
+void BenchmarkLoadScripts(const int count, const int maxThreads)
+{
+	const std::vector<std::wstring> files = makeLoadCorpus(count);
+
+	DSLManager* pManager = DSLManager::GetInstance();
+	pManager->SetQuiet(true);
+
+	std::wcout << std::format(L"[loadall] scripts={}, hardware threads={}", count, std::thread::hardware_concurrency()) << std::endl;
+
+	// 모든 측정이 같은 조건(이전 AST를 교체하는 재로드)이 되도록 먼저 한 번 로드한다.
+	pManager->LoadScripts(files);
+
+	double baseMs = 0.0;
+	for (int nThread = 1; nThread <= maxThreads; nThread *= 2)
+	{
+		ScriptLoadReport report;
+		pManager->LoadScripts(files, &report, nThread);
+
+		// 파일별 소요시간
+		double sumMs = 0.0;
+		const ScriptLoadResult* pSlowest = &report.results.front();
+		for (const ScriptLoadResult& result : report.results)
+		{
+			sumMs += result.readMs + result.parseMs;
+			if (result.readMs + result.parseMs > pSlowest->readMs + pSlowest->parseMs)
+				pSlowest = &result;
+		}
+
+		if (1 == nThread)
+			baseMs = report.totalMs;
+
+		std::wcout << std::format(L"  threads={:<3}: total {:.1f}ms (x{:.2f}), publish {:.2f}ms, per file avg {:.3f}ms, max {:.3f}ms ({})",
+			nThread, report.totalMs, baseMs / report.totalMs, report.publishMs, sumMs / report.results.size(), pSlowest->readMs + pSlowest->parseMs,
+			std::filesystem::path(pSlowest->scriptName).filename().wstring()) << std::endl;
+	}
+}
+
+// AST 캐시 벤치마크
+// 같은 파일들을 캐시 없이, 캐시를 쓰면서(캐시 없음), 캐시를 읽어서 차례로 LoadScripts로 로드한다.
+void BenchmarkASTCache(const int count, const int nThread, const bool bLazyFunctionBody)
+{
+	const std::vector<std::wstring> files = makeLoadCorpus(count);
+	const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / std::format(L"dsl_ast_cache_{}", count);
+	std::error_code error;
+	std::filesystem::remove_all(cachePath, error);
+
+	size_t totalBytes = 0;
+	for (const std::wstring& file : files)
+		totalBytes += static_cast<size_t>(std::filesystem::file_size(file));
+
+	DSLManager* pManager = DSLManager::GetInstance();
+	pManager->SetQuiet(true);
+	pManager->SetLazyFunctionBody(bLazyFunctionBody);
+	pManager->SetASTCacheDirectory(cachePath.wstring());
+
+	auto load = [&](const wchar_t* pName, const bool bASTCache)
+	{
+		pManager->SetASTCache(bASTCache);
+
+		ScriptLoadReport report;
+		pManager->LoadScripts(files, &report, nThread);
+
+		double readMs = 0.0;
+		double parseMs = 0.0;
+		for (const ScriptLoadResult& result : report.results)
+		{
+			readMs += result.readMs;
+			parseMs += result.parseMs;
+		}
+
+		std::wcout << std::format(L"  {:<11}: total {:.1f}ms ({:.1f}us/script), read {:.1f}ms, parse/cache {:.1f}ms, cache hit={}, fail={}",
+			pName, report.totalMs, report.totalMs * 1000.0 / count, readMs, parseMs, report.cacheHitCount, report.failCount) << std::endl;
+		return report.totalMs;
+	};
+
+	std::wcout << std::format(L"[cache] scripts={}, total={:.1f}MB, threads={}, lazy={}", count, totalBytes / (1024.0 * 1024.0), nThread, bLazyFunctionBody) << std::endl;
+
+	// 파일을 페이지 캐시에 올려둔다.
+	pManager->SetASTCache(false);
+	pManager->LoadScripts(files, nullptr, nThread);
+
+	const double parseMs = load(L"parse", false);
+	std::vector<ASTPtr> parsedASTs;
+	parsedASTs.reserve(files.size());
+	for (const std::wstring& file : files)
+		parsedASTs.push_back(pManager->GetAST(file));
+
+	load(L"cache miss", true);
+	const double hitMs = load(L"cache hit", true);
+
+	// 캐시로 만든 AST를 다시 직렬화해서 파싱한 AST의 직렬화 결과와 비교한다.
+	size_t cacheBytes = 0;
+	bool bIdentical = true;
+	std::string parsedData;
+	std::string cachedData;
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		const ASTPtr spCachedAST = pManager->GetAST(files[i]);
+		if (!parsedASTs[i] || !spCachedAST || parsedASTs[i] == spCachedAST)
+		{
+			bIdentical = false;
+			continue;
+		}
+
+		SerializeAST(*parsedASTs[i], 0, 0, parsedData);
+		SerializeAST(*spCachedAST, 0, 0, cachedData);
+		bIdentical = bIdentical && parsedData == cachedData;
+		cacheBytes += static_cast<size_t>(std::filesystem::file_size(GetASTCachePath(files[i], cachePath.wstring()), error));
+	}
+
+	// 스크립트가 바뀌었거나 캐시 파일이 잘렸거나 헤더가 손상되었으면 캐시를 사용하지 않는다.
+	bool bStaleRejected = false;
+	ScriptFile scriptFile;
+	ScriptFile cacheFile;
+	if (scriptFile.Open(files.back()) && cacheFile.Open(GetASTCachePath(files.back(), cachePath.wstring())))
+	{
+		const std::string_view script = scriptFile.GetText();
+		const std::string_view data = cacheFile.GetText();
+		const uint64_t hash = HashScriptText(script);
+
+		std::vector<FunctionDefinitionCPtr> functions;
+		bStaleRejected = nullptr != DeserializeAST(data, script, hash, bLazyFunctionBody, functions)
+			&& nullptr == DeserializeAST(data, script, hash + 1, bLazyFunctionBody, functions)
+			&& nullptr == DeserializeAST(data, script.substr(0, script.size() - 1), hash, bLazyFunctionBody, functions)
+			&& nullptr == DeserializeAST(data.substr(0, data.size() - 1), script, hash, bLazyFunctionBody, functions);
+
+		// 헤더의 개수를 바꾼 캐시. 버퍼를 할당하기 전에 거부해야 한다.
+		auto corruptCount = [&](const size_t countOffset)
+		{
+			std::string corrupt(data);
+			const uint32_t count = 0xFFFFFFF0u;
+			std::memcpy(corrupt.data() + countOffset, &count, sizeof(count));
+			return nullptr == DeserializeAST(corrupt, script, hash, bLazyFunctionBody, functions);
+		};
+		bStaleRejected = bStaleRejected
+			&& corruptCount(offsetof(ASTCacheHeader, symbolCount))
+			&& corruptCount(offsetof(ASTCacheHeader, stringCount))
+			&& corruptCount(offsetof(ASTCacheHeader, functionCount))
+			&& corruptCount(offsetof(ASTCacheHeader, nodeCount));
+	}
+
+	std::wcout << std::format(L"  cache hit x{:.1f} faster than parse, cache files {:.1f}MB (x{:.2f} of scripts), same AST={}, stale/truncated/corrupt cache rejected={}",
+		parseMs / (std::max)(hitMs, 1e-3), cacheBytes / (1024.0 * 1024.0), static_cast<double>(cacheBytes) / totalBytes, bIdentical, bStaleRejected) << std::endl;
+
+	pManager->SetASTCache(false);
+	pManager->SetASTCacheDirectory(L"");
+	pManager->SetLazyFunctionBody(false);
+}
+
+// 노드 공유 벤치마크
+// 같은 파일들을 노드를 공유하지 않고, 공유하면서, 공유 모드로 한 번 더 차례로 LoadScripts로 로드한다.
+void BenchmarkShareAST(const int count, const int nThread, const bool bLazyFunctionBody)
+{
+	const std::vector<std::wstring> files = makeLoadCorpus(count);
+
+	size_t totalBytes = 0;
+	for (const std::wstring& file : files)
+		totalBytes += static_cast<size_t>(std::filesystem::file_size(file));
+
+	DSLManager* pManager = DSLManager::GetInstance();
+	pManager->SetQuiet(true);
+	pManager->SetLazyFunctionBody(bLazyFunctionBody);
+	pManager->SetASTCache(false);
+
+	std::wcout << std::format(L"[share] scripts={}, total={:.1f}MB, threads={}, lazy={}", count, totalBytes / (1024.0 * 1024.0), nThread, bLazyFunctionBody) << std::endl;
+
+	// 파일을 페이지 캐시에 올려둔다.
+	pManager->SetShareAST(false);
+	pManager->LoadScripts(files, nullptr, nThread);
+
+	auto load = [&](const wchar_t* pName, const bool bShareAST)
+	{
+		pManager->SetShareAST(bShareAST);
+
+		ScriptLoadReport report;
+		pManager->LoadScripts(files, &report, nThread);
+
+		double shareMs = 0.0;
+		for (const ScriptLoadResult& result : report.results)
+			shareMs += result.shareMs;
+
+		// 모든 AST의 노드 수와 서로 다른 노드 수, 노드가 있는 아레나의 크기
+		std::vector<ASTPtr> asts;
+		std::unordered_set<const Base*> distinctNodes;
+		std::unordered_set<const ASTArena*> arenas;
+		size_t nodeCount = 0;
+		size_t arenaBytes = 0;
+		for (const std::wstring& file : files)
+		{
+			asts.push_back(pManager->GetAST(file));
+			WalkAST(asts.back(), [&](const Base& node)
+				{
+					++nodeCount;
+					distinctNodes.insert(&node);
+				});
+		}
+
+		// 공유 노드는 힙에 있고, AST의 아레나에는 공유하지 않는 노드(파싱하지 않은 지연 함수)만 있다.
+		for (const ASTPtr& spAST : asts)
+		{
+			if (spAST && spAST->arena && arenas.insert(spAST->arena.get()).second)
+				arenaBytes += spAST->arena->GetReservedBytes();
+		}
+
+		std::wcout << std::format(L"  {:<9}: total {:.1f}ms (share {:.1f}ms), nodes={}, distinct nodes={} ({:.1f}%), arena {:.1f}MB, shared nodes={}, reclaimed {:.1f}MB",
+			pName, report.totalMs, shareMs, nodeCount, distinctNodes.size(), 100.0 * distinctNodes.size() / (std::max)(nodeCount, static_cast<size_t>(1)),
+			arenaBytes / (1024.0 * 1024.0), report.sharedNodeCount, report.nodeBytesReclaimed / (1024.0 * 1024.0)) << std::endl;
+		return asts;
+	};
+
+	const std::vector<ASTPtr> parsedASTs = load(L"no share", false);
+	const std::vector<ASTPtr> sharedASTs = load(L"share", true);
+	load(L"reload", true);
+
+	// 공유한 AST를 직렬화해서 원래 AST의 직렬화 결과와 비교한다.
+	bool bIdentical = true;
+	std::string parsedData;
+	std::string sharedData;
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		if (!parsedASTs[i] || !sharedASTs[i])
+		{
+			bIdentical = false;
+			continue;
+		}
+
+		SerializeAST(*parsedASTs[i], 0, 0, parsedData);
+		SerializeAST(*sharedASTs[i], 0, 0, sharedData);
+		bIdentical = bIdentical && parsedData == sharedData;
+	}
+
+	std::wcout << std::format(L"  same AST={}", bIdentical) << std::endl;
+
+	pManager->SetShareAST(false);
+	pManager->SetLazyFunctionBody(false);
+}
+
+// 정규화 벤치마크용 AST 정보
+struct NormalizeBenchInfo
+{
+	size_t nodeCount = 0;			// 노드 수
+	size_t stepCount = 0;			// Environment가 call stack에 넣는 노드 수
+	size_t wrapperCount = 0;		// 안쪽 노드가 있는 래퍼 노드 수
+	std::vector<size_t> shape;		// 래퍼 노드를 제외한 노드의 전위 순서 (타입과 값)
+};
+
+// 래퍼 노드인지 여부. 안쪽 노드가 없는 래퍼는 정규화해도 남는다.
+static bool isWrapperNode(const Base& node)
+{
+	return VisitNode(node, [](const auto& typedNode)
+		{
+			using T = std::decay_t<decltype(typedNode)>;
+			if constexpr (std::is_same_v<T, Expression>)
+				return nullptr != typedNode.expression;
+			else if constexpr (std::is_same_v<T, PrimaryExpression>)
+				return nullptr != typedNode.primaryExpression;
+			else if constexpr (std::is_same_v<T, Statement>)
+				return nullptr != typedNode.statement;
+			else if constexpr (std::is_same_v<T, FunctionArgument>)
+				return nullptr != typedNode.expressionList;
+			else if constexpr (std::is_same_v<T, FunctionParameter>)
+				return nullptr != typedNode.nameList;
+			else
+				return false;
+		});
+}
+
+// 노드 수, 실행 단계 수, 래퍼 노드를 제외한 모양을 구한다.
+// 실행 단계는 스크립트를 한 번 실행하고 모든 함수를 한 번씩 호출할 때 Environment가 call stack에 넣는 노드 수이다.
+// Environment는 함수 정의를 실행하지 않고(이름과 파라미터를 call stack에 넣지 않는다) 호출할 때 본문을 실행한다.
+static void collectNormalizeBenchInfo(const Base& root, NormalizeBenchInfo& info)
+{
+	WalkAST(root, [&info](const auto& node) -> EVisitResult
+		{
+			using T = std::decay_t<decltype(node)>;
+			++info.nodeCount;
+			if (isWrapperNode(node))
+			{
+				++info.wrapperCount;
+				++info.stepCount;
+				return EVisitResult::Continue;
+			}
+
+			// 정규화하면 빈 인자, 빈 파라미터는 빈 ExpressionList, NameList가 된다.
+			if constexpr (std::is_same_v<T, FunctionArgument>)
+				info.shape.push_back(static_cast<size_t>(EASTType::ExpressionList));
+			else if constexpr (std::is_same_v<T, FunctionParameter>)
+				info.shape.push_back(static_cast<size_t>(EASTType::NameList));
+			else
+				info.shape.push_back(static_cast<size_t>(node.GetType()));
+
+			if constexpr (std::is_same_v<T, Name>)
+				info.shape.push_back(node.id);
+			else if constexpr (std::is_same_v<T, Numeral>)
+				info.shape.push_back(static_cast<size_t>(node.intValue));
+			else if constexpr (std::is_same_v<T, BinaryExpression>)
+				info.shape.push_back(static_cast<size_t>(node.binaryOperator));
+			else if constexpr (std::is_same_v<T, UnaryExpression>)
+				info.shape.push_back(static_cast<size_t>(node.unaryOperator));
+
+			if constexpr (std::is_same_v<T, FunctionDefinition>)
+			{
+				// 이름과 파라미터는 노드 수에만 더한다.
+				++info.stepCount;
+				NormalizeBenchInfo declaration;
+				if (node.name)
+					collectNormalizeBenchInfo(*node.name, declaration);
+				if (node.functionParameter)
+					collectNormalizeBenchInfo(*node.functionParameter, declaration);
+				info.nodeCount += declaration.nodeCount;
+				info.wrapperCount += declaration.wrapperCount;
+				info.shape.insert(info.shape.end(), declaration.shape.begin(), declaration.shape.end());
+
+				if (const BasePtr& spBlock = node.GetParsedBlock())
+					collectNormalizeBenchInfo(*spBlock, info);
+				return EVisitResult::SkipChildren;
+			}
+
+			++info.stepCount;
+			return EVisitResult::Continue;
+		});
+}
+
+// 정규화 벤치마크
+// 같은 파일들을 정규화하지 않고, 정규화하면서 LoadScripts로 로드하고, 노드 공유 모드에서 한 번 더 비교한다.
+void BenchmarkNormalizeAST(const int count, const int nThread)
+{
+	const std::vector<std::wstring> files = makeLoadCorpus(count);
+
+	DSLManager* pManager = DSLManager::GetInstance();
+	pManager->SetQuiet(true);
+	pManager->SetLazyFunctionBody(false);
+	pManager->SetASTCache(false);
+	pManager->SetShareAST(false);
+	pManager->SetNormalizeAST(false);
+
+	std::wcout << std::format(L"[normalize] scripts={}, threads={}", count, nThread) << std::endl;
+
+	// 파일을 페이지 캐시에 올려둔다.
+	pManager->LoadScripts(files, nullptr, nThread);
+
+	struct LoadResult
+	{
+		std::vector<NormalizeBenchInfo> infos;
+		size_t nodeCount = 0;
+		size_t stepCount = 0;
+		size_t wrapperCount = 0;
+		size_t arenaBytes = 0;
+	};
+
+	auto load = [&](const wchar_t* pName, const bool bNormalizeAST, const bool bShareAST)
+	{
+		pManager->SetNormalizeAST(bNormalizeAST);
+		pManager->SetShareAST(bShareAST);
+
+		ScriptLoadReport report;
+		pManager->LoadScripts(files, &report, nThread);
+
+		double normalizeMs = 0.0;
+		for (const ScriptLoadResult& result : report.results)
+			normalizeMs += result.normalizeMs;
+
+		LoadResult loadResult;
+		std::unordered_set<const ASTArena*> arenas;
+		for (const std::wstring& file : files)
+		{
+			NormalizeBenchInfo& info = loadResult.infos.emplace_back();
+			const ASTPtr spAST = pManager->GetAST(file);
+			if (!spAST)
+				continue;
+
+			collectNormalizeBenchInfo(*spAST, info);
+			loadResult.nodeCount += info.nodeCount;
+			loadResult.stepCount += info.stepCount;
+			loadResult.wrapperCount += info.wrapperCount;
+			if (spAST->arena && arenas.insert(spAST->arena.get()).second)
+				loadResult.arenaBytes += spAST->arena->GetReservedBytes();
+		}
+
+		std::wcout << std::format(L"  {:<16}: total {:.1f}ms (normalize {:.1f}ms), nodes={}, steps={}, wrappers={}, removed={}, arena {:.1f}MB",
+			pName, report.totalMs, normalizeMs, loadResult.nodeCount, loadResult.stepCount, loadResult.wrapperCount, report.removedNodeCount,
+			loadResult.arenaBytes / (1024.0 * 1024.0)) << std::endl;
+		return loadResult;
+	};
+
+	const LoadResult parsed = load(L"parse", false, false);
+	const LoadResult normalized = load(L"normalize", true, false);
+	const LoadResult shared = load(L"share", false, true);
+	const LoadResult normalizedShared = load(L"normalize + share", true, true);
+
+	// 래퍼 노드를 제외하면 모양이 같아야 한다.
+	bool bSameShape = parsed.infos.size() == normalized.infos.size();
+	for (size_t i = 0; bSameShape && i < parsed.infos.size(); ++i)
+		bSameShape = parsed.infos[i].shape == normalized.infos[i].shape && parsed.infos[i].shape == normalizedShared.infos[i].shape;
+
+	auto reduction = [](const size_t before, const size_t after) { return 100.0 * (static_cast<double>(before) - static_cast<double>(after)) / (std::max)(before, static_cast<size_t>(1)); };
+	std::wcout << std::format(L"  nodes -{:.1f}%, steps -{:.1f}%, share arena {:.1f}MB -> {:.1f}MB, same shape without wrappers={}",
+		reduction(parsed.nodeCount, normalized.nodeCount), reduction(parsed.stepCount, normalized.stepCount),
+		shared.arenaBytes / (1024.0 * 1024.0), normalizedShared.arenaBytes / (1024.0 * 1024.0), bSameShape) << std::endl;
+
+	// 코퍼스에는 인자, 파라미터가 없는 함수가 없으므로 따로 확인한다. 정규화하면 빈 인자는 빈 ExpressionList, 빈 파라미터는 빈 NameList가 된다.
+	size_t nEmptyList = 0;
+	size_t nEmptyWrapper = 0;
+	if (ASTPtr spEmptyAST = ParserContext::GetThreadInstance().Parse(L"function g() x = f() end\ny = g()\n"))
+	{
+		NormalizeAST(*spEmptyAST);
+		WalkAST(*spEmptyAST, [&](const auto& node) -> EVisitResult
+			{
+				using T = std::decay_t<decltype(node)>;
+				if constexpr (std::is_same_v<T, ExpressionList>)
+					nEmptyList += node.expressions.empty() ? 1 : 0;
+				else if constexpr (std::is_same_v<T, NameList>)
+					nEmptyList += node.names.empty() ? 1 : 0;
+				else if constexpr (std::is_same_v<T, FunctionArgument> || std::is_same_v<T, FunctionParameter>)
+					++nEmptyWrapper;
+				return EVisitResult::Continue;
+			});
+	}
+	std::wcout << std::format(L"  empty argument/parameter lists: {}/3 normalized, wrappers left={}", nEmptyList, nEmptyWrapper) << std::endl;
+
+	pManager->SetNormalizeAST(false);
+	pManager->SetShareAST(false);
+}
+
+// 스트리밍 파싱 벤치마크
+// 임시 폴더에 데이터 테이블 스크립트를 만든 다음(이미 있으면 재사용) 파싱한다.
+void BenchmarkStreamParse(const std::wstring& mode, const size_t scriptMB)
+{
+	const std::filesystem::path filePath = std::filesystem::temp_directory_path() / std::format(L"dsl_stream_{}MB.dsl", scriptMB);
+	if (!std::filesystem::exists(filePath))
+	{
+		std::ofstream file(filePath, std::ios::out | std::ios::binary);
+		const size_t targetLength = scriptMB * 1024 * 1024;
+		size_t length = 0;
+		for (size_t row = 0; length < targetLength; ++row)
+		{
+			const std::string strLine = WideToUtf8(std::format(L"row{} = Row({}, \"아이템{}\", {}, {}.5, 0x{:X}, {} * 2 + 1)\n", row, row, row, row % 97, row % 1000, row, row % 13));
+			file.write(strLine.data(), strLine.size());
+			length += strLine.size();
+		}
+	}
+	const size_t fileSize = static_cast<size_t>(std::filesystem::file_size(filePath));
+
+	const size_t peakBefore = GetPeakMemoryUsage();
+	size_t nStatement = 0;
+	double firstStatementUs = 0.0;
+	bool bSuccess = false;
+	ASTPtr spAST;
+
+	const BenchClock::time_point start = BenchClock::now();
+	if (L"whole" == mode)
+	{
+		ScriptFile scriptFile;
+		if (scriptFile.Open(filePath.wstring()))
+			spAST = ParserContext::GetThreadInstance().Parse(scriptFile.GetText());
+
+		// 전체를 파싱한 다음에야 첫 구문을 사용할 수 있다.
+		firstStatementUs = elapsedUs(start);
+		bSuccess = (nullptr != spAST);
+		if (bSuccess)
+			nStatement = static_cast<const Block&>(*spAST->block).statements.size();
+	}
+	else if (L"stream" == mode)
+	{
+		StreamParser parser;
+		bSuccess = parser.ParseFile(filePath.wstring(), [&](const BasePtr&)
+		{
+			if (0 == nStatement)
+				firstStatementUs = elapsedUs(start);
+			++nStatement;
+			return true;
+		});
+		std::wcout << std::format(L"[stream] chunk={}KB, max buffer={}KB", StreamParser::DefaultChunkSize / 1024, parser.GetMaxBufferSize() / 1024) << std::endl;
+	}
+	else
+	{
+		std::wcout << std::format(L"[stream] unknown mode. mode={}", mode) << std::endl;
+		return;
+	}
+	const double parseUs = elapsedUs(start);
+
+	const size_t peakAfter = GetPeakMemoryUsage();
+	std::wcout << std::format(L"[stream] mode={}, script={:.1f}MB, statements={}, success={}", mode, fileSize / (1024.0 * 1024.0), nStatement, bSuccess) << std::endl;
+	std::wcout << std::format(L"  parse time: {:.1f}ms ({:.1f}MB/s), first statement: {:.1f}ms", parseUs / 1000.0, fileSize / parseUs, firstStatementUs / 1000.0) << std::endl;
+	std::wcout << std::format(L"  peak memory: {:.1f}MB (before parse {:.1f}MB)", peakAfter / (1024.0 * 1024.0), peakBefore / (1024.0 * 1024.0)) << std::endl;
+}
+
+// hot reload 벤치마크
+// 임시 폴더의 스크립트 파일을 원본으로 되돌리고 로드한 다음, 한 곳을 수정해서 ReloadScript로 다시 로드한다.
+// 수정한 파일을 전체 파싱한 AST와 출력 결과를 비교하고, 수정하지 않은 함수가 같은 노드를 사용하는지 확인한다.
+void BenchmarkReload(const size_t scriptKB)
+{
+	const std::wstring strOriginal = MakeBenchmarkScript(scriptKB * 1024);
+	const size_t nBlock = static_cast<size_t>(std::count(strOriginal.begin(), strOriginal.end(), L'\n')) / 8;
+	const size_t middle = nBlock / 2;
+
+	// 원본에서 찾은 문자열을 바꾼다.
+	auto replace = [&strOriginal](const std::wstring& strFind, const std::wstring& strReplace)
+	{
+		std::wstring strScript = strOriginal;
+		const size_t pos = strScript.find(strFind);
+		if (std::wstring::npos != pos)
+			strScript.replace(pos, strFind.size(), strReplace);
+		return strScript;
+	};
+
+	const std::pair<const wchar_t*, std::wstring> edits[] =
+	{
+		{ L"body", replace(std::format(L"\"message {}\"", middle), std::format(L"\"changed message {}\", extra", middle)) },
+		{ L"rename", replace(std::format(L"function func{}(", middle), std::format(L"function renamed{}(", middle)) },
+		{ L"duplicate", replace(std::format(L"function func{}(", middle), L"function func1(") },
+		{ L"insert", replace(std::format(L"-- generated block {}\n", middle), std::format(L"-- generated block {}\nfunction inserted(x)\n    y = x + 1\nend\n", middle)) },
+		{ L"delete", replace(std::format(L"result{} = func{}(", middle, middle), std::format(L"-- result{} = func{}(", middle, middle)) },
+		{ L"comment", replace(std::format(L"-- generated block {}\n", middle), std::format(L"-- generated block {} (edited)\n", middle)) },
+		{ L"first", replace(L"value0 = a * 2", L"value0 = a * 3") },
+		{ L"last", strOriginal + L"appended = 1\n" },
+		{ L"string", replace(std::format(L"-- generated block {}\n", middle), std::format(L"-- generated block {}\nopen = \"", middle)) + L"\"\n" },
+	};
+
+	const std::filesystem::path filePath = std::filesystem::temp_directory_path() / L"dsl_reload.dsl";
+	const std::wstring fileName = filePath.wstring();
+	auto writeScript = [&filePath](const std::wstring& strScript)
+	{
+		const std::string strUtf8 = WideToUtf8(strScript);
+		std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(strUtf8.data(), strUtf8.size());
+	};
+
+	DSLManager* pManager = DSLManager::GetInstance();
+	pManager->SetQuiet(true);
+	pManager->SetHotReload(true);
+
+	std::wcout << std::format(L"[reload] script={:.1f}KB, lines={}, functions={}", strOriginal.size() / 1024.0, nBlock * 8, nBlock) << std::endl;
+	for (const auto& [editName, strEdited] : edits)
+	{
+		// 원본을 로드한다. hot reload 모드이므로 텍스트를 보관한다.
+		writeScript(strOriginal);
+		pManager->LoadScript(fileName);
+		const FunctionDefinitionCPtr spUntouched = pManager->GetASTFunction(fileName, L"func0");
+
+		// 수정한 파일을 증분 파싱한다.
+		writeScript(strEdited);
+		ReparseStats stats;
+		BenchClock::time_point start = BenchClock::now();
+		const bool bReload = pManager->ReloadScript(fileName, &stats);
+		const double reloadUs = elapsedUs(start);
+		const ASTPtr spReloaded = pManager->GetAST(fileName);
+		const size_t nFunction = pManager->GetASTFunctionCount(fileName);
+		const bool bReused = (spUntouched == pManager->GetASTFunction(fileName, L"func0"));
+
+		// 같은 파일을 전체 파싱한다. hot reload 모드의 LoadScript는 보관한 텍스트를 사용하지 않는다.
+		start = BenchClock::now();
+		pManager->LoadScript(fileName);
+		const double fullUs = elapsedUs(start);
+		const bool bIdentical = bReload && printAST(spReloaded) == printAST(pManager->GetAST(fileName)) && nFunction == pManager->GetASTFunctionCount(fileName);
+
+		std::wcout << std::format(L"  {:<9}: reload {:.3f}ms, full {:.3f}ms (x{:.1f}), statements reused={}, parsed={}, removed={}, parsed bytes={}, attempts={}, func0 reused={}, identical={}",
+			editName, reloadUs / 1000.0, fullUs / 1000.0, fullUs / reloadUs, stats.reusedStatementCount, stats.parsedStatementCount, stats.removedStatementCount, stats.parsedLength, stats.attemptCount, bReused, bIdentical) << std::endl;
+	}
+}
+
+// 지연 파싱 벤치마크
+// 같은 스크립트를 두 파일로 만들어서 하나는 바로 파싱하고, 하나는 함수 본문을 지연 파싱한다.
+void BenchmarkLazyFunction(const size_t scriptKB, const int nThread)
+{
+	const std::wstring strScript = MakeBenchmarkScript(scriptKB * 1024);
+	const std::string strUtf8 = WideToUtf8(strScript);
+
+	const std::wstring eagerFile = (std::filesystem::temp_directory_path() / L"dsl_lazy_eager.dsl").wstring();
+	const std::wstring lazyFile = (std::filesystem::temp_directory_path() / L"dsl_lazy_lazy.dsl").wstring();
+	for (const std::wstring& file : { eagerFile, lazyFile })
+	{
+		std::ofstream stream(std::filesystem::path(file), std::ios::out | std::ios::binary | std::ios::trunc);
+		stream.write(strUtf8.data(), strUtf8.size());
+	}
+
+	DSLManager* pManager = DSLManager::GetInstance();
+	pManager->SetQuiet(true);
+	pManager->SetHotReload(false);
+
+	// 바로 파싱
+	pManager->SetLazyFunctionBody(false);
+	BenchClock::time_point start = BenchClock::now();
+	const bool bEager = pManager->LoadScript(eagerFile);
+	const double eagerUs = elapsedUs(start);
+
+	// 지연 파싱
+	pManager->SetLazyFunctionBody(true);
+	start = BenchClock::now();
+	const bool bLazy = pManager->LoadScript(lazyFile);
+	const double lazyUs = elapsedUs(start);
+	const size_t lazyFunctionCount = ParserContext::GetThreadInstance().GetLastStats().lazyFunctionCount;
+	pManager->SetLazyFunctionBody(false);
+
+	const size_t nFunction = pManager->GetASTFunctionCount(lazyFile);
+	std::wcout << std::format(L"[lazy] script={:.1f}KB, functions={}, lazy functions={}, load ok={}", strUtf8.size() / 1024.0, nFunction, lazyFunctionCount, bEager && bLazy) << std::endl;
+	std::wcout << std::format(L"  load: eager {:.3f}ms, lazy {:.3f}ms (x{:.1f})", eagerUs / 1000.0, lazyUs / 1000.0, eagerUs / lazyUs) << std::endl;
+
+	// 모든 스레드가 같은 순서로 모든 함수를 찾는다. 처음 찾는 함수는 여러 스레드가 동시에 본문 파싱을 요청하게 된다.
+	std::vector<std::vector<BaseCPtr>> blocks(nThread);
+	std::vector<std::thread> threads;
+	start = BenchClock::now();
+	for (int t = 0; t < nThread; ++t)
+	{
+		threads.emplace_back([pManager, &lazyFile, &blocks, nFunction, t]()
+			{
+				blocks[t].reserve(nFunction);
+				for (size_t i = 0; i < nFunction; ++i)
+				{
+					const FunctionDefinitionCPtr spFunction = pManager->GetASTFunction(lazyFile, std::format(L"func{}", i));
+					blocks[t].push_back(spFunction ? spFunction->GetBlock() : nullptr);
+				}
+			});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+	const double materializeUs = elapsedUs(start);
+
+	// 모든 스레드가 같은 Block 객체를 받았다면 본문을 한 번만 파싱한 것이다.
+	bool bSameBlock = true;
+	for (int t = 1; t < nThread; ++t)
+		bSameBlock = bSameBlock && blocks[t] == blocks[0];
+
+	// 파싱한 본문은 바로 파싱한 결과와 같아야 한다.
+	bool bIdentical = nFunction == pManager->GetASTFunctionCount(eagerFile);
+	for (size_t i = 0; bIdentical && i < nFunction; ++i)
+	{
+		const std::wstring funcName = std::format(L"func{}", i);
+		bIdentical = printAST(pManager->GetASTFunction(eagerFile, funcName)) == printAST(pManager->GetASTFunction(lazyFile, funcName));
+	}
+
+	// 이미 파싱한 함수를 찾는 비용
+	start = BenchClock::now();
+	for (size_t i = 0; i < nFunction; ++i)
+		pManager->GetASTFunction(lazyFile, std::format(L"func{}", i));
+	const double lookupUs = elapsedUs(start);
+
+	std::wcout << std::format(L"  materialize all: {:.3f}ms with {} threads ({:.2f}us/function), lazy load + materialize {:.3f}ms", materializeUs / 1000.0, nThread, materializeUs / (std::max)(nFunction, static_cast<size_t>(1)), (lazyUs + materializeUs) / 1000.0) << std::endl;
+	std::wcout << std::format(L"  lookup after materialize: {:.3f}ms, same block in all threads={}, identical={}", lookupUs / 1000.0, bSameBlock, bIdentical) << std::endl;
+}
+
+// 심볼 벤치마크
+// 문자열 key map은 심볼 테이블을 도입하기 전의 사용자 함수 map과 같은 구조로 만들어서 비교한다.
+void BenchmarkSymbol(const size_t scriptKB, const int nLookup)
+{
+	const std::wstring strScript = MakeBenchmarkScript(scriptKB * 1024);
+	const std::string strUtf8 = WideToUtf8(strScript);
+
+	const std::wstring fileName = (std::filesystem::temp_directory_path() / L"dsl_symbol.dsl").wstring();
+	{
+		std::ofstream file(std::filesystem::path(fileName), std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write(strUtf8.data(), strUtf8.size());
+	}
+
+	DSLManager* pManager = DSLManager::GetInstance();
+	pManager->SetQuiet(true);
+	pManager->SetHotReload(false);
+	pManager->SetLazyFunctionBody(false);
+
+	const size_t symbolCountBefore = SymbolTable::GetInstance().GetCount();
+	const BenchClock::time_point loadStart = BenchClock::now();
+	const bool bLoad = pManager->LoadScript(fileName);
+	const double loadUs = elapsedUs(loadStart);
+
+	// Name 노드 수와 문자열로 가지고 있었다면 필요한 메모리
+	// std::wstring은 짧은 문자열을 객체 안에 저장한다. (SSO) 그보다 긴 이름은 힙에 따로 할당한다.
+	constexpr size_t ssoCapacity = sizeof(std::wstring) / sizeof(wchar_t) - 1;
+	size_t nName = 0;
+	size_t stringBytes = 0;
+	std::set<SymbolId> usedSymbols;
+	pManager->GetAST(fileName)->Iterate([&](const BaseCPtr& spBase)
+		{
+			if (!spBase || EASTType::Name != spBase->GetType())
+				return;
+
+			const Name& name = static_cast<const Name&>(*spBase);
+			const size_t length = name.GetName().size();
+			++nName;
+			stringBytes += sizeof(std::wstring) + (length > ssoCapacity ? (length + 1) * sizeof(wchar_t) : 0);
+			usedSymbols.insert(name.id);
+		});
+
+	std::wcout << std::format(L"[symbol] script={:.1f}KB, load ok={}, load {:.3f}ms", strUtf8.size() / 1024.0, bLoad, loadUs / 1000.0) << std::endl;
+	std::wcout << std::format(L"  names={}, distinct={}, new symbols={}, total symbols={}", nName, usedSymbols.size(), SymbolTable::GetInstance().GetCount() - symbolCountBefore, SymbolTable::GetInstance().GetCount()) << std::endl;
+	std::wcout << std::format(L"  name storage: string {:.1f}KB -> symbol id {:.1f}KB", stringBytes / 1024.0, nName * sizeof(SymbolId) / 1024.0) << std::endl;
+
+	// 함수 찾기
+	const size_t nFunction = pManager->GetASTFunctionCount(fileName);
+	std::vector<std::wstring> funcNames;
+	std::vector<SymbolId> funcIds;
+	std::unordered_map<std::wstring, FunctionDefinitionCPtr> stringKeyMap;
+	for (size_t i = 0; i < nFunction; ++i)
+	{
+		funcNames.push_back(std::format(L"func{}", i));
+		funcIds.push_back(FindSymbol(funcNames.back()));
+		stringKeyMap[funcNames.back()] = pManager->GetASTFunction(fileName, funcIds.back());
+	}
+
+	size_t nFound = 0;
+	BenchClock::time_point start = BenchClock::now();
+	for (int n = 0; n < nLookup; ++n)
+	{
+		for (const std::wstring& funcName : funcNames)
+			nFound += stringKeyMap.contains(funcName) ? 1 : 0;
+	}
+	const double stringMapUs = elapsedUs(start);
+
+	start = BenchClock::now();
+	for (int n = 0; n < nLookup; ++n)
+	{
+		for (const std::wstring& funcName : funcNames)
+			nFound += pManager->GetASTFunction(fileName, funcName) ? 1 : 0;
+	}
+	const double byNameUs = elapsedUs(start);
+
+	start = BenchClock::now();
+	for (int n = 0; n < nLookup; ++n)
+	{
+		for (const SymbolId funcId : funcIds)
+			nFound += pManager->GetASTFunction(fileName, funcId) ? 1 : 0;
+	}
+	const double byIdUs = elapsedUs(start);
+
+	const double nCall = static_cast<double>(nFunction) * nLookup;
+	std::wcout << std::format(L"  lookup x{}: string-key map {:.1f}ns, GetASTFunction(name) {:.1f}ns, GetASTFunction(id) {:.1f}ns per call, found={}/{}",
+		nCall, stringMapUs * 1000.0 / nCall, byNameUs * 1000.0 / nCall, byIdUs * 1000.0 / nCall, nFound, nCall * 3) << std::endl;
+}
+
+// 상수 풀 벤치마크
+// 메시지 key 문자열을 반복해서 사용하는 스크립트를 만든다. 리터럴은 nKey 종류의 key 중 하나이다.
+void BenchmarkConstantPool(const size_t scriptKB, const int nKey)
+{
+	const size_t targetLength = scriptKB * 1024;
+	const int keyCount = (std::max)(nKey, 1);
+
+	std::wstring strScript;
+	strScript.reserve(targetLength + 256);
+	for (size_t i = 0; strScript.size() < targetLength; ++i)
+	{
+		const size_t key = i % keyCount;
+		strScript += std::format(L"msg{} = \"ui.message.quest_reward_notice_{}\"\n", i, key);
+		strScript += std::format(L"Print(\"ui.message.quest_reward_notice_{}\", msg{}, {})\n", (key * 7) % keyCount, i, i);
+	}
+	const std::string strUtf8 = WideToUtf8(strScript);
+
+	ParserContext& context = ParserContext::GetThreadInstance();
+	ASTPtr spAST;
+	double parseUs = 0.0;
+	{
+		BenchTraceMute mute;
+		const BenchClock::time_point start = BenchClock::now();
+		spAST = context.Parse(std::string_view(strUtf8));
+		parseUs = elapsedUs(start);
+	}
+	const ParseStats stats = context.GetLastStats();
+
+	std::vector<LiteralStringCPtr> literals;
+	if (spAST)
+	{
+		spAST->Iterate([&literals](const BaseCPtr& spBase)
+			{
+				if (spBase && EASTType::LiteralString == spBase->GetType())
+					literals.push_back(static_pointer_cast<const LiteralString>(spBase));
+			});
+	}
+
+	std::set<const std::wstring*> buffers;
+	for (const LiteralStringCPtr& spLiteral : literals)
+		buffers.insert(spLiteral->value.get());
+
+	std::wcout << std::format(L"[constant] script={:.1f}KB, keys={}, parse ok={}, {:.3f}ms", strUtf8.size() / 1024.0, keyCount, spAST != nullptr, parseUs / 1000.0) << std::endl;
+	std::wcout << std::format(L"  literals={}, constants={}, distinct buffers in AST={}", stats.literalCount, stats.constantCount, buffers.size()) << std::endl;
+	if (spAST && spAST->constants)
+	{
+		const size_t pooledBytes = spAST->constants->GetPooledBytes();
+		const size_t totalBytes = pooledBytes + stats.literalBytesSaved;
+		std::wcout << std::format(L"  literal bytes: {:.1f}KB -> {:.1f}KB, saved {:.1f}KB ({:.1f}%)",
+			totalBytes / 1024.0, pooledBytes / 1024.0, stats.literalBytesSaved / 1024.0, 0 == totalBytes ? 0.0 : stats.literalBytesSaved * 100.0 / totalBytes) << std::endl;
+	}
+
+	// 리터럴을 실행할 때 만드는 값. 상수 풀 도입 전에는 리터럴마다 문자열을 복사했다.
+	constexpr int nRun = 20;
+	size_t checkSum = 0;
+	BenchClock::time_point start = BenchClock::now();
+	for (int n = 0; n < nRun; ++n)
+	{
+		for (const LiteralStringCPtr& spLiteral : literals)
+		{
+			EnvValStringUptr upVal = std::make_unique<EnvValString>(std::wstring(spLiteral->GetValue()));
+			checkSum += upVal->val->size();
+		}
+	}
+	const double copyUs = elapsedUs(start);
+
+	start = BenchClock::now();
+	for (int n = 0; n < nRun; ++n)
+	{
+		for (const LiteralStringCPtr& spLiteral : literals)
+		{
+			EnvValStringUptr upVal = std::make_unique<EnvValString>(spLiteral->value);
+			checkSum += upVal->val->size();
+		}
+	}
+	const double shareUs = elapsedUs(start);
+
+	const double nValue = static_cast<double>(literals.size()) * nRun;
+	if (0 < nValue)
+		std::wcout << std::format(L"  runtime value x{}: copy {:.1f}ns, shared buffer {:.1f}ns per literal (checksum={})", nValue, copyUs * 1000.0 / nValue, shareUs * 1000.0 / nValue, checkSum) << std::endl;
+}
+
+// 사용자 함수 등록 벤치마크
+// 같은 AST를 서로 다른 스크립트 이름으로 등록해서 두 방식의 결과 map을 비교한다.
+void BenchmarkRegisterFunction(const size_t scriptKB, const int nRepeat)
+{
+	const std::wstring strScript = MakeBenchmarkScript(scriptKB * 1024);
+	const std::string strUtf8 = WideToUtf8(strScript);
+
+	DSLManager* pManager = DSLManager::GetInstance();
+	pManager->SetQuiet(true);
+
+	ParserContext& context = ParserContext::GetThreadInstance();
+	const ASTPtr spAST = context.Parse(std::string_view(strUtf8));
+	if (!spAST)
+	{
+		std::wcout << L"[register] parse failed" << std::endl;
+		return;
+	}
+	const std::vector<FunctionDefinitionCPtr> functions = context.GetLastFunctions();
+
+	// AST 순회로 함수를 모은 결과와 파서가 기록한 결과는 순서까지 같아야 한다.
+	std::vector<FunctionDefinitionCPtr> walkedFunctions;
+	spAST->Iterate([&walkedFunctions](const BaseCPtr& spBase)
+		{
+			if (spBase && EASTType::FunctionDefinition == spBase->GetType())
+				walkedFunctions.push_back(static_pointer_cast<const FunctionDefinition>(spBase));
+		});
+	const bool bSameOrder = walkedFunctions == functions;
+
+	double walkUs = 0.0;
+	double batchUs = 0.0;
+	for (int i = 0; i < nRepeat; ++i)
+	{
+		const std::wstring walkName = std::format(L"register_walk_{}", i);
+		const std::wstring batchName = std::format(L"register_batch_{}", i);
+
+		BenchClock::time_point start = BenchClock::now();
+		pManager->AddASTFunction(walkName, spAST);
+		walkUs += elapsedUs(start);
+
+		start = BenchClock::now();
+		pManager->AddASTFunctions(batchName, functions);
+		batchUs += elapsedUs(start);
+	}
+
+	// 두 방식이 같은 함수를 등록했는지 확인한다.
+	bool bIdentical = pManager->GetASTFunctionCount(L"register_walk_0") == pManager->GetASTFunctionCount(L"register_batch_0");
+	for (const FunctionDefinitionCPtr& spFunctionDefinition : functions)
+	{
+		const SymbolId funcId = NodeCast<Name>(spFunctionDefinition->name)->id;
+		bIdentical = bIdentical && pManager->GetASTFunction(L"register_walk_0", funcId) == pManager->GetASTFunction(L"register_batch_0", funcId);
+	}
+
+	std::wcout << std::format(L"[register] script={:.1f}KB, functions={}, same order as AST walk={}, identical map={}", strUtf8.size() / 1024.0, functions.size(), bSameOrder, bIdentical) << std::endl;
+	std::wcout << std::format(L"  AddASTFunction(AST walk) {:.3f}ms, AddASTFunctions(parser list) {:.3f}ms per script (x{:.1f})", walkUs / 1000.0 / nRepeat, batchUs / 1000.0 / nRepeat, walkUs / (std::max)(batchUs, 1e-3)) << std::endl;
+}
+
+// 노드 아레나 벤치마크
+void BenchmarkNodeArena(const size_t scriptKB, const int nRepeat)
+{
+	const std::string strUtf8 = WideToUtf8(MakeBenchmarkScript(scriptKB * 1024));
+	const int repeatCount = (std::max)(nRepeat, 1);
+
+	ParserContext& context = ParserContext::GetThreadInstance();
+	const bool bPrevNodeArena = context.IsNodeArena();
+
+	struct Result
+	{
+		double parseUs = 0.0;
+		double teardownUs = 0.0;
+		size_t allocationCount = 0;
+		size_t allocationBytes = 0;
+		size_t nodeCount = 0;
+		ParseStats stats;
+	};
+
+	auto run = [&](const bool bNodeArena)
+	{
+		Result result;
+		context.SetNodeArena(bNodeArena);
+		for (int i = 0; i < repeatCount; ++i)
+		{
+			ASTPtr spAST;
+			{
+				BenchTraceMute mute;
+				const size_t allocationCount = GetThreadAllocationCount();
+				const size_t allocationBytes = GetThreadAllocationBytes();
+				const BenchClock::time_point start = BenchClock::now();
+				spAST = context.Parse(std::string_view(strUtf8));
+				result.parseUs += elapsedUs(start);
+				result.allocationCount += GetThreadAllocationCount() - allocationCount;
+				result.allocationBytes += GetThreadAllocationBytes() - allocationBytes;
+			}
+			if (!spAST)
+				return result;
+
+			// 파서 컨텍스트가 보관하는 함수 목록도 노드를 참조하므로 먼저 비운다.
+			context.TakeLastFunctions();
+			result.stats = context.GetLastStats();
+			result.nodeCount = 0;
+			spAST->Iterate([&result](const BaseCPtr& spBase) { if (spBase) ++result.nodeCount; });
+
+			const BenchClock::time_point start = BenchClock::now();
+			spAST.reset();
+			result.teardownUs += elapsedUs(start);
+		}
+		return result;
+	};
+
+	const Result heap = run(false);
+	const Result arena = run(true);
+	context.SetNodeArena(bPrevNodeArena);
+
+	std::wcout << std::format(L"[arena] script={:.1f}KB, nodes heap={} arena={}, x{}", strUtf8.size() / 1024.0, heap.nodeCount, arena.nodeCount, repeatCount) << std::endl;
+	auto print = [repeatCount](const wchar_t* name, const Result& result)
+	{
+		// 할당 수는 DSL_BENCH_ALLOC_COUNT 빌드에서만 센다.
+		const std::wstring strAllocations = IsAllocationCountEnabled()
+			? std::format(L"{} ({:.1f}KB)", result.allocationCount / repeatCount, result.allocationBytes / 1024.0 / repeatCount)
+			: std::wstring(L"not counted");
+		std::wcout << std::format(L"  {} parse {:.3f}ms, teardown {:.3f}ms, allocations {}",
+			name, result.parseUs / 1000.0 / repeatCount, result.teardownUs / 1000.0 / repeatCount, strAllocations) << std::endl;
+	};
+	print(L"heap ", heap);
+	print(L"arena", arena);
+	std::wcout << std::format(L"  arena used {:.1f}KB, reserved {:.1f}KB", arena.stats.arenaUsedBytes / 1024.0, arena.stats.arenaReservedBytes / 1024.0) << std::endl;
+}
+
+// 평탄화한 AST 벤치마크
+void BenchmarkFlatAST(const size_t scriptKB, const int nRepeat)
+{
+	const std::string strUtf8 = WideToUtf8(MakeBenchmarkScript(scriptKB * 1024));
+	const int repeatCount = (std::max)(nRepeat, 1);
+
+	ParserContext& context = ParserContext::GetThreadInstance();
+	ASTPtr spAST;
+	{
+		BenchTraceMute mute;
+		spAST = context.Parse(std::string_view(strUtf8));
+	}
+	if (!spAST)
+	{
+		std::wcout << L"[flat] parse failed" << std::endl;
+		return;
+	}
+	const ParseStats stats = context.GetLastStats();
+
+	BenchClock::time_point start = BenchClock::now();
+	const FlatASTPtr spFlat = FlattenAST(spAST);
+	const double flattenUs = elapsedUs(start);
+
+	// 두 표현의 노드 순서가 같은지 확인한다. 트리의 Iterate는 루트를 방문하지 않으므로 1번 노드부터 비교한다.
+	std::vector<EASTType> treeKinds;
+	spAST->Iterate([&treeKinds](const BaseCPtr& spBase)
+		{
+			if (spBase)
+				treeKinds.push_back(spBase->GetType());
+		});
+	bool bSameOrder = treeKinds.size() + 1 == spFlat->GetNodeCount();
+	for (size_t i = 0; bSameOrder && i < treeKinds.size(); ++i)
+		bSameOrder = treeKinds[i] == spFlat->GetKind(static_cast<FlatNodeIndex>(i + 1));
+
+	// 모든 노드 방문: 노드 종류별 수를 센다.
+	// 숫자 평가: 모든 숫자 리터럴 값을 더한다. 트리는 노드를 타입 변환해서 값을 읽고, 평탄화한 AST는 값 테이블을 읽는다.
+	std::array<size_t, static_cast<size_t>(EASTType::For) + 1> treeCounts{};
+	std::array<size_t, static_cast<size_t>(EASTType::For) + 1> flatCounts{};
+	double treeSum = 0.0;
+	double flatSum = 0.0;
+	double treeWalkUs = 0.0;
+	double flatWalkUs = 0.0;
+	for (int n = 0; n < repeatCount; ++n)
+	{
+		start = BenchClock::now();
+		spAST->Iterate([&treeCounts, &treeSum](const BaseCPtr& spBase)
+			{
+				if (!spBase)
+					return;
+				++treeCounts[static_cast<size_t>(spBase->GetType())];
+				if (EASTType::Numeral == spBase->GetType())
+				{
+					const Numeral& numeral = static_cast<const Numeral&>(*spBase);
+					treeSum += numeral.isInteger ? static_cast<double>(numeral.intValue) : numeral.floatValue;
+				}
+			});
+		treeWalkUs += elapsedUs(start);
+
+		start = BenchClock::now();
+		const FlatAST& flat = *spFlat;
+		flat.ForEach([&flat, &flatCounts, &flatSum](const FlatNodeIndex index)
+			{
+				++flatCounts[static_cast<size_t>(flat.GetKind(index))];
+				if (EASTType::Numeral == flat.GetKind(index))
+				{
+					const NumeralValue& numeral = flat.GetNumeral(index);
+					flatSum += numeral.isInteger ? static_cast<double>(numeral.intValue) : numeral.floatValue;
+				}
+			});
+		flatWalkUs += elapsedUs(start);
+	}
+	flatCounts[static_cast<size_t>(EASTType::AST)] -= repeatCount;
+	const bool bSameResult = treeCounts == flatCounts && treeSum == flatSum;
+
+	std::wcout << std::format(L"[flat] script={:.1f}KB, nodes={}, same order as AST walk={}, same result={}", strUtf8.size() / 1024.0, spFlat->GetNodeCount(), bSameOrder, bSameResult) << std::endl;
+	std::wcout << std::format(L"  flatten {:.3f}ms, tree nodes {:.1f}KB (arena), flat {:.1f}KB", flattenUs / 1000.0, stats.arenaUsedBytes / 1024.0, spFlat->GetMemoryBytes() / 1024.0) << std::endl;
+	std::wcout << std::format(L"  walk + numeral sum x{}: tree Iterate {:.3f}ms, flat ForEach {:.3f}ms (x{:.1f})",
+		repeatCount, treeWalkUs / 1000.0 / repeatCount, flatWalkUs / 1000.0 / repeatCount, treeWalkUs / (std::max)(flatWalkUs, 1e-3)) << std::endl;
+}
+
+// Environment와 같은 방식의 노드 분기. 노드 타입으로 분기한 다음 shared_ptr를 실제 타입으로 변환해서 값을 읽는다.
+static size_t castDispatch(const BaseCPtr& spBase)
+{
+	switch (spBase->GetType())
+	{
+	case EASTType::Name:
+	{
+		const NameCPtr& spName = static_pointer_cast<const Name>(spBase);
+		return spName->id;
+	}
+	case EASTType::Numeral:
+	{
+		const NumeralCPtr& spNumeral = static_pointer_cast<const Numeral>(spBase);
+		return static_cast<size_t>(spNumeral->intValue);
+	}
+	case EASTType::LiteralString:
+	{
+		const LiteralStringCPtr& spLiteralString = static_pointer_cast<const LiteralString>(spBase);
+		return spLiteralString->value->size();
+	}
+	case EASTType::Block:
+	{
+		const BlockCPtr& spBlock = static_pointer_cast<const Block>(spBase);
+		return spBlock->statements.size();
+	}
+	case EASTType::Assignment:
+	{
+		const AssignmentCPtr& spAssignment = static_pointer_cast<const Assignment>(spBase);
+		return spAssignment->expression ? 2 : 1;
+	}
+	case EASTType::BinaryExpression:
+	{
+		const BinaryExpressionCPtr& spBinaryExpression = static_pointer_cast<const BinaryExpression>(spBase);
+		return static_cast<size_t>(spBinaryExpression->binaryOperator);
+	}
+	case EASTType::UnaryExpression:
+	{
+		const UnaryExpressionCPtr& spUnaryExpression = static_pointer_cast<const UnaryExpression>(spBase);
+		return static_cast<size_t>(spUnaryExpression->unaryOperator);
+	}
+	case EASTType::ExpressionList:
+	{
+		const ExpressionListCPtr& spExpressionList = static_pointer_cast<const ExpressionList>(spBase);
+		return spExpressionList->expressions.size();
+	}
+	case EASTType::FunctionCall:
+	{
+		const FunctionCallCPtr& spFunctionCall = static_pointer_cast<const FunctionCall>(spBase);
+		return spFunctionCall->functionArgument ? 2 : 1;
+	}
+	default:
+		return 1;
+	}
+}
+
+// 노드 분기 벤치마크
+void BenchmarkNodeDispatch(const size_t scriptKB, const int nRepeat)
+{
+	const std::string strUtf8 = WideToUtf8(MakeBenchmarkScript(scriptKB * 1024));
+	const int repeatCount = (std::max)(nRepeat, 1);
+
+	ASTPtr spAST;
+	{
+		BenchTraceMute mute;
+		spAST = ParserContext::GetThreadInstance().Parse(std::string_view(strUtf8));
+	}
+	if (!spAST)
+	{
+		std::wcout << L"[visit] parse failed" << std::endl;
+		return;
+	}
+
+	// Environment의 call stack처럼 노드를 shared_ptr로 보관한다.
+	std::vector<BaseCPtr> nodes;
+	spAST->Iterate([&nodes](const BaseCPtr& spBase)
+		{
+			if (spBase)
+				nodes.push_back(spBase);
+		});
+
+	size_t castSum = 0;
+	BenchClock::time_point start = BenchClock::now();
+	for (int n = 0; n < repeatCount; ++n)
+	{
+		for (const BaseCPtr& spBase : nodes)
+			castSum += castDispatch(spBase);
+	}
+	const double castUs = elapsedUs(start);
+
+	// castDispatch와 같은 값을 VisitNode로 읽는다.
+	auto visitor = [](const auto& node) -> size_t
+	{
+		using T = std::decay_t<decltype(node)>;
+		if constexpr (std::is_same_v<T, Name>)
+			return node.id;
+		else if constexpr (std::is_same_v<T, Numeral>)
+			return static_cast<size_t>(node.intValue);
+		else if constexpr (std::is_same_v<T, LiteralString>)
+			return node.value->size();
+		else if constexpr (std::is_same_v<T, Block>)
+			return node.statements.size();
+		else if constexpr (std::is_same_v<T, Assignment>)
+			return node.expression ? 2 : 1;
+		else if constexpr (std::is_same_v<T, BinaryExpression>)
+			return static_cast<size_t>(node.binaryOperator);
+		else if constexpr (std::is_same_v<T, UnaryExpression>)
+			return static_cast<size_t>(node.unaryOperator);
+		else if constexpr (std::is_same_v<T, ExpressionList>)
+			return node.expressions.size();
+		else if constexpr (std::is_same_v<T, FunctionCall>)
+			return node.functionArgument ? 2 : 1;
+		else
+			return 1;
+	};
+
+	size_t visitSum = 0;
+	start = BenchClock::now();
+	for (int n = 0; n < repeatCount; ++n)
+	{
+		for (const BaseCPtr& spBase : nodes)
+			visitSum += VisitNode(*spBase, visitor);
+	}
+	const double visitUs = elapsedUs(start);
+
+	std::wcout << std::format(L"[visit] script={:.1f}KB, nodes={}, x{}, same result={}", strUtf8.size() / 1024.0, nodes.size(), repeatCount, castSum == visitSum) << std::endl;
+	std::wcout << std::format(L"  GetType + static_pointer_cast {:.3f}ms ({:.2f}ns/node), VisitNode {:.3f}ms ({:.2f}ns/node) (x{:.1f})",
+		castUs / 1000.0 / repeatCount, castUs * 1000.0 / repeatCount / nodes.size(),
+		visitUs / 1000.0 / repeatCount, visitUs * 1000.0 / repeatCount / nodes.size(), castUs / (std::max)(visitUs, 1e-3)) << std::endl;
+}
+
+// AST 순회 벤치마크
+void BenchmarkWalkAST(const size_t scriptKB, const int nRepeat)
+{
+	const std::string strUtf8 = WideToUtf8(MakeBenchmarkScript(scriptKB * 1024));
+	const int repeatCount = (std::max)(nRepeat, 1);
+
+	ASTPtr spAST;
+	{
+		BenchTraceMute mute;
+		spAST = ParserContext::GetThreadInstance().Parse(std::string_view(strUtf8));
+	}
+	if (!spAST)
+	{
+		std::wcout << L"[walk] parse failed" << std::endl;
+		return;
+	}
+
+	// 1. 모든 노드를 방문해서 노드 수와 숫자 리터럴 값의 합을 구한다.
+	size_t iterateCount = 0;
+	int64_t iterateSum = 0;
+	BenchClock::time_point start = BenchClock::now();
+	for (int n = 0; n < repeatCount; ++n)
+	{
+		iterateCount = 0;
+		iterateSum = 0;
+		spAST->Iterate([&iterateCount, &iterateSum](const BaseCPtr& spBase)
+			{
+				if (!spBase)
+					return;
+
+				++iterateCount;
+				if (EASTType::Numeral == spBase->GetType())
+					iterateSum += static_cast<int64_t>(static_cast<const Numeral&>(*spBase).intValue);
+			});
+	}
+	const double iterateUs = elapsedUs(start);
+
+	size_t walkCount = 0;
+	int64_t walkSum = 0;
+	start = BenchClock::now();
+	for (int n = 0; n < repeatCount; ++n)
+	{
+		walkCount = 0;
+		walkSum = 0;
+		WalkAST(*spAST, [&walkCount, &walkSum](const auto& node)
+			{
+				++walkCount;
+				if constexpr (std::is_same_v<std::decay_t<decltype(node)>, Numeral>)
+					walkSum += static_cast<int64_t>(node.intValue);
+			});
+	}
+	const double walkUs = elapsedUs(start);
+
+	// 2. 사용자 함수를 모은다. (DSLManager::collectASTFunction)
+	// 함수는 구문으로만 정의하므로 WalkAST는 표현식의 하위 트리를 건너뛴다.
+	std::vector<FunctionDefinitionCPtr> iterateFunctions;
+	start = BenchClock::now();
+	for (int n = 0; n < repeatCount; ++n)
+	{
+		iterateFunctions.clear();
+		spAST->Iterate([&iterateFunctions](const BaseCPtr& spBase)
+			{
+				if (spBase && EASTType::FunctionDefinition == spBase->GetType())
+					iterateFunctions.push_back(std::static_pointer_cast<const FunctionDefinition>(spBase));
+			});
+	}
+	const double iterateFunctionUs = elapsedUs(start);
+
+	std::vector<FunctionDefinitionCPtr> walkFunctions;
+	start = BenchClock::now();
+	for (int n = 0; n < repeatCount; ++n)
+	{
+		walkFunctions.clear();
+		WalkAST(spAST, [&walkFunctions](const auto& node, const auto& spNode)
+			{
+				using T = std::decay_t<decltype(node)>;
+				if constexpr (std::is_same_v<T, FunctionDefinition>)
+					walkFunctions.push_back(std::static_pointer_cast<const FunctionDefinition>(spNode));
+
+				if constexpr (std::is_same_v<T, Expression> || std::is_same_v<T, ExpressionList> || std::is_same_v<T, FunctionCall>)
+					return EVisitResult::SkipChildren;
+				else
+					return EVisitResult::Continue;
+			});
+	}
+	const double walkFunctionUs = elapsedUs(start);
+
+	// 3. 조건을 만족하는 첫 노드를 찾는다. Iterate는 중간에 멈출 수 없으므로 항상 모든 노드를 방문한다.
+	const std::wstring strLastName = walkFunctions.empty() ? std::wstring() : NodeCast<Name>(walkFunctions.back()->name)->GetName();
+	const SymbolId lastId = walkFunctions.empty() ? InvalidSymbolId : NodeCast<Name>(walkFunctions.back()->name)->id;
+
+	FunctionDefinitionCPtr spIterateFound;
+	start = BenchClock::now();
+	for (int n = 0; n < repeatCount; ++n)
+	{
+		spIterateFound = nullptr;
+		spAST->Iterate([&spIterateFound, lastId](const BaseCPtr& spBase)
+			{
+				if (spIterateFound || !spBase || EASTType::FunctionDefinition != spBase->GetType())
+					return;
+
+				FunctionDefinitionCPtr spFunction = std::static_pointer_cast<const FunctionDefinition>(spBase);
+				if (NodeCast<Name>(spFunction->name)->id == lastId)
+					spIterateFound = std::move(spFunction);
+			});
+	}
+	const double iterateFindUs = elapsedUs(start);
+
+	FunctionDefinitionCPtr spWalkFound;
+	size_t walkFindCount = 0;
+	start = BenchClock::now();
+	for (int n = 0; n < repeatCount; ++n)
+	{
+		spWalkFound = nullptr;
+		walkFindCount = 0;
+		WalkAST(spAST, [&spWalkFound, &walkFindCount, lastId](const auto& node, const auto& spNode)
+			{
+				++walkFindCount;
+				using T = std::decay_t<decltype(node)>;
+				if constexpr (std::is_same_v<T, FunctionDefinition>)
+				{
+					if (NodeCast<Name>(node.name)->id != lastId)
+						return EVisitResult::SkipChildren;
+
+					spWalkFound = std::static_pointer_cast<const FunctionDefinition>(spNode);
+					return EVisitResult::Stop;
+				}
+				else if constexpr (std::is_same_v<T, Expression> || std::is_same_v<T, ExpressionList> || std::is_same_v<T, FunctionCall>)
+					return EVisitResult::SkipChildren;
+				else
+					return EVisitResult::Continue;
+			});
+	}
+	const double walkFindUs = elapsedUs(start);
+
+	// Iterate는 루트 노드를 방문하지 않는다.
+	std::wcout << std::format(L"[walk] script={:.1f}KB, nodes={}, functions={}, x{}", strUtf8.size() / 1024.0, walkCount, walkFunctions.size(), repeatCount) << std::endl;
+	std::wcout << std::format(L"  count + numeral sum: Iterate {:.3f}ms, WalkAST {:.3f}ms (x{:.1f}), same result={}",
+		iterateUs / 1000.0 / repeatCount, walkUs / 1000.0 / repeatCount, iterateUs / (std::max)(walkUs, 1e-3),
+		iterateCount + 1 == walkCount && iterateSum == walkSum) << std::endl;
+	std::wcout << std::format(L"  collect functions: Iterate {:.3f}ms, WalkAST + SkipChildren {:.3f}ms (x{:.1f}), same result={}",
+		iterateFunctionUs / 1000.0 / repeatCount, walkFunctionUs / 1000.0 / repeatCount, iterateFunctionUs / (std::max)(walkFunctionUs, 1e-3),
+		iterateFunctions.size() == walkFunctions.size()) << std::endl;
+	std::wcout << std::format(L"  find function '{}': Iterate {:.3f}ms, WalkAST + Stop {:.3f}ms (x{:.1f}, {} nodes visited), same result={}",
+		strLastName, iterateFindUs / 1000.0 / repeatCount, walkFindUs / 1000.0 / repeatCount, iterateFindUs / (std::max)(walkFindUs, 1e-3),
+		walkFindCount, spIterateFound == spWalkFound) << std::endl;
+}
+
+// 연산자 벤치마크용 분기. 이전처럼 노드의 연산자 문자열을 Environment와 같은 순서로 비교한다.
+// 연산자 문자열은 GetOperatorName으로 읽는다. (노드의 std::wstring 멤버를 읽던 것과 같은 비용)
+struct OperatorStringDispatch
+{
+	static __int64 Binary(const EOperator eOperator, const __int64 left, const __int64 right)
+	{
+		const std::wstring& strOperator = GetOperatorName(eOperator);
+		if (L"*" == strOperator)
+			return left * right;
+		else if (L"/" == strOperator)
+			return 0 != right ? left / right : 0;
+		else if (L"%" == strOperator)
+			return 0 != right ? left % right : 0;
+		else if (L"+" == strOperator)
+			return left + right;
+		else if (L"-" == strOperator)
+			return left - right;
+		else if (L"<" == strOperator)
+			return left < right;
+		else if (L">" == strOperator)
+			return left > right;
+		else if (L"<=" == strOperator)
+			return left <= right;
+		else if (L">=" == strOperator)
+			return left >= right;
+		else if (L"==" == strOperator)
+			return left == right;
+		else if (L"!=" == strOperator)
+			return left != right;
+		else if (L"and" == strOperator)
+			return left && right;
+		else if (L"or" == strOperator)
+			return left || right;
+
+		return 0;
+	}
+
+	static __int64 Unary(const EOperator eOperator, const __int64 value)
+	{
+		const std::wstring& strOperator = GetOperatorName(eOperator);
+		if (L"not" == strOperator)
+			return !value;
+		else if (L"-" == strOperator)
+			return -value;
+
+		return 0;
+	}
+};
+
+// 연산자 벤치마크용 분기. Environment처럼 연산자 코드로 switch 한다.
+struct OperatorCodeDispatch
+{
+	static __int64 Binary(const EOperator eOperator, const __int64 left, const __int64 right)
+	{
+		switch (eOperator)
+		{
+		case EOperator::Mul:			return left * right;
+		case EOperator::Div:			return 0 != right ? left / right : 0;
+		case EOperator::Mod:			return 0 != right ? left % right : 0;
+		case EOperator::Add:			return left + right;
+		case EOperator::Sub:			return left - right;
+		case EOperator::Less:			return left < right;
+		case EOperator::Greater:		return left > right;
+		case EOperator::LessEqual:		return left <= right;
+		case EOperator::GreaterEqual:	return left >= right;
+		case EOperator::Equal:			return left == right;
+		case EOperator::NotEqual:		return left != right;
+		case EOperator::And:			return left && right;
+		case EOperator::Or:				return left || right;
+		default:						return 0;
+		}
+	}
+
+	static __int64 Unary(const EOperator eOperator, const __int64 value)
+	{
+		switch (eOperator)
+		{
+		case EOperator::Not:	return !value;
+		case EOperator::Neg:	return -value;
+		default:				return 0;
+		}
+	}
+};
+
+// 연산자 벤치마크용 식 계산. 값은 정수로 계산하고, 0으로 나누면 0으로 계산한다.
+// 이름은 심볼 ID로 정한 값을 사용하고, 함수 호출 등 연산자 식이 아닌 노드는 1로 계산한다.
+template <typename Dispatch>
+static __int64 evaluateOperator(const Base* pNode, size_t& opCount)
+{
+	if (!pNode)
+		return 0;
+
+	switch (pNode->GetType())
+	{
+	case EASTType::Expression:
+		return evaluateOperator<Dispatch>(static_cast<const Expression*>(pNode)->expression.get(), opCount);
+	case EASTType::PrimaryExpression:
+		return evaluateOperator<Dispatch>(static_cast<const PrimaryExpression*>(pNode)->primaryExpression.get(), opCount);
+	case EASTType::Numeral:
+	{
+		const Numeral* pNumeral = static_cast<const Numeral*>(pNode);
+		return pNumeral->isInteger ? pNumeral->intValue : static_cast<__int64>(pNumeral->floatValue);
+	}
+	case EASTType::Boolean:
+		return static_cast<const Boolean*>(pNode)->value ? 1 : 0;
+	case EASTType::Name:
+		return static_cast<__int64>(static_cast<const Name*>(pNode)->id % 7) + 1;
+	case EASTType::BinaryExpression:
+	{
+		const BinaryExpression* pBinaryExpression = static_cast<const BinaryExpression*>(pNode);
+		const __int64 left = evaluateOperator<Dispatch>(pBinaryExpression->primaryExpression1.get(), opCount);
+		const __int64 right = evaluateOperator<Dispatch>(pBinaryExpression->primaryExpression2.get(), opCount);
+		++opCount;
+		return Dispatch::Binary(pBinaryExpression->binaryOperator, left, right);
+	}
+	case EASTType::UnaryExpression:
+	{
+		const UnaryExpression* pUnaryExpression = static_cast<const UnaryExpression*>(pNode);
+		const __int64 value = evaluateOperator<Dispatch>(pUnaryExpression->primaryExpression.get(), opCount);
+		++opCount;
+		return Dispatch::Unary(pUnaryExpression->unaryOperator, value);
+	}
+	default:
+		return 1;
+	}
+}
+
+// 연산자 벤치마크
+// Environment.cpp는 이 트리에서 빌드되지 않으므로 Environment와 같은 방식으로 연산자를 분기하는 식 계산기로 측정한다.
+void BenchmarkOperator(const int nStatement, const int nRepeat)
+{
+	// 산술 연산자가 많은 식. 비교, 논리, 단항 연산자를 섞는다.
+	static const wchar_t* const operators[] = { L"+", L"*", L"-", L"%", L"+", L"/", L"*", L"-", L"<", L"+", L"==", L"*", L"and", L"-", L">=", L"or" };
+	constexpr size_t nOperator = sizeof(operators) / sizeof(operators[0]);
+	constexpr int nTerm = 16;
+
+	std::wstring strScript;
+	for (int line = 0; line < nStatement; ++line)
+	{
+		strScript += std::format(L"v{} = a", line);
+		for (int term = 1; term < nTerm; ++term)
+		{
+			const int value = (line * 31 + term * 17) % 97 + 1;
+			std::wstring strTerm;
+			switch (term % 5)
+			{
+			case 1:		strTerm = std::format(L"{}", value); break;
+			case 2:		strTerm = std::format(L"(b {} {})", operators[(line + term + 1) % nOperator], value); break;
+			case 3:		strTerm = std::format(L"-c{}", value % 4); break;
+			default:	strTerm = std::format(L"d{}", value % 8); break;
+			}
+			strScript += std::format(L" {} {}", operators[(line + term) % nOperator], strTerm);
+		}
+		strScript += L"\n";
+	}
+
+	const std::string strUtf8 = WideToUtf8(strScript);
+	const int repeatCount = (std::max)(nRepeat, 1);
+
+	ASTPtr spAST;
+	{
+		BenchTraceMute mute;
+		spAST = ParserContext::GetThreadInstance().Parse(std::string_view(strUtf8));
+	}
+	if (!spAST)
+	{
+		std::wcout << L"[operator] parse failed" << std::endl;
+		return;
+	}
+
+	// 할당문의 오른쪽 식
+	std::vector<const Base*> expressions;
+	spAST->Iterate([&expressions](const BaseCPtr& spBase)
+		{
+			if (spBase && EASTType::Assignment == spBase->GetType())
+				expressions.push_back(static_cast<const Assignment&>(*spBase).expression.get());
+		});
+
+	auto measure = [&](auto evaluate, __int64& sum, size_t& opCount)
+	{
+		double bestUs = (std::numeric_limits<double>::max)();
+		for (int n = 0; n < repeatCount; ++n)
+		{
+			sum = 0;
+			opCount = 0;
+			const BenchClock::time_point start = BenchClock::now();
+			for (const Base* pExpression : expressions)
+				sum += evaluate(pExpression, opCount);
+			bestUs = (std::min)(bestUs, elapsedUs(start));
+		}
+		return bestUs;
+	};
+
+	__int64 stringSum = 0;
+	__int64 codeSum = 0;
+	size_t stringOpCount = 0;
+	size_t codeOpCount = 0;
+	const double stringUs = measure(evaluateOperator<OperatorStringDispatch>, stringSum, stringOpCount);
+	const double codeUs = measure(evaluateOperator<OperatorCodeDispatch>, codeSum, codeOpCount);
+
+	std::wcout << std::format(L"[operator] script={:.1f}KB, expressions={}, operations={}, best of {}, same result={}",
+		strUtf8.size() / 1024.0, expressions.size(), codeOpCount, repeatCount, stringSum == codeSum && stringOpCount == codeOpCount) << std::endl;
+	std::wcout << std::format(L"  string compare {:.3f}ms ({:.2f}ns/op), opcode switch {:.3f}ms ({:.2f}ns/op) (x{:.2f})",
+		stringUs / 1000.0, stringUs * 1000.0 / (std::max<size_t>)(stringOpCount, 1),
+		codeUs / 1000.0, codeUs * 1000.0 / (std::max<size_t>)(codeOpCount, 1), stringUs / (std::max)(codeUs, 1e-3)) << std::endl;
+}
+
+// 프로세스의 최대 메모리 사용량
+size_t GetPeakMemoryUsage()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return counters.PeakWorkingSetSize;
+#else
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line))
+	{
+		if (line.starts_with("VmHWM:"))
+			return static_cast<size_t>(std::stoull(line.substr(6))) * 1024;
+	}
+	return 0;
+#endif
+}
+
+// 벤치마크용 스크립트 생성
+std::wstring MakeBenchmarkScript(const size_t targetLength)
+{
+	std::wstring strScript;
+	strScript.reserve(targetLength + 256);
+
+	for (size_t i = 0; strScript.size() < targetLength; ++i)
+	{
+		strScript += std::format(L"-- generated block {}\n", i);
+		strScript += std::format(L"function func{}(a, b, c)\n", i);
+		strScript += std::format(L"    value{} = a * 2 + (b - c) / 3 % 7\n", i);
+		strScript += std::format(L"    if value{} >= 10 and not flag or b != c then\n", i);
+		strScript += std::format(L"        Print(\"message {}\", value{}, 3.25)\n", i, i);
+		strScript += L"    end\n";
+		strScript += L"end\n";
+		strScript += std::format(L"result{} = func{}({}, counter, -{}) == {}\n", i, i, i, i % 13, i * 3);
+	}
+
+	return strScript;
+}
+
+}
@@ -0,0 +1,105 @@
+﻿#pragma once
+
+namespace dsl
+{
+
+	// 벤치마크 실행
+	// @args	: args[0]은 벤치마크 이름, 나머지는 벤치마크별 인자
+	// @return	: 프로세스 종료 코드
+	int RunBenchmark(const std::vector<std::wstring>& args);
+
+	// 파서 준비시간 벤치마크. 매번 grammar를 생성하는 방식과 컨텍스트를 재사용하는 방식을 비교한다.
+	void BenchmarkParserSetup(const int nIteration);
+
+	// 파싱 처리량 벤치마크. Spirit Qi grammar, Spirit X3 grammar, 렉서+토큰 파서의 MB/s를 비교한다.
+	// X3 grammar가 Qi grammar와 같은 AST를 만드는지도 확인한다.
+	void BenchmarkParseThroughput(const size_t scriptKB);
+
+	// rule 프로파일 벤치마크. 약 scriptKB 크기의 스크립트를 Spirit 백엔드로 파싱하면서 rule별 시도, 성공, 백트래킹 횟수와 시간을 출력한다.
+	// 프로파일 모드가 아닐 때의 처리량과 비교한다.
+	void BenchmarkProfile(const size_t scriptKB);
+
+	// 스캔 벤치마크. 주석, 문자열, 공백, 긴 이름이 많은 스크립트를 스캔 명령어 집합별로 토큰화하고 MB/s를 비교한다.
+	void BenchmarkScan(const size_t scriptMB);
+
+	// 표현식 파싱 벤치마크. 항이 많은 평평한 식과 깊게 중첩된 식을 Cascade/Precedence 방식으로 각각 파싱하고 비교한다.
+	void BenchmarkExpression(const int nTerm);
+
+	// 숫자 리터럴 벤치마크. 숫자가 많은 데이터 스크립트에서 qi::double_ 우선 변환과 ScanNumeral 변환을 비교한다.
+	void BenchmarkNumeral(const size_t scriptKB);
+
+	// 스크립트 로드 벤치마크. count개의 스크립트 파일을 로드하고 로드시간과 최대 메모리 사용량을 출력한다.
+	// 최대 메모리 사용량은 프로세스 단위이므로 한 프로세스에서 한 가지 방식만 측정한다.
+	//   wifstream : 기존 방식. wifstream + locale 변환으로 wchar_t 문자열을 만든 다음 파싱한다.
+	//   mmap      : DSLManager::LoadScript. 파일을 매핑해서 UTF-8 그대로 파싱한다.
+	//   lazy      : mmap과 같지만 함수 본문은 파싱하지 않고 소스 범위만 기록한다.
+	void BenchmarkScriptLoad(const std::wstring& mode, const int count);
+
+	// 병렬 로드 벤치마크. DSLManager::LoadScripts의 스레드 수를 1부터 maxThreads까지 2배씩 늘리면서 로드시간을 비교한다.
+	void BenchmarkLoadScripts(const int count, const int maxThreads);
+
+	// AST 캐시 벤치마크. count개의 스크립트 파일을 nThread개의 스레드로 파싱해서 로드한 시간과, AST 캐시 파일(.dslc)로 로드한 시간을 비교한다.
+	// 캐시로 만든 AST가 파싱한 AST와 같은지, 스크립트와 맞지 않는 캐시를 사용하지 않는지 확인한다.
+	// @bLazyFunctionBody	: DSLManager의 지연 파싱 모드
+	void BenchmarkASTCache(const int count, const int nThread, const bool bLazyFunctionBody);
+
+	// 노드 공유 벤치마크. count개의 스크립트 파일을 노드를 공유하지 않고 로드한 경우와 공유하면서 로드한 경우의
+	// 노드 수, 서로 다른 노드 수, 아레나 크기, 로드시간을 비교하고, 공유한 AST가 원래 AST와 같은지 확인한다.
+	// 같은 파일들을 공유 모드로 다시 로드하는 경우(이전 AST의 노드를 공유)도 측정한다.
+	void BenchmarkShareAST(const int count, const int nThread, const bool bLazyFunctionBody);
+
+	// 정규화 벤치마크. 로드 벤치마크와 같은 count개의 파일을 nThread개의 스레드로 정규화하지 않고, 정규화하면서 로드한다.
+	// 노드 수와 Environment가 call stack에 넣는 실행 단계 수, 노드 공유 모드의 아레나 크기를 비교하고, 래퍼 노드를 제외한 모양이 같은지 확인한다.
+	void BenchmarkNormalizeAST(const int count, const int nThread);
+
+	// 스트리밍 파싱 벤치마크. 큰 데이터 테이블 스크립트를 한 번에 파싱하는 방식과 구문 단위로 스트리밍 파싱하는 방식을 비교한다.
+	// 최대 메모리 사용량을 비교하기 위해 한 프로세스에서 한 가지 방식만 측정한다.
+	//   whole  : 파일을 매핑해서 전체를 파싱하고 AST를 보관한다.
+	//   stream : StreamParser로 파싱하고, 구문은 콜백에서 바로 버린다.
+	void BenchmarkStreamParse(const std::wstring& mode, const size_t scriptMB);
+
+	// hot reload 벤치마크. 약 scriptKB 크기의 스크립트를 여러 방식으로 수정하고, ReloadScript와 전체 LoadScript의 시간을 비교한다.
+	void BenchmarkReload(const size_t scriptKB);
+
+	// 지연 파싱 벤치마크. 약 scriptKB 크기의 스크립트를 바로 파싱한 경우와 함수 본문을 지연 파싱한 경우의 로드시간을 비교한다.
+	// nThread개의 스레드가 동시에 모든 함수를 GetASTFunction으로 찾으면서, 본문을 한 번만 파싱하는지와 결과가 같은지 확인한다.
+	void BenchmarkLazyFunction(const size_t scriptKB, const int nThread);
+
+	// 심볼 벤치마크. 약 scriptKB 크기의 스크립트를 로드하고 Name 노드가 문자열 대신 심볼 ID를 가져서 줄어든 메모리를 출력한다.
+	// 모든 함수를 nLookup번씩 이름(std::wstring)과 심볼 ID로 찾는 시간을 비교한다.
+	void BenchmarkSymbol(const size_t scriptKB, const int nLookup);
+
+	// 상수 풀 벤치마크. 약 scriptKB 크기의 스크립트에서 nKey 종류의 메시지 key 리터럴을 반복해서 사용한다.
+	// 중복을 제거해서 줄어든 리터럴 크기를 출력하고, 실행할 때 리터럴 값을 복사하는 방식과 버퍼를 공유하는 방식을 비교한다.
+	void BenchmarkConstantPool(const size_t scriptKB, const int nKey);
+
+	// 사용자 함수 등록 벤치마크. 약 scriptKB 크기의 스크립트를 파싱하고, AST를 순회해서 등록하는 방식과 파서가 기록한 함수 목록을 한 번에 등록하는 방식을 nRepeat번씩 비교한다.
+	void BenchmarkRegisterFunction(const size_t scriptKB, const int nRepeat);
+
+	// 노드 아레나 벤치마크. 약 scriptKB 크기의 스크립트를 노드마다 힙에 할당하는 방식과 아레나에 할당하는 방식으로 nRepeat번씩 파싱한다.
+	// 파싱 시간, 파싱 중 할당 횟수와 크기, AST를 해제하는 시간을 비교한다.
+	void BenchmarkNodeArena(const size_t scriptKB, const int nRepeat);
+
+	// 평탄화한 AST 벤치마크. 약 scriptKB 크기의 스크립트를 평탄화하고, 모든 노드를 방문해서 숫자 리터럴 값을 더하는 작업을
+	// 트리의 Iterate와 평탄화한 AST의 ForEach로 nRepeat번씩 비교한다.
+	void BenchmarkFlatAST(const size_t scriptKB, const int nRepeat);
+
+	// 노드 분기 벤치마크. 약 scriptKB 크기의 스크립트의 모든 노드를 nRepeat번씩 타입별로 분기해서 값을 읽는다.
+	// Environment처럼 GetType()으로 분기하고 shared_ptr를 변환하는 방식과 VisitNode를 비교한다.
+	void BenchmarkNodeDispatch(const size_t scriptKB, const int nRepeat);
+
+	// AST 순회 벤치마크. 약 scriptKB 크기의 스크립트에서 노드 수 세기, 사용자 함수 모으기, 이름으로 함수 찾기를
+	// std::function 콜백을 호출하는 Iterate와 템플릿 visitor를 사용하는 WalkAST로 nRepeat번씩 비교한다.
+	void BenchmarkWalkAST(const size_t scriptKB, const int nRepeat);
+
+	// 연산자 벤치마크. 산술 연산자가 많은 nStatement개의 할당문을 파싱하고, 오른쪽 식을 nRepeat번 계산해서 가장 짧은 시간을 사용한다.
+	// 연산자 문자열을 차례로 비교하는 이전 방식과 연산자 코드로 switch 하는 방식의 연산 하나당 시간을 비교한다.
+	void BenchmarkOperator(const int nStatement, const int nRepeat);
+
+	// 프로세스의 최대 메모리 사용량(bytes). Windows는 PeakWorkingSetSize, Linux는 VmHWM.
+	size_t GetPeakMemoryUsage();
+
+	// 벤치마크용 스크립트 생성. 대략 targetLength 글자가 될 때까지 함수, 할당, 주석, 함수 호출을 반복한다.
+	std::wstring MakeBenchmarkScript(const size_t targetLength);
+
+}
@@ -0,0 +1,98 @@
+﻿#include "pch.h"
+
+#include "constant_pool.h"
+
+namespace dsl
+{
+
+ConstantPool::ConstantPool()
+	: m_literalCount(0)
+	, m_pooledBytes(0)
+	, m_savedBytes(0)
+{
+}
+
+ConstantString ConstantPool::Intern(std::wstring_view str)
+{
+	std::lock_guard lock(m_lock);
+
+	++m_literalCount;
+
+	const auto iter = m_constantMap.find(str);
+	if (iter != m_constantMap.end())
+	{
+		m_savedBytes += str.size() * sizeof(wchar_t);
+		return iter->second;
+	}
+
+	ConstantString spConstant = std::make_shared<const std::wstring>(str);
+	m_constantMap.emplace(*spConstant, spConstant);
+	m_pooledBytes += str.size() * sizeof(wchar_t);
+
+	return spConstant;
+}
+
+size_t ConstantPool::GetConstantCount() const
+{
+	std::lock_guard lock(m_lock);
+	return m_constantMap.size();
+}
+
+size_t ConstantPool::GetLiteralCount() const
+{
+	std::lock_guard lock(m_lock);
+	return m_literalCount;
+}
+
+size_t ConstantPool::GetPooledBytes() const
+{
+	std::lock_guard lock(m_lock);
+	return m_pooledBytes;
+}
+
+size_t ConstantPool::GetSavedBytes() const
+{
+	std::lock_guard lock(m_lock);
+	return m_savedBytes;
+}
+
+ConstantPool::Scope::Scope(ConstantPoolPtr spPool)
+	: m_spPrevPool(std::move(current()))
+{
+	current() = std::move(spPool);
+}
+
+ConstantPool::Scope::~Scope()
+{
+	current() = std::move(m_spPrevPool);
+}
+
+const ConstantPoolPtr& ConstantPool::GetCurrent()
+{
+	return current();
+}
+
+ConstantPoolPtr& ConstantPool::current()
+{
+	static thread_local ConstantPoolPtr spCurrent;
+	return spCurrent;
+}
+
+ConstantString InternConstant(std::wstring_view str)
+{
+	if (const ConstantPoolPtr& spPool = ConstantPool::GetCurrent())
+		return spPool->Intern(str);
+
+	if (str.empty())
+		return GetEmptyConstant();
+
+	return std::make_shared<const std::wstring>(str);
+}
+
+const ConstantString& GetEmptyConstant()
+{
+	static const ConstantString spEmpty = std::make_shared<const std::wstring>();
+	return spEmpty;
+}
+
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+/*
+스크립트 상수 풀.
+문자열 리터럴을 스크립트 단위로 중복 제거한다. 같은 내용의 리터럴은 하나의 변경 불가능한 버퍼를 공유한다.
+파서는 스크립트를 파싱하는 동안 ConstantPool::Scope로 현재 스레드의 풀을 지정하고, LiteralString은 생성될 때 현재 풀에서 버퍼를 얻는다.
+따라서 Token, Spirit, SpiritX3 백엔드가 모두 같은 풀을 사용한다.
+Environment는 리터럴을 실행할 때 문자열을 복사하지 않고 버퍼를 참조한다.
+
+버퍼는 shared_ptr 이므로 풀이나 AST가 먼저 해제되더라도 참조하는 값이 남아있는 동안 유지된다.
+*/
+
+namespace dsl
+{
+	// 상수 풀의 문자열 버퍼
+	using ConstantString = std::shared_ptr<const std::wstring>;
+
+	class ConstantPool;
+	using ConstantPoolPtr = std::shared_ptr<ConstantPool>;
+	using ConstantPoolCPtr = std::shared_ptr<const ConstantPool>;
+
+
+	// 상수 풀. 지연 파싱하는 함수 본문이 여러 스레드에서 같은 풀을 사용할 수 있으므로 모든 함수는 thread-safe 하다.
+	class ConstantPool
+	{
+	public:
+		ConstantPool();
+
+		ConstantPool(const ConstantPool&) = delete;
+		ConstantPool& operator=(const ConstantPool&) = delete;
+
+	public:
+		// 문자열의 버퍼를 얻는다. 처음 보는 문자열이면 새 버퍼를 만든다.
+		ConstantString Intern(std::wstring_view str);
+
+		size_t GetConstantCount() const;	// 버퍼 수 (중복을 제거한 리터럴 수)
+		size_t GetLiteralCount() const;		// Intern을 호출한 횟수 (스크립트의 리터럴 수)
+		size_t GetPooledBytes() const;		// 버퍼의 문자열 크기 합 (bytes)
+		size_t GetSavedBytes() const;		// 중복된 리터럴이 버퍼를 공유해서 줄어든 문자열 크기 (bytes)
+
+	public:
+		// 현재 스레드의 풀을 지정한다. 소멸할 때 이전 풀로 되돌린다.
+		class Scope
+		{
+		public:
+			explicit Scope(ConstantPoolPtr spPool);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			ConstantPoolPtr m_spPrevPool;
+		};
+
+		// 현재 스레드의 풀. 지정하지 않았다면 nullptr
+		static const ConstantPoolPtr& GetCurrent();
+
+	private:
+		static ConstantPoolPtr& current();
+
+	private:
+		mutable std::mutex m_lock;
+
+		// Key=버퍼의 문자열, Value=버퍼. key는 value의 문자열을 참조한다.
+		std::unordered_map<std::wstring_view, ConstantString> m_constantMap;
+
+		size_t m_literalCount;
+		size_t m_pooledBytes;
+		size_t m_savedBytes;
+	};
+
+
+	// 현재 스레드의 풀에서 문자열의 버퍼를 얻는다. 풀이 지정되지 않았다면 공유하지 않는 버퍼를 만든다.
+	ConstantString InternConstant(std::wstring_view str);
+
+	// 빈 문자열 버퍼. 모든 스레드가 공유한다.
+	const ConstantString& GetEmptyConstant();
+}
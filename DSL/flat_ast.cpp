@@ -0,0 +1,273 @@
+﻿#include "pch.h"
+
+#include "flat_ast.h"
+
+namespace dsl
+{
+
+// 노드 종류 이름. 트리 노드의 Print와 같은 이름을 사용한다.
+static const wchar_t* getKindName(const EASTType eType)
+{
+	switch (eType)
+	{
+	case EASTType::Name:				return L"Name";
+	case EASTType::NameList:			return L"NameList";
+	case EASTType::Numeral:				return L"Numeral";
+	case EASTType::Boolean:				return L"Boolean";
+	case EASTType::LiteralString:		return L"LiteralString";
+	case EASTType::AST:					return L"AST";
+	case EASTType::Block:				return L"Block";
+	case EASTType::Assignment:			return L"Assignment";
+	case EASTType::Expression:			return L"Expression";
+	case EASTType::ExpressionList:		return L"ExpressionList";
+	case EASTType::PrimaryExpression:	return L"PrimaryExpression";
+	case EASTType::BinaryExpression:	return L"BinaryExpression";
+	case EASTType::UnaryExpression:		return L"UnaryExpression";
+	case EASTType::FunctionDefinition:	return L"FunctionDefinition";
+	case EASTType::FunctionParameter:	return L"FunctionParameter";
+	case EASTType::FunctionCall:		return L"FunctionCall";
+	case EASTType::FunctionArgument:	return L"FunctionArgument";
+	case EASTType::Statement:			return L"Statement";
+	case EASTType::Return:				return L"Return";
+	case EASTType::Break:				return L"Break";
+	case EASTType::While:				return L"While";
+	case EASTType::If:					return L"If";
+	case EASTType::For:					return L"For";
+	default:							return L"Base";
+	}
+}
+
+FlatNodeIndex FlatAST::GetChild(const FlatNodeIndex index, size_t n) const
+{
+	FlatNodeIndex child = m_firstChild[index];
+	for (; InvalidFlatNode != child && 0 < n; --n)
+		child = m_nextSibling[child];
+	return child;
+}
+
+FlatNodeIndex FlatAST::GetSubtreeEnd(const FlatNodeIndex index) const
+{
+	// 마지막 자식을 따라 내려가면 하위 트리의 마지막 노드가 나온다.
+	FlatNodeIndex last = index;
+	for (FlatNodeIndex child = m_firstChild[last]; InvalidFlatNode != child; child = m_firstChild[last])
+	{
+		last = child;
+		while (InvalidFlatNode != m_nextSibling[last])
+			last = m_nextSibling[last];
+	}
+	return last + 1;
+}
+
+size_t FlatAST::GetMemoryBytes() const
+{
+	return m_kinds.capacity() * sizeof(uint8_t)
+		+ m_operators.capacity() * sizeof(EOperator)
+		+ m_firstChild.capacity() * sizeof(FlatNodeIndex)
+		+ m_nextSibling.capacity() * sizeof(FlatNodeIndex)
+		+ m_payloads.capacity() * sizeof(uint32_t)
+		+ m_numerals.capacity() * sizeof(NumeralValue)
+		+ m_strings.capacity() * sizeof(ConstantString);
+}
+
+void FlatAST::Print(const int indent /*= 0*/) const
+{
+	if (!m_kinds.empty())
+		printNode(0, indent);
+}
+
+void FlatAST::printNode(const FlatNodeIndex index, const int indent) const
+{
+	std::wcout << std::wstring(indent, ' ') << getKindName(GetKind(index));
+	switch (GetKind(index))
+	{
+	case EASTType::Name:
+		std::wcout << L": " << GetName(index);
+		break;
+	case EASTType::Numeral:
+		if (GetNumeral(index).isInteger)
+			std::wcout << L" (int): " << GetNumeral(index).intValue;
+		else
+			std::wcout << L" (float): " << GetNumeral(index).floatValue;
+		break;
+	case EASTType::Boolean:
+		std::wcout << L": " << GetBoolean(index);
+		break;
+	case EASTType::LiteralString:
+		std::wcout << L": " << *GetString(index);
+		break;
+	case EASTType::BinaryExpression:
+	case EASTType::UnaryExpression:
+		std::wcout << L": " << GetOperatorName(GetOperator(index));
+		break;
+	default:
+		break;
+	}
+	std::wcout << std::endl;
+
+	for (const FlatNodeIndex child : GetChildren(index))
+		printNode(child, indent + 2);
+}
+
+FlatNodeIndex FlatAST::addNode(const Base& node, const FlatNodeIndex parent, FlatNodeIndex& lastChild)
+{
+	const FlatNodeIndex index = static_cast<FlatNodeIndex>(m_kinds.size());
+	const EASTType eType = node.GetType();
+
+	m_kinds.push_back(static_cast<uint8_t>(eType));
+	m_operators.push_back(EOperator::None);
+	m_firstChild.push_back(InvalidFlatNode);
+	m_nextSibling.push_back(InvalidFlatNode);
+	m_payloads.push_back(0);
+
+	// 부모의 자식 목록 끝에 연결한다.
+	if (InvalidFlatNode != lastChild)
+		m_nextSibling[lastChild] = index;
+	else if (InvalidFlatNode != parent)
+		m_firstChild[parent] = index;
+	lastChild = index;
+
+	switch (eType)
+	{
+	case EASTType::Name:
+		m_payloads[index] = static_cast<const Name&>(node).id;
+		break;
+	case EASTType::Numeral:
+	{
+		const Numeral& numeral = static_cast<const Numeral&>(node);
+		m_payloads[index] = static_cast<uint32_t>(m_numerals.size());
+		m_numerals.push_back(NumeralValue{ numeral.isInteger, numeral.intValue, numeral.floatValue });
+		break;
+	}
+	case EASTType::Boolean:
+		m_payloads[index] = static_cast<const Boolean&>(node).value ? 1 : 0;
+		break;
+	case EASTType::LiteralString:
+		m_payloads[index] = static_cast<uint32_t>(m_strings.size());
+		m_strings.push_back(static_cast<const LiteralString&>(node).value);
+		break;
+	case EASTType::BinaryExpression:
+		m_operators[index] = static_cast<const BinaryExpression&>(node).binaryOperator;
+		break;
+	case EASTType::UnaryExpression:
+		m_operators[index] = static_cast<const UnaryExpression&>(node).unaryOperator;
+		break;
+	default:
+		break;
+	}
+
+	addChildren(node, index);
+	return index;
+}
+
+// 자식 노드를 Iterate와 같은 순서로 추가한다.
+void FlatAST::addChildren(const Base& node, const FlatNodeIndex index)
+{
+	FlatNodeIndex lastChild = InvalidFlatNode;
+	auto add = [this, index, &lastChild](const BasePtr& spChild)
+	{
+		if (spChild)
+			addNode(*spChild, index, lastChild);
+	};
+
+	switch (node.GetType())
+	{
+	case EASTType::NameList:
+		for (const BasePtr& spName : static_cast<const NameList&>(node).names)
+			add(spName);
+		break;
+	case EASTType::AST:
+		add(static_cast<const AST&>(node).block);
+		break;
+	case EASTType::Block:
+		for (const BasePtr& spStatement : static_cast<const Block&>(node).statements)
+			add(spStatement);
+		break;
+	case EASTType::Assignment:
+		add(static_cast<const Assignment&>(node).name);
+		add(static_cast<const Assignment&>(node).expression);
+		break;
+	case EASTType::Expression:
+		add(static_cast<const Expression&>(node).expression);
+		break;
+	case EASTType::ExpressionList:
+		for (const BasePtr& spExpression : static_cast<const ExpressionList&>(node).expressions)
+			add(spExpression);
+		break;
+	case EASTType::PrimaryExpression:
+		add(static_cast<const PrimaryExpression&>(node).primaryExpression);
+		break;
+	case EASTType::BinaryExpression:
+		add(static_cast<const BinaryExpression&>(node).primaryExpression1);
+		add(static_cast<const BinaryExpression&>(node).primaryExpression2);
+		break;
+	case EASTType::UnaryExpression:
+		add(static_cast<const UnaryExpression&>(node).primaryExpression);
+		break;
+	case EASTType::FunctionDefinition:
+	{
+		const FunctionDefinition& functionDefinition = static_cast<const FunctionDefinition&>(node);
+		add(functionDefinition.name);
+		add(functionDefinition.functionParameter);
+		add(functionDefinition.GetBlock());
+		break;
+	}
+	case EASTType::FunctionParameter:
+		add(static_cast<const FunctionParameter&>(node).nameList);
+		break;
+	case EASTType::FunctionArgument:
+		add(static_cast<const FunctionArgument&>(node).expressionList);
+		break;
+	case EASTType::FunctionCall:
+		add(static_cast<const FunctionCall&>(node).name);
+		add(static_cast<const FunctionCall&>(node).functionArgument);
+		break;
+	case EASTType::Statement:
+		add(static_cast<const Statement&>(node).statement);
+		break;
+	case EASTType::Return:
+		for (const BasePtr& spExpression : static_cast<const Return&>(node).expressions)
+			add(spExpression);
+		break;
+	case EASTType::While:
+		add(static_cast<const While&>(node).expression);
+		add(static_cast<const While&>(node).statDo);
+		break;
+	case EASTType::If:
+		add(static_cast<const If&>(node).expression);
+		add(static_cast<const If&>(node).block);
+		add(static_cast<const If&>(node).statIf);
+		break;
+	case EASTType::For:
+		add(static_cast<const For&>(node).name);
+		add(static_cast<const For&>(node).expression1);
+		add(static_cast<const For&>(node).expression2);
+		add(static_cast<const For&>(node).expression3);
+		break;
+	default:
+		break;
+	}
+}
+
+FlatASTPtr FlattenAST(const BaseCPtr& spRoot)
+{
+	if (!spRoot)
+		return nullptr;
+
+	FlatASTPtr spFlat = std::make_shared<FlatAST>();
+
+	FlatNodeIndex lastChild = InvalidFlatNode;
+	spFlat->addNode(*spRoot, InvalidFlatNode, lastChild);
+
+	// 변환한 다음에는 노드를 추가하지 않으므로 남는 용량을 돌려준다.
+	spFlat->m_kinds.shrink_to_fit();
+	spFlat->m_operators.shrink_to_fit();
+	spFlat->m_firstChild.shrink_to_fit();
+	spFlat->m_nextSibling.shrink_to_fit();
+	spFlat->m_payloads.shrink_to_fit();
+	spFlat->m_numerals.shrink_to_fit();
+	spFlat->m_strings.shrink_to_fit();
+
+	return spFlat;
+}
+
+}
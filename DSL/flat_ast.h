@@ -0,0 +1,118 @@
+﻿#pragma once
+
+#include "ast.h"
+#include "numeral.h"
+
+/*
+평탄화한 AST.
+트리 AST는 노드마다 따로 할당한 다형 구조체를 shared_ptr로 연결한다. 순회할 때마다 노드 사이를 건너뛰며 메모리를 읽는다.
+FlatAST는 노드를 전위 순회 순서로 연속된 배열에 저장한다. 노드 종류, 연산자, 첫 번째 자식, 다음 형제를 각각 배열로 두고,
+이름, 숫자, 문자열 같은 값은 별도의 테이블에 저장한다. 모든 노드를 순회할 때는 배열을 앞에서부터 차례로 읽으면 된다.
+
+노드 인덱스는 uint32이다. 0번 노드가 루트이고, 한 노드의 하위 트리는 그 노드 바로 뒤에 연속해서 있다.
+자식의 순서는 트리 노드의 Iterate와 같다. 트리에서 nullptr인 자식은 저장하지 않는다. (If의 statIf 처럼 값이 없을 수 있는 자식은 항상 마지막 자식이다.)
+*/
+
+namespace dsl
+{
+	using FlatNodeIndex = uint32_t;
+	constexpr FlatNodeIndex InvalidFlatNode = UINT32_MAX;
+
+	class FlatAST;
+	using FlatASTPtr = std::shared_ptr<FlatAST>;
+	using FlatASTCPtr = std::shared_ptr<const FlatAST>;
+
+
+	class FlatAST
+	{
+	public:
+		// 자식 노드 범위. 첫 번째 자식부터 다음 형제를 따라간다.
+		class ChildRange
+		{
+		public:
+			class Iterator
+			{
+			public:
+				Iterator(const FlatAST* pAST, const FlatNodeIndex index) : m_pAST(pAST), m_index(index) {}
+
+				FlatNodeIndex operator*() const { return m_index; }
+				Iterator& operator++() { m_index = m_pAST->GetNextSibling(m_index); return *this; }
+				bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+
+			private:
+				const FlatAST* m_pAST;
+				FlatNodeIndex m_index;
+			};
+
+			ChildRange(const FlatAST* pAST, const FlatNodeIndex first) : m_pAST(pAST), m_first(first) {}
+
+			Iterator begin() const { return Iterator(m_pAST, m_first); }
+			Iterator end() const { return Iterator(m_pAST, InvalidFlatNode); }
+
+		private:
+			const FlatAST* m_pAST;
+			FlatNodeIndex m_first;
+		};
+
+	public:
+		size_t GetNodeCount() const { return m_kinds.size(); }
+
+		EASTType GetKind(const FlatNodeIndex index) const { return static_cast<EASTType>(m_kinds[index]); }
+		FlatNodeIndex GetFirstChild(const FlatNodeIndex index) const { return m_firstChild[index]; }
+		FlatNodeIndex GetNextSibling(const FlatNodeIndex index) const { return m_nextSibling[index]; }
+		ChildRange GetChildren(const FlatNodeIndex index) const { return ChildRange(this, m_firstChild[index]); }
+
+		// n번째 자식. 없으면 InvalidFlatNode
+		FlatNodeIndex GetChild(const FlatNodeIndex index, size_t n) const;
+
+		// 하위 트리의 끝 (마지막 자손 다음 인덱스). 하위 트리는 [index, GetSubtreeEnd(index)) 범위이다.
+		FlatNodeIndex GetSubtreeEnd(const FlatNodeIndex index) const;
+
+		// 노드 값. 노드 종류에 맞는 함수만 호출해야 한다.
+		SymbolId GetSymbol(const FlatNodeIndex index) const { return m_payloads[index]; }										// Name
+		const std::wstring& GetName(const FlatNodeIndex index) const { return GetSymbolName(m_payloads[index]); }				// Name
+		const NumeralValue& GetNumeral(const FlatNodeIndex index) const { return m_numerals[m_payloads[index]]; }				// Numeral
+		bool GetBoolean(const FlatNodeIndex index) const { return 0 != m_payloads[index]; }									// Boolean
+		const ConstantString& GetString(const FlatNodeIndex index) const { return m_strings[m_payloads[index]]; }				// LiteralString
+		EOperator GetOperator(const FlatNodeIndex index) const { return m_operators[index]; }									// BinaryExpression, UnaryExpression
+
+		// 모든 노드를 전위 순회 순서로 방문한다. 배열을 차례로 읽으므로 재귀 호출이 없다.
+		// @callback	: void(FlatNodeIndex index)
+		template <typename Callback>
+		void ForEach(Callback&& callback) const
+		{
+			const FlatNodeIndex count = static_cast<FlatNodeIndex>(m_kinds.size());
+			for (FlatNodeIndex index = 0; index < count; ++index)
+				callback(index);
+		}
+
+		// 배열과 테이블이 사용하는 메모리 (bytes). ConstantString의 문자열은 상수 풀이 가지고 있으므로 포함하지 않는다.
+		size_t GetMemoryBytes() const;
+
+		void Print(const int indent = 0) const;
+
+	private:
+		friend FlatASTPtr FlattenAST(const BaseCPtr& spRoot);
+
+		FlatNodeIndex addNode(const Base& node, const FlatNodeIndex parent, FlatNodeIndex& lastChild);
+		void addChildren(const Base& node, const FlatNodeIndex index);
+
+		void printNode(const FlatNodeIndex index, const int indent) const;
+
+	private:
+		// 노드별 배열. 같은 인덱스가 같은 노드이다.
+		std::vector<uint8_t>		m_kinds;			// EASTType
+		std::vector<EOperator>		m_operators;		// 연산자가 없으면 EOperator::None
+		std::vector<FlatNodeIndex>	m_firstChild;
+		std::vector<FlatNodeIndex>	m_nextSibling;
+		std::vector<uint32_t>		m_payloads;			// Name: SymbolId, Numeral: m_numerals 인덱스, Boolean: 0 또는 1, LiteralString: m_strings 인덱스
+
+		// 값 테이블
+		std::vector<NumeralValue>	m_numerals;
+		std::vector<ConstantString>	m_strings;
+	};
+
+
+	// 트리 AST를 평탄화한다. 지연 파싱하는 함수 본문은 이 때 파싱한다. 루트가 nullptr이면 nullptr를 반환한다.
+	FlatASTPtr FlattenAST(const BaseCPtr& spRoot);
+}
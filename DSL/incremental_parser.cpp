@@ -0,0 +1,233 @@
+﻿#include "pch.h"
+
+#include "ast.h"
+#include "token_parser.h"
+#include "script_file.h"
+#include "incremental_parser.h"
+
+namespace dsl
+{
+
+// 렉서가 토큰 끝 다음에 확인하는 최대 문자 수.
+// 숫자의 지수부는 'e', 부호, 숫자까지 확인한 다음 리터럴에 포함할지 정한다. ("1e+5")
+static constexpr size_t g_lexerLookahead = 3;
+
+// 파싱 실패 정보 출력
+static void printReparseFailure(const std::string_view strScript, const size_t offset)
+{
+	std::wcout << L"Parsing Failed..." << std::endl;
+	std::wcout << L"Parsing Location: " << offset << L"/" << strScript.length() << std::endl;
+	if (offset < strScript.length())
+		std::wcout << L"Failed Location: " << Utf8ToWide(strScript.substr(offset, 20)) << std::endl;
+}
+
+IncrementalParser::IncrementalParser()
+	: m_errorOffset(0)
+{
+}
+
+// 스크립트 전체를 파싱하고 최상위 구문의 소스 범위를 기록한다.
+ASTPtr IncrementalParser::Parse(std::string_view strUtf8Script, StatementRangeList& ranges)
+{
+	m_lastStats = ReparseStats();
+	m_functions.clear();
+	ranges.clear();
+
+	ConstantPoolPtr spPool = std::make_shared<ConstantPool>();
+	ConstantPool::Scope poolScope(spPool);
+
+	// ruleBlock은 구문이 1개 이상 있어야 한다.
+	std::vector<BasePtr> statements;
+	m_errorOffset = strUtf8Script.size();
+	if (!parseWindow(strUtf8Script, 0, strUtf8Script.size(), strUtf8Script.size(), statements, ranges) || statements.empty())
+	{
+		printReparseFailure(strUtf8Script, m_errorOffset);
+		ranges.clear();
+		return nullptr;
+	}
+
+	for (size_t i = 1; i < ranges.size(); ++i)
+		ranges[i].lookaheadEnd = (std::max)(ranges[i].lookaheadEnd, ranges[i - 1].lookaheadEnd);
+
+	m_lastStats.parsedStatementCount = statements.size();
+
+	return std::make_shared<AST>(std::make_shared<Block>(statements), spPool);
+}
+
+// 이전 AST를 재사용해서 새 텍스트를 파싱한다.
+// 1. 두 텍스트의 공통 앞부분과 공통 뒷부분을 찾는다. 그 사이가 수정 범위이다.
+// 2. peek한 토큰까지 공통 앞부분에 있는 구문은 재사용한다.
+// 3. 재사용한 마지막 구문의 끝부터 다시 파싱한다. 수정 범위 뒤에 있는 이전 구문의 시작 위치에서 구문이 끝나면 그 구문부터는 재사용한다.
+//    맞지 않으면 뒤쪽 구문을 2배씩 늘려가며 다시 시도한다. 파일 끝까지 맞지 않으면 뒷부분 전체를 파싱한 결과를 사용한다.
+ASTPtr IncrementalParser::Reparse(std::string_view strOldScript, std::string_view strNewScript, const ASTCPtr& spOldAST, const StatementRangeList& oldRanges, StatementRangeList& newRanges)
+{
+	if (!spOldAST || !spOldAST->block || EASTType::Block != spOldAST->block->GetType())
+		return Parse(strNewScript, newRanges);
+
+	const BlockCPtr spOldBlock = static_pointer_cast<const Block>(spOldAST->block);
+	const std::vector<BasePtr>& oldStatements = spOldBlock->statements;
+	if (oldStatements.size() != oldRanges.size())
+		return Parse(strNewScript, newRanges);
+
+	m_lastStats = ReparseStats();
+	m_functions.clear();
+	newRanges.clear();
+
+	// 새로 파싱한 구문의 리터럴은 이전 AST의 상수 풀에 추가한다. 교체된 구문의 리터럴이 쓰던 버퍼는 풀에 남는다.
+	ConstantPoolPtr spPool = spOldAST->constants ? spOldAST->constants : std::make_shared<ConstantPool>();
+	ConstantPool::Scope poolScope(spPool);
+
+	const size_t count = oldRanges.size();
+
+	// 바뀐 내용이 없으면 block을 그대로 사용한다.
+	if (strOldScript == strNewScript)
+	{
+		newRanges = oldRanges;
+		m_lastStats.firstStatement = count;
+		m_lastStats.reusedStatementCount = count;
+		return std::make_shared<AST>(spOldAST->block, spPool);
+	}
+
+	// 수정 범위
+	const size_t minLength = (std::min)(strOldScript.size(), strNewScript.size());
+	const size_t prefixLength = std::mismatch(strOldScript.begin(), strOldScript.begin() + minLength, strNewScript.begin()).first - strOldScript.begin();
+	const size_t suffixLength = std::mismatch(strOldScript.rbegin(), strOldScript.rbegin() + (minLength - prefixLength), strNewScript.rbegin()).first - strOldScript.rbegin();
+	const size_t editEndOld = strOldScript.size() - suffixLength;
+	const auto toNewOffset = [&strOldScript, &strNewScript](const size_t oldOffset) { return oldOffset + strNewScript.size() - strOldScript.size(); };
+
+	// 앞쪽 재사용 구문. lookaheadEnd는 앞 구문을 포함한 최대값이므로 정렬되어 있다.
+	const size_t first = std::partition_point(oldRanges.begin(), oldRanges.end(), [prefixLength](const StatementRange& range)
+		{
+			return range.lookaheadEnd + g_lexerLookahead <= prefixLength;
+		}) - oldRanges.begin();
+	const size_t windowStart = first > 0 ? oldRanges[first - 1].end : 0;
+
+	// 뒤쪽 재사용 후보. 시작 위치가 수정 범위 뒤에 있는 첫 구문
+	size_t syncIndex = std::partition_point(oldRanges.begin() + first, oldRanges.end(), [editEndOld](const StatementRange& range)
+		{
+			return range.start < editEndOld;
+		}) - oldRanges.begin();
+
+	std::vector<BasePtr> statements;
+	StatementRangeList ranges;
+	size_t step = 1;
+	while (true)
+	{
+		// 맞춰볼 구문(syncIndex) 뒤로 step개의 구문까지 토큰으로 분리한다. 그래야 syncIndex 앞의 구문이 peek하는 토큰이 잘리지 않는다.
+		const size_t lookIndex = (std::min)(syncIndex + step, count);
+		const size_t windowEnd = lookIndex < count ? toNewOffset(oldRanges[lookIndex].start) : strNewScript.size();
+		const size_t syncOffset = syncIndex < count ? toNewOffset(oldRanges[syncIndex].start) : strNewScript.size();
+
+		statements.clear();
+		ranges.clear();
+		if (parseWindow(strNewScript, windowStart, windowEnd, syncOffset, statements, ranges))
+			break;
+
+		// 파일 끝까지 파싱했는데 실패했다면 스크립트 오류이다.
+		if (syncIndex >= count)
+		{
+			printReparseFailure(strNewScript, m_errorOffset);
+			return nullptr;
+		}
+
+		syncIndex = lookIndex;
+		step *= 2;
+	}
+
+	// ruleBlock은 구문이 1개 이상 있어야 한다.
+	const size_t newCount = first + statements.size() + (count - syncIndex);
+	if (0 == newCount)
+	{
+		printReparseFailure(strNewScript, strNewScript.size());
+		return nullptr;
+	}
+
+	// 새 block. 앞쪽과 뒤쪽 구문은 이전 노드를 공유한다.
+	std::vector<BasePtr> newStatements;
+	newStatements.reserve(newCount);
+	newStatements.insert(newStatements.end(), oldStatements.begin(), oldStatements.begin() + first);
+	newStatements.insert(newStatements.end(), statements.begin(), statements.end());
+	newStatements.insert(newStatements.end(), oldStatements.begin() + syncIndex, oldStatements.end());
+
+	// 새 구문 범위. 뒤쪽 구문은 수정으로 늘어나거나 줄어든 길이만큼 옮긴다.
+	newRanges.reserve(newCount);
+	newRanges.insert(newRanges.end(), oldRanges.begin(), oldRanges.begin() + first);
+	newRanges.insert(newRanges.end(), ranges.begin(), ranges.end());
+	for (size_t i = syncIndex; i < count; ++i)
+	{
+		const StatementRange& range = oldRanges[i];
+		newRanges.push_back(StatementRange{ static_cast<unsigned int>(toNewOffset(range.start)), static_cast<unsigned int>(toNewOffset(range.end)), static_cast<unsigned int>(toNewOffset(range.lookaheadEnd)) });
+	}
+	for (size_t i = (std::max)(first, static_cast<size_t>(1)); i < newRanges.size(); ++i)
+		newRanges[i].lookaheadEnd = (std::max)(newRanges[i].lookaheadEnd, newRanges[i - 1].lookaheadEnd);
+
+	m_lastStats.firstStatement = first;
+	m_lastStats.removedStatementCount = syncIndex - first;
+	m_lastStats.parsedStatementCount = statements.size();
+	m_lastStats.reusedStatementCount = first + (count - syncIndex);
+
+	return std::make_shared<AST>(std::make_shared<Block>(newStatements), spPool);
+}
+
+// [windowStart, windowEnd) 범위를 토큰으로 분리하고, syncOffset에서 끝나도록 구문을 파싱한다.
+// windowEnd가 스크립트 끝이 아니면 마지막 토큰 다음은 잘려있으므로, 마지막 구문이 End 토큰을 peek 했다면 결과를 믿을 수 없다.
+bool IncrementalParser::parseWindow(std::string_view strScript, const size_t windowStart, const size_t windowEnd, const size_t syncOffset, std::vector<BasePtr>& statements, StatementRangeList& ranges)
+{
+	const std::string_view strWindow = strScript.substr(windowStart, windowEnd - windowStart);
+
+	++m_lastStats.attemptCount;
+	m_lastStats.parsedLength += strWindow.size();
+
+	size_t errorOffset = 0;
+	if (!Tokenize(strWindow, m_tokens, errorOffset))
+	{
+		m_errorOffset = windowStart + errorOffset;
+		return false;
+	}
+
+	// 구문이 끝나야 하는 토큰. syncOffset에서 시작하는 토큰이 없다면 수정한 내용이 뒤쪽 토큰을 바꾼 것이다. (문자열, 주석 등)
+	const size_t endPos = m_tokens.size() - 1;
+	size_t syncPos = endPos;
+	if (syncOffset < windowEnd)
+	{
+		const size_t localSyncOffset = syncOffset - windowStart;
+		const auto iter = std::partition_point(m_tokens.begin(), m_tokens.begin() + endPos, [localSyncOffset](const Token& token) { return token.GetStart() < localSyncOffset; });
+		if (iter == m_tokens.begin() + endPos || iter->GetStart() != localSyncOffset)
+		{
+			m_errorOffset = syncOffset;
+			return false;
+		}
+		syncPos = iter - m_tokens.begin();
+	}
+
+	TokenParser parser(strWindow, m_tokens);
+	while (parser.GetPosition() < syncPos)
+	{
+		const size_t startPos = parser.GetPosition();
+		BasePtr spStatement = parser.ParseStatement();
+		if (!spStatement)
+		{
+			m_errorOffset = windowStart + parser.GetStopOffset();
+			return false;
+		}
+
+		const size_t lookaheadPos = (std::min)(parser.GetFurthestPosition() + 1, endPos);
+		statements.push_back(spStatement);
+		ranges.push_back(StatementRange{
+			static_cast<unsigned int>(windowStart + m_tokens[startPos].GetStart()),
+			static_cast<unsigned int>(windowStart + m_tokens[parser.GetPosition() - 1].GetEnd()),
+			static_cast<unsigned int>(windowStart + m_tokens[lookaheadPos].GetEnd()) });
+	}
+
+	// 구문이 syncOffset을 넘어갔거나, 잘린 끝부분을 peek 했다.
+	if (parser.GetPosition() != syncPos || (!statements.empty() && windowEnd < strScript.size() && parser.GetFurthestPosition() + 1 >= endPos))
+	{
+		m_errorOffset = syncOffset;
+		return false;
+	}
+
+	m_functions = parser.TakeFunctions();
+	return true;
+}
+
+}
@@ -0,0 +1,84 @@
+﻿#pragma once
+
+#include "lexer.h"
+
+/*
+증분 파서.
+스크립트를 수정한 다음 다시 로드할 때(hot reload), 이전 텍스트와 새 텍스트를 비교해서 바뀐 최상위 구문만 다시 파싱한다.
+바뀌지 않은 구문은 이전 AST의 노드를 그대로 사용하므로, 파싱 시간은 파일 크기가 아니라 수정한 범위의 크기를 따라간다.
+
+입력은 UTF-8 이며 Token 백엔드로 파싱한다.
+이전 AST의 최상위 구문마다 소스 범위(StatementRange)를 기록해두고, 수정 범위와 겹치지 않는 구문을 앞뒤에서 재사용한다.
+  - 앞쪽 구문은 파서가 peek한 가장 먼 토큰까지 수정 범위 앞에 있어야 재사용한다.
+  - 뒤쪽 구문은 새 텍스트를 다시 파싱하다가 이전 구문의 시작 위치에서 구문이 끝나고, 그 위치에서 토큰이 시작될 때 재사용한다.
+따라서 결과는 새 텍스트 전체를 파싱한 것과 같다.
+*/
+
+namespace dsl
+{
+	// 최상위 구문 1개의 소스 범위 (bytes). Token 위치와 같이 32비트이며, Tokenize가 MaxTokenizeLength보다 긴 스크립트를 거부하므로 잘리지 않는다.
+	struct StatementRange
+	{
+		unsigned int start = 0;			// 첫 토큰의 시작 위치. 문자열 토큰은 앞 따옴표를 포함한다.
+		unsigned int end = 0;			// 마지막 토큰의 끝 위치. 문자열 토큰은 뒤 따옴표를 포함한다.
+		unsigned int lookaheadEnd = 0;	// 이 구문까지 파서가 peek한 가장 먼 토큰의 끝 위치. 앞 구문들의 값을 포함한 최대값이다.
+	};
+
+	// 최상위 구문의 소스 범위. AST block의 구문과 순서, 개수가 같다.
+	using StatementRangeList = std::vector<StatementRange>;
+
+
+	// 증분 파싱 통계
+	struct ReparseStats
+	{
+		size_t firstStatement = 0;			// 교체한 첫 구문의 위치. 이전 AST와 새 AST에서 같다.
+		size_t removedStatementCount = 0;	// 이전 AST에서 교체된 구문 수
+		size_t parsedStatementCount = 0;	// 새로 파싱한 구문 수
+		size_t reusedStatementCount = 0;	// 이전 AST에서 재사용한 구문 수
+		size_t parsedLength = 0;			// 토큰으로 분리한 바이트 수. 다시 시도한 범위를 포함한다.
+		size_t attemptCount = 0;			// 뒤쪽 구문과 맞추기 위해 파싱한 횟수
+	};
+
+
+	class IncrementalParser
+	{
+	public:
+		IncrementalParser();
+
+		IncrementalParser(const IncrementalParser&) = delete;
+		IncrementalParser& operator=(const IncrementalParser&) = delete;
+
+	public:
+		// 스크립트 전체를 파싱하고 최상위 구문의 소스 범위를 기록한다. 실패하면 nullptr를 반환한다.
+		ASTPtr Parse(std::string_view strUtf8Script, StatementRangeList& ranges);
+
+		// 이전 AST를 재사용해서 새 텍스트를 파싱한다. 실패하면 nullptr를 반환한다.
+		// 새 AST의 block은 새로 만들지만, 바뀌지 않은 구문은 이전 AST의 노드를 공유한다.
+		// @strOldScript	: 이전 AST를 만든 텍스트
+		// @spOldAST		: 이전 AST
+		// @oldRanges		: 이전 AST의 구문 범위
+		// @newRanges		: 새 AST의 구문 범위
+		ASTPtr Reparse(std::string_view strOldScript, std::string_view strNewScript, const ASTCPtr& spOldAST, const StatementRangeList& oldRanges, StatementRangeList& newRanges);
+
+		// 마지막 Reparse 호출의 통계
+		const ReparseStats& GetLastStats() const { return m_lastStats; }
+
+		// 파싱에 실패한 위치 (새 텍스트에서의 byte offset)
+		size_t GetErrorOffset() const { return m_errorOffset; }
+
+		// 마지막 Parse, Reparse 호출에서 새로 파싱한 구문의 함수 정의. 구문 순서이며 각 구문 안에서는 전위 순회 순서이다.
+		// 재사용한 구문의 함수는 포함하지 않는다.
+		const std::vector<FunctionDefinitionCPtr>& GetLastFunctions() const { return m_functions; }
+
+	private:
+		// strScript의 [windowStart, windowEnd) 범위를 토큰으로 분리하고, syncOffset에서 끝나도록 구문을 파싱한다.
+		// 구문이 syncOffset에서 끝나지 않거나, 범위 끝에서 잘린 토큰을 peek 했다면 false를 반환한다.
+		bool parseWindow(std::string_view strScript, const size_t windowStart, const size_t windowEnd, const size_t syncOffset, std::vector<BasePtr>& statements, StatementRangeList& ranges);
+
+	private:
+		TokenList		m_tokens;		// 토큰 배열. 호출마다 재사용한다.
+		ReparseStats	m_lastStats;
+		size_t			m_errorOffset;
+		std::vector<FunctionDefinitionCPtr>	m_functions;	// 새로 파싱한 구문의 함수 정의
+	};
+}
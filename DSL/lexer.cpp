@@ -0,0 +1,210 @@
+﻿#include "pch.h"
+
+#include "scan.h"
+#include "numeral.h"
+#include "lexer.h"
+
+namespace dsl
+{
+
+// ETokenKeyword 순서와 같아야 한다.
+static const wchar_t* const sc_keywordTexts[] =
+{
+	L"and", L"or", L"not", L"break", L"goto", L"do", L"end", L"while",
+	L"repeat", L"return", L"until", L"if", L"then", L"elseif", L"else",
+	L"for", L"in", L"function", L"local", L"false", L"true",
+};
+static_assert(std::size(sc_keywordTexts) == static_cast<size_t>(ETokenKeyword::Count));
+
+// ETokenSymbol 순서와 같아야 한다.
+static const wchar_t* const sc_symbolTexts[] =
+{
+	L"*", L"/", L"%", L"+", L"-", L"<", L">", L"<=", L">=", L"==", L"!=",
+	L"*=", L"/=", L"+=", L"-=", L"=", L"(", L")", L",",
+};
+static_assert(std::size(sc_symbolTexts) == static_cast<size_t>(ETokenSymbol::Count));
+
+const wchar_t* GetKeywordText(const ETokenKeyword eKeyword)
+{
+	return sc_keywordTexts[static_cast<size_t>(eKeyword)];
+}
+
+const wchar_t* GetSymbolText(const ETokenSymbol eSymbol)
+{
+	return sc_symbolTexts[static_cast<size_t>(eSymbol)];
+}
+
+// 이름이 키워드 문자열과 같은지 비교
+template <typename CharT>
+static bool equalsKeyword(const std::basic_string_view<CharT> name, const wchar_t* text)
+{
+	for (const CharT c : name)
+	{
+		if (static_cast<wchar_t>(c) != *text++)
+			return false;
+	}
+	return L'\0' == *text;
+}
+
+// 키워드 검색
+// 첫 글자로 후보 키워드를 좁힌 다음 비교한다. 모든 키워드는 소문자로 시작한다.
+template <typename CharT>
+static bool findKeyword(const std::basic_string_view<CharT> name, ETokenKeyword& eKeyword)
+{
+	using KeywordBucket = std::vector<ETokenKeyword>;
+	static const std::array<KeywordBucket, 26> sc_keywordTable = []()
+	{
+		std::array<KeywordBucket, 26> table;
+		for (size_t i = 0; i < std::size(sc_keywordTexts); ++i)
+			table[sc_keywordTexts[i][0] - L'a'].push_back(static_cast<ETokenKeyword>(i));
+		return table;
+	}();
+
+	if (name[0] < 'a' || 'z' < name[0])
+		return false;
+
+	for (const ETokenKeyword eCandidate : sc_keywordTable[name[0] - 'a'])
+	{
+		if (equalsKeyword(name, GetKeywordText(eCandidate)))
+		{
+			eKeyword = eCandidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// 스크립트를 토큰으로 분리한다.
+// 이름, 숫자, 연산자는 ascii 문자만 사용하므로 UTF-8 스크립트도 바이트 단위로 그대로 분리할 수 있다.
+template <typename CharT>
+static bool tokenize(const std::basic_string_view<CharT> strScript, TokenList& tokens, size_t& errorOffset)
+{
+	tokens.clear();
+
+	// 토큰 위치를 32비트로 저장하므로 더 긴 스크립트는 위치가 잘리기 전에 실패한다.
+	if (strScript.size() > MaxTokenizeLength)
+	{
+		errorOffset = MaxTokenizeLength;
+		return false;
+	}
+
+	const CharT* const begin = strScript.data();
+	const CharT* const end = begin + strScript.size();
+	const CharT* p = begin;
+
+	auto fail = [&errorOffset, begin](const CharT* pos)
+	{
+		errorOffset = static_cast<size_t>(pos - begin);
+		return false;
+	};
+
+	auto pushSymbol = [&tokens, begin, &p](const ETokenSymbol eSymbol, const size_t length)
+	{
+		tokens.push_back(Token{ ETokenType::Symbol, static_cast<unsigned char>(eSymbol), static_cast<unsigned int>(p - begin), static_cast<unsigned int>(length) });
+		p += length;
+	};
+
+	while (true)
+	{
+		// 공백과 '-- 주석'을 건너뛴다.
+		while (p < end)
+		{
+			if (IsSpaceChar(*p))
+			{
+				p = ScanSpace(p + 1, end);
+			}
+			else if ('-' == *p && p + 1 < end && '-' == p[1])
+			{
+				p = ScanLineEnd(p + 2, end);
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		if (p == end)
+			break;
+
+		const CharT* const start = p;
+		const CharT c = *p;
+
+		// 이름 또는 키워드
+		if (IsNameStartChar(c))
+		{
+			p = ScanNameChars(p + 1, end);
+
+			Token token{ ETokenType::Name, 0, static_cast<unsigned int>(start - begin), static_cast<unsigned int>(p - start) };
+
+			ETokenKeyword eKeyword;
+			if (findKeyword(std::basic_string_view<CharT>(start, p - start), eKeyword))
+			{
+				token.eType = ETokenType::Keyword;
+				token.id = static_cast<unsigned char>(eKeyword);
+			}
+
+			tokens.push_back(token);
+			continue;
+		}
+
+		// 숫자
+		// 범위만 찾고, 값은 토큰 파서에서 변환한다.
+		if ((IsDigitChar(c) || '.' == c) && ScanNumeral(p, end, nullptr))
+		{
+			tokens.push_back(Token{ ETokenType::Number, 0, static_cast<unsigned int>(start - begin), static_cast<unsigned int>(p - start) });
+			continue;
+		}
+
+		// 문자열
+		if ('"' == c)
+		{
+			const CharT* q = ScanQuote(p + 1, end);
+			if (q == end)
+				return fail(start);
+
+			tokens.push_back(Token{ ETokenType::String, 0, static_cast<unsigned int>(start + 1 - begin), static_cast<unsigned int>(q - start - 1) });
+			p = q + 1;
+			continue;
+		}
+
+		// 연산자, 괄호, 콤마
+		const bool bNextIsAssign = (p + 1 < end && '=' == p[1]);
+		switch (c)
+		{
+		case '*': bNextIsAssign ? pushSymbol(ETokenSymbol::MulAssign, 2) : pushSymbol(ETokenSymbol::Mul, 1); break;
+		case '/': bNextIsAssign ? pushSymbol(ETokenSymbol::DivAssign, 2) : pushSymbol(ETokenSymbol::Div, 1); break;
+		case '+': bNextIsAssign ? pushSymbol(ETokenSymbol::AddAssign, 2) : pushSymbol(ETokenSymbol::Add, 1); break;
+		case '-': bNextIsAssign ? pushSymbol(ETokenSymbol::SubAssign, 2) : pushSymbol(ETokenSymbol::Sub, 1); break;
+		case '<': bNextIsAssign ? pushSymbol(ETokenSymbol::LessEqual, 2) : pushSymbol(ETokenSymbol::Less, 1); break;
+		case '>': bNextIsAssign ? pushSymbol(ETokenSymbol::GreaterEqual, 2) : pushSymbol(ETokenSymbol::Greater, 1); break;
+		case '=': bNextIsAssign ? pushSymbol(ETokenSymbol::Equal, 2) : pushSymbol(ETokenSymbol::Assign, 1); break;
+		case '%': pushSymbol(ETokenSymbol::Mod, 1); break;
+		case '(': pushSymbol(ETokenSymbol::LParen, 1); break;
+		case ')': pushSymbol(ETokenSymbol::RParen, 1); break;
+		case ',': pushSymbol(ETokenSymbol::Comma, 1); break;
+		case '!':
+			if (!bNextIsAssign)
+				return fail(start);
+			pushSymbol(ETokenSymbol::NotEqual, 2);
+			break;
+		default:
+			return fail(start);
+		}
+	}
+
+	tokens.push_back(Token{ ETokenType::End, 0, static_cast<unsigned int>(strScript.size()), 0 });
+	return true;
+}
+
+bool Tokenize(std::wstring_view strScript, TokenList& tokens, size_t& errorOffset)
+{
+	return tokenize(strScript, tokens, errorOffset);
+}
+
+bool Tokenize(std::string_view strUtf8Script, TokenList& tokens, size_t& errorOffset)
+{
+	return tokenize(strUtf8Script, tokens, errorOffset);
+}
+
+}
@@ -0,0 +1,113 @@
+﻿#pragma once
+
+/*
+렉서는 스크립트 문자열을 토큰 배열로 변환한다.
+공백과 주석은 렉서에서 한 번만 건너뛰며, 파서는 토큰 배열만 보고 AST를 만든다.
+*/
+
+namespace dsl
+{
+	// 토큰 종류
+	enum class ETokenType : unsigned char
+	{
+		End,		// 입력의 끝
+		Name,		// 이름(식별자)
+		Keyword,	// 키워드
+		Number,		// 숫자
+		String,		// 문자열. 토큰 범위에 따옴표는 포함하지 않는다.
+		Symbol,		// 연산자, 괄호, 콤마
+	};
+
+	// 키워드. dsl_grammar의 symbolKeyword와 같다.
+	enum class ETokenKeyword : unsigned char
+	{
+		And,
+		Or,
+		Not,
+		Break,
+		Goto,
+		Do,
+		End,
+		While,
+		Repeat,
+		Return,
+		Until,
+		If,
+		Then,
+		Elseif,
+		Else,
+		For,
+		In,
+		Function,
+		Local,
+		False,
+		True,
+
+		Count
+	};
+
+	// 연산자, 괄호, 콤마
+	enum class ETokenSymbol : unsigned char
+	{
+		Mul,			// *
+		Div,			// /
+		Mod,			// %
+		Add,			// +
+		Sub,			// -
+		Less,			// <
+		Greater,		// >
+		LessEqual,		// <=
+		GreaterEqual,	// >=
+		Equal,			// ==
+		NotEqual,		// !=
+		MulAssign,		// *=
+		DivAssign,		// /=
+		AddAssign,		// +=
+		SubAssign,		// -=
+		Assign,			// =
+		LParen,			// (
+		RParen,			// )
+		Comma,			// ,
+
+		Count
+	};
+
+	// 토큰
+	// 토큰 값은 복사하지 않고 소스에서의 위치(offset, length)만 기록한다.
+	struct Token
+	{
+		ETokenType		eType = ETokenType::End;
+		unsigned char	id = 0;		// eType이 Keyword이면 ETokenKeyword, Symbol이면 ETokenSymbol
+		unsigned int	offset = 0;	// 소스에서의 시작 위치. 32비트이므로 스크립트 길이는 MaxTokenizeLength 이하여야 한다.
+		unsigned int	length = 0;	// 소스에서의 길이
+
+		bool IsKeyword(const ETokenKeyword eKeyword) const { return ETokenType::Keyword == eType && static_cast<unsigned char>(eKeyword) == id; }
+		bool IsSymbol(const ETokenSymbol eSymbol) const { return ETokenType::Symbol == eType && static_cast<unsigned char>(eSymbol) == id; }
+
+		// 토큰의 소스에서의 시작, 끝 위치. 문자열 토큰은 offset, length에 따옴표가 포함되지 않으므로 따옴표까지 포함한 범위를 돌려준다.
+		size_t GetStart() const { return ETokenType::String == eType ? offset - 1 : offset; }
+		size_t GetEnd() const { return ETokenType::String == eType ? offset + length + 1 : offset + length; }
+	};
+
+	using TokenList = std::vector<Token>;
+
+	// Tokenize할 수 있는 스크립트의 최대 길이 (wchar_t 스크립트는 문자 수, UTF-8 스크립트는 바이트 수)
+	inline constexpr size_t MaxTokenizeLength = (std::numeric_limits<unsigned int>::max)();
+
+
+	// 스크립트를 토큰으로 분리한다.
+	// @strScript	: 스크립트
+	// @tokens		: 결과 토큰 배열. 마지막 토큰은 항상 End 토큰이다.
+	// @errorOffset	: 실패했을 경우 실패한 위치. 스크립트가 MaxTokenizeLength보다 길면 MaxTokenizeLength
+	// @return		: 성공 여부. 토큰 위치가 32비트이므로 MaxTokenizeLength보다 긴 스크립트는 실패한다.
+	bool Tokenize(std::wstring_view strScript, TokenList& tokens, size_t& errorOffset);
+
+	// UTF-8 스크립트를 토큰으로 분리한다. 토큰의 offset, length는 바이트 단위이다.
+	bool Tokenize(std::string_view strUtf8Script, TokenList& tokens, size_t& errorOffset);
+
+	// 키워드 문자열
+	const wchar_t* GetKeywordText(const ETokenKeyword eKeyword);
+
+	// 연산자 문자열
+	const wchar_t* GetSymbolText(const ETokenSymbol eSymbol);
+}
@@ -0,0 +1,39 @@
+﻿#include "pch.h"
+
+#include "numeral.h"
+
+namespace dsl
+{
+
+// 실수 변환
+// from_chars는 범위를 벗어난 값(1e999 등)을 변환하지 않으므로 이 경우에는 strtod로 inf 또는 0을 얻는다.
+double ConvertFloatNumeral(const NumeralText& text)
+{
+	double value = 0.0;
+	const std::from_chars_result result = std::from_chars(text.Data(), text.Data() + text.Size(), value);
+	if (std::errc::result_out_of_range == result.ec)
+		return std::strtod(std::string(text.Data(), text.Size()).c_str(), nullptr);
+
+	return value;
+}
+
+bool ConvertFloatNumeralFast(const unsigned __int64 mantissa, const int scale, double& value)
+{
+	// 10^0 ~ 10^22 는 double로 정확히 표현된다.
+	static constexpr double pow10[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+	};
+
+	if (mantissa > (1ull << 53) || scale < -22 || scale > 22)
+		return false;
+
+	if (scale < 0)
+		value = static_cast<double>(mantissa) / pow10[-scale];
+	else
+		value = static_cast<double>(mantissa) * pow10[scale];
+	return true;
+}
+
+}
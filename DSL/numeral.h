@@ -0,0 +1,203 @@
+﻿#pragma once
+
+#include "scan.h"
+
+/*
+숫자 리터럴 스캐너.
+정수와 실수를 한 번에 구분하고 값을 변환한다. 렉서와 dsl_grammar가 같은 스캐너를 사용한다.
+
+허용하는 형태
+  정수	: "123", "0x1F"
+  실수	: "3.14", "3.", ".5", "1e10", "2.5E-3"
+10진 정수가 int64 범위를 넘으면 실수로, 16진 정수가 64비트를 넘으면 하위 64비트로 변환한다.
+*/
+
+namespace dsl
+{
+	// 숫자 리터럴 값
+	struct NumeralValue
+	{
+		bool isInteger = true;
+		__int64 intValue = 0;
+		double floatValue = 0.0;
+	};
+
+	// 숫자 리터럴 문자를 모으는 버퍼
+	// std::from_chars는 char 문자열만 받으므로 wchar_t 스크립트의 리터럴을 복사해둔다. 긴 리터럴만 힙을 사용한다.
+	class NumeralText
+	{
+	public:
+		void Push(const char c)
+		{
+			if (m_length < Capacity)
+				m_buffer[m_length++] = c;
+			else
+				pushOverflow(c);
+		}
+
+		const char* Data() const { return m_upOverflow ? m_upOverflow->data() : m_buffer; }
+		size_t Size() const { return m_length; }
+
+	private:
+		void pushOverflow(const char c)
+		{
+			if (!m_upOverflow)
+				m_upOverflow = std::make_unique<std::string>(m_buffer, m_length);
+			m_upOverflow->push_back(c);
+			++m_length;
+		}
+
+	private:
+		static constexpr size_t Capacity = 64;
+
+		char							m_buffer[Capacity];
+		size_t							m_length = 0;
+		std::unique_ptr<std::string>	m_upOverflow;
+	};
+
+	// 리터럴 문자열을 실수로 변환한다. (std::from_chars)
+	double ConvertFloatNumeral(const NumeralText& text);
+
+	// mantissa * 10^scale 이 오차 없이 계산되는 경우에만 변환한다.
+	// mantissa가 2^53 이하이고 |scale|이 22 이하이면 한 번의 곱셈(나눗셈)으로 정확히 반올림된 값을 얻는다.
+	bool ConvertFloatNumeralFast(const unsigned __int64 mantissa, const int scale, double& value);
+
+
+	template <typename CharT> inline bool IsHexDigitChar(const CharT c) { return (CharT('0') <= c && c <= CharT('9')) || (CharT('a') <= c && c <= CharT('f')) || (CharT('A') <= c && c <= CharT('F')); }
+	template <typename CharT> inline unsigned int GetHexDigitValue(const CharT c) { return CharT('9') >= c ? static_cast<unsigned int>(c - CharT('0')) : static_cast<unsigned int>((c | 0x20) - CharT('a') + 10); }
+
+	// [first, last) 앞부분의 숫자 리터럴을 읽는다.
+	// 성공하면 first를 리터럴 다음 위치로 옮긴다. pValue가 nullptr이면 값은 변환하지 않고 범위만 찾는다.
+	// 정수는 읽으면서 바로 값을 계산한다. 실수는 가수부가 작으면 바로 계산하고, 그렇지 않으면 문자를 복사해서 std::from_chars로 변환한다.
+	// 지수부는 뒤에 숫자가 있을 때만 리터럴에 포함한다. ("1e" 는 "1" 과 이름 "e")
+	template <typename Iterator>
+	bool ScanNumeral(Iterator& first, const std::type_identity_t<Iterator>& last, NumeralValue* pValue)
+	{
+		constexpr unsigned __int64 maxInteger = static_cast<unsigned __int64>((std::numeric_limits<__int64>::max)());
+
+		Iterator iter = first;
+		unsigned __int64 bits = 0;
+
+		// 16진 정수. 64비트를 넘으면 하위 64비트만 사용한다.
+		if (iter != last && '0' == *iter)
+		{
+			Iterator next = iter;
+			++next;
+			if (next != last && ('x' == *next || 'X' == *next))
+			{
+				++next;
+				if (next != last && IsHexDigitChar(*next))
+				{
+					for (iter = next; iter != last && IsHexDigitChar(*iter); ++iter)
+						bits = (bits << 4) | GetHexDigitValue(*iter);
+
+					if (pValue)
+					{
+						pValue->isInteger = true;
+						pValue->intValue = static_cast<__int64>(bits);
+						pValue->floatValue = 0.0;
+					}
+
+					first = iter;
+					return true;
+				}
+			}
+		}
+
+		// 정수부와 소수부의 숫자를 가수부(bits)에 누적한다. int64 범위를 넘으면 bOverflow.
+		bool bInteger = true;
+		bool bOverflow = false;
+		bool bDigit = false;
+		int fractionDigits = 0;
+		auto accumulate = [&bits, &bOverflow](const unsigned int digit)
+		{
+			if (bOverflow || bits > (maxInteger - digit) / 10)
+				bOverflow = true;
+			else
+				bits = bits * 10 + digit;
+		};
+
+		// 정수부
+		for (; iter != last && IsDigitChar(*iter); ++iter)
+		{
+			accumulate(static_cast<unsigned int>(*iter - '0'));
+			bDigit = true;
+		}
+
+		// 소수부. 정수부가 없으면 '.' 뒤에 숫자가 있어야 한다.
+		if (iter != last && '.' == *iter)
+		{
+			Iterator next = iter;
+			++next;
+			if (bDigit || (next != last && IsDigitChar(*next)))
+			{
+				bInteger = false;
+				for (iter = next; iter != last && IsDigitChar(*iter); ++iter)
+				{
+					accumulate(static_cast<unsigned int>(*iter - '0'));
+					++fractionDigits;
+					bDigit = true;
+				}
+			}
+		}
+
+		if (!bDigit)
+			return false;
+
+		// 지수부
+		int exponent = 0;
+		if (iter != last && ('e' == *iter || 'E' == *iter))
+		{
+			Iterator next = iter;
+			++next;
+
+			bool bNegative = false;
+			if (next != last && ('+' == *next || '-' == *next))
+			{
+				bNegative = ('-' == *next);
+				++next;
+			}
+
+			if (next != last && IsDigitChar(*next))
+			{
+				bInteger = false;
+				for (iter = next; iter != last && IsDigitChar(*iter); ++iter)
+				{
+					if (exponent < 100000)
+						exponent = exponent * 10 + static_cast<int>(*iter - '0');
+				}
+				if (bNegative)
+					exponent = -exponent;
+			}
+		}
+
+		if (pValue)
+		{
+			if (bInteger && !bOverflow)
+			{
+				pValue->isInteger = true;
+				pValue->intValue = static_cast<__int64>(bits);
+				pValue->floatValue = 0.0;
+			}
+			else if (!bOverflow && ConvertFloatNumeralFast(bits, exponent - fractionDigits, pValue->floatValue))
+			{
+				pValue->isInteger = false;
+				pValue->intValue = 0;
+			}
+			else
+			{
+				// 가수부가 큰 실수, 또는 int64 범위를 넘는 10진 정수
+				NumeralText text;
+				for (Iterator copy = first; copy != iter; ++copy)
+					text.Push(static_cast<char>(*copy));
+
+				pValue->isInteger = false;
+				pValue->intValue = 0;
+				pValue->floatValue = ConvertFloatNumeral(text);
+			}
+		}
+
+		first = iter;
+		return true;
+	}
+}
@@ -0,0 +1,439 @@
+﻿#include "pch.h"
+
+#include <random>
+
+#include "ast.h"
+#include "parser.h"
+#include "script_file.h"
+#include "benchmark.h"
+#include "parse_bench.h"
+
+
+// DSL_BENCH_ALLOC_COUNT를 정의하고 빌드하면 allocation 횟수를 세기 위해 전역 operator new를 교체한다.
+// 교체하면 프로그램의 모든 할당이 카운터를 갱신하므로 벤치마크용 빌드에서만 정의한다. 정의하지 않으면 할당 수는 측정하지 않는다.
+// 카운터는 스레드별 변수이므로 여러 스레드가 동시에 할당하더라도 경합이 없다.
+#ifdef DSL_BENCH_ALLOC_COUNT
+static thread_local size_t t_allocCount = 0;
+static thread_local size_t t_allocBytes = 0;
+
+void* operator new(std::size_t size)
+{
+	++t_allocCount;
+	t_allocBytes += size;
+
+	if (0 == size)
+		size = 1;
+
+	while (true)
+	{
+		if (void* p = std::malloc(size))
+			return p;
+
+		std::new_handler handler = std::get_new_handler();
+		if (!handler)
+			throw std::bad_alloc();
+		handler();
+	}
+}
+
+void* operator new[](std::size_t size)
+{
+	return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+#endif
+
+
+namespace dsl
+{
+
+using BenchClock = std::chrono::steady_clock;
+
+// JSON 결과 형식의 버전. 필드가 바뀌면 올린다.
+// 2: 할당 수를 세지 않는 빌드에서는 allocations, allocationsPerKB, allocatedBytes가 null이다.
+static constexpr int g_resultVersion = 2;
+
+// 스크립트 생성기가 사용하는 난수
+// std::mt19937은 모든 플랫폼에서 같은 순서의 값을 만든다. (분포 클래스는 구현마다 결과가 다르므로 사용하지 않는다.)
+class BenchRandom
+{
+public:
+	explicit BenchRandom(const unsigned int seed) : m_engine(seed) {}
+
+	// [0, count) 범위의 값
+	unsigned int Next(const unsigned int count) { return static_cast<unsigned int>(m_engine() % count); }
+
+	// [minValue, maxValue] 범위의 값
+	unsigned int Range(const unsigned int minValue, const unsigned int maxValue) { return minValue + Next(maxValue - minValue + 1); }
+
+private:
+	std::mt19937 m_engine;
+};
+
+static const wchar_t* const g_binaryOperators[] = { L"*", L"/", L"%", L"+", L"-", L"<", L"<=", L">", L">=", L"==", L"!=", L"and", L"or" };
+static const wchar_t* const g_variableNames[] = { L"hp", L"mp", L"level", L"exp", L"gold", L"damage", L"armor", L"speed", L"counter", L"flag" };
+static const wchar_t* const g_functionNames[] = { L"Max", L"Min", L"Clamp", L"Random", L"GetStat", L"HasBuff" };
+static const wchar_t* const g_commentWords[] = { L"플레이어", L"몬스터", L"보상", L"퀘스트", L"스킬", L"쿨타임", L"데미지", L"계산", L"처리", L"확인", L"TODO", L"balance", L"patch", L"note" };
+
+template <typename T, size_t N>
+static const T& pick(BenchRandom& random, const T (&values)[N])
+{
+	return values[random.Next(static_cast<unsigned int>(N))];
+}
+
+// 표현식의 항. 이름, 숫자, bool, 함수 호출
+static void appendOperand(std::wstring& strOut, BenchRandom& random)
+{
+	switch (random.Next(6))
+	{
+	case 0:		strOut += std::format(L"{}{}", pick(random, g_variableNames), random.Next(100)); break;
+	case 1:		strOut += std::format(L"{}", random.Next(100000)); break;
+	case 2:		strOut += std::format(L"{}.{}", random.Next(1000), random.Next(100)); break;
+	case 3:		strOut += random.Next(2) ? L"true" : L"false"; break;
+	case 4:		strOut += std::format(L"{}({})", pick(random, g_functionNames), pick(random, g_variableNames)); break;
+	default:	strOut += pick(random, g_variableNames); break;
+	}
+}
+
+// depth 단계로 중첩된 표현식
+// 한 단계마다 항과 연산자를 하나 추가하고, 나머지 식은 괄호로 감싸거나 그대로 이어서 우선순위가 다른 연산자가 섞이게 한다.
+static void appendExpression(std::wstring& strOut, BenchRandom& random, const unsigned int depth)
+{
+	if (0 == random.Next(5))
+		strOut += random.Next(2) ? L"-" : L"not ";
+
+	if (0 == depth)
+	{
+		appendOperand(strOut, random);
+		return;
+	}
+
+	// 가끔 인자가 2개인 함수 호출로 나눈다.
+	if (depth >= 4 && 0 == random.Next(8))
+	{
+		strOut += std::format(L"{}(", pick(random, g_functionNames));
+		appendExpression(strOut, random, depth / 2);
+		strOut += L", ";
+		appendExpression(strOut, random, depth / 2);
+		strOut += L")";
+		return;
+	}
+
+	appendOperand(strOut, random);
+	strOut += std::format(L" {} ", pick(random, g_binaryOperators));
+
+	if (random.Next(2))
+	{
+		strOut += L"(";
+		appendExpression(strOut, random, depth - 1);
+		strOut += L")";
+	}
+	else
+	{
+		appendExpression(strOut, random, depth - 1);
+	}
+}
+
+// 작업별 구문 1개. index는 구문 번호이다.
+static void appendWorkloadStatement(std::wstring& strOut, const EBenchWorkload eWorkload, BenchRandom& random, const size_t index)
+{
+	switch (eWorkload)
+	{
+	case EBenchWorkload::Expression:
+	{
+		strOut += std::format(L"expr{} = ", index);
+		appendExpression(strOut, random, random.Range(16, 32));
+		strOut += L"\n";
+	}
+	break;
+
+	case EBenchWorkload::Function:
+	{
+		const wchar_t* var = pick(random, g_variableNames);
+		strOut += std::format(L"function handler{}(a, b, c)\n", index);
+		strOut += std::format(L"    {} = a + b * {}\n", var, random.Next(100));
+		if (random.Next(2))
+		{
+			strOut += std::format(L"    if {} > c and not flag then\n", var);
+			strOut += std::format(L"        Notify(\"event_{}\", {})\n", random.Next(50), var);
+			strOut += L"        counter = counter + 1\n";
+			strOut += L"    end\n";
+		}
+		strOut += std::format(L"    result{} = {}({}, c)\n", index, pick(random, g_functionNames), var);
+		strOut += L"end\n";
+		strOut += std::format(L"handler{}({}, {}, -{})\n", index, random.Next(1000), pick(random, g_variableNames), random.Next(10));
+	}
+	break;
+
+	case EBenchWorkload::Table:
+	{
+		strOut += std::format(L"item{} = Item({}, \"item.name.{}\", {}.{}, {}, 0x{:X}, -{}, Row(\"grade_{}\", {}, {}.{}e-{}))\n",
+			index, index, random.Next(500), random.Next(10000), random.Next(100), random.Next(2) ? L"true" : L"false", random.Next(0x10000), random.Next(1000),
+			random.Next(5), random.Next(100), random.Next(10), random.Next(1000), random.Range(1, 9));
+	}
+	break;
+
+	case EBenchWorkload::Comment:
+	{
+		strOut += std::format(L"-- ===== section {} =====\n", index);
+		const unsigned int nLine = random.Range(3, 8);
+		for (unsigned int line = 0; line < nLine; ++line)
+		{
+			strOut += L"--";
+			const unsigned int nWord = random.Range(4, 12);
+			for (unsigned int word = 0; word < nWord; ++word)
+				strOut += std::format(L" {}", pick(random, g_commentWords));
+			strOut += L"\n";
+		}
+		strOut += L"\n";
+		strOut += std::format(L"value{} = {} -- {}\n", index, random.Next(1000), pick(random, g_commentWords));
+		if (0 == random.Next(4))
+			strOut += L"\n\n";
+	}
+	break;
+
+	default:
+		break;
+	}
+}
+
+const wchar_t* GetWorkloadName(const EBenchWorkload eWorkload)
+{
+	switch (eWorkload)
+	{
+	case EBenchWorkload::Expression:	return L"expr";
+	case EBenchWorkload::Function:		return L"function";
+	case EBenchWorkload::Table:			return L"table";
+	case EBenchWorkload::Comment:		return L"comment";
+	default:							return L"unknown";
+	}
+}
+
+// 구문은 wchar_t 문자열로 만들고 일정 크기마다 UTF-8로 변환해서 붙인다.
+// 500MB 스크립트를 만들 때 wchar_t 문자열 전체를 메모리에 두지 않기 위해서이다.
+std::string MakeWorkloadScript(const EBenchWorkload eWorkload, const size_t targetLength, const unsigned int seed /*= 1*/)
+{
+	constexpr size_t flushLength = 64 * 1024;
+
+	BenchRandom random(seed);
+
+	std::string strScript;
+	strScript.reserve(targetLength + flushLength);
+
+	std::wstring strChunk;
+	for (size_t index = 0; strScript.size() < targetLength; ++index)
+	{
+		appendWorkloadStatement(strChunk, eWorkload, random, index);
+		// UTF-8은 wchar_t 1개당 최대 3바이트이다. 목표 크기에 가까워지면 구문마다 변환해서 크기를 넘지 않게 한다.
+		if (strChunk.size() >= flushLength || strScript.size() + strChunk.size() * 3 >= targetLength)
+		{
+			strScript += WideToUtf8(strChunk);
+			strChunk.clear();
+		}
+	}
+
+	return strScript;
+}
+
+bool IsAllocationCountEnabled()
+{
+#ifdef DSL_BENCH_ALLOC_COUNT
+	return true;
+#else
+	return false;
+#endif
+}
+
+size_t GetThreadAllocationCount()
+{
+#ifdef DSL_BENCH_ALLOC_COUNT
+	return t_allocCount;
+#else
+	return 0;
+#endif
+}
+
+size_t GetThreadAllocationBytes()
+{
+#ifdef DSL_BENCH_ALLOC_COUNT
+	return t_allocBytes;
+#else
+	return 0;
+#endif
+}
+
+
+// 작업 1개의 측정 결과
+struct ParseBenchResult
+{
+	EBenchWorkload eWorkload = EBenchWorkload::Count;
+	bool bSuccess = false;
+	size_t inputBytes = 0;
+	size_t iterationCount = 0;
+	double seconds = 0.0;			// 파싱 1회의 평균 시간
+	size_t nodeCount = 0;			// AST 노드 수
+	size_t allocationCount = 0;		// 파싱 1회의 operator new 호출 수
+	size_t allocationBytes = 0;		// 파싱 1회에 요청한 바이트 수
+	size_t peakMemoryBytes = 0;		// 측정을 마친 시점의 프로세스 최대 메모리 사용량
+};
+
+// AST 노드 수. 루트(AST) 노드를 포함한다.
+static size_t countNodes(const ASTCPtr& spAST)
+{
+	if (!spAST)
+		return 0;
+
+	size_t nNode = 1;
+	spAST->Iterate([&nNode](const BaseCPtr& spBase)
+		{
+			if (spBase)
+				++nNode;
+		});
+	return nNode;
+}
+
+// 스크립트를 반복해서 파싱하고 평균을 기록한다.
+// 작은 스크립트는 시간을 측정할 수 있도록 전체 시간이 minSeconds를 넘을 때까지 반복한다. 할당 수는 모든 반복에서 같으므로 첫 번째 파싱에서 센다.
+static ParseBenchResult measureWorkload(const EBenchWorkload eWorkload, const std::string& strUtf8, const EParserBackend eBackend)
+{
+	constexpr double minSeconds = 0.2;
+	constexpr size_t maxIteration = 10000;
+
+	ParseBenchResult result;
+	result.eWorkload = eWorkload;
+	result.inputBytes = strUtf8.size();
+
+	// Spirit 백엔드는 wchar_t 문자열만 파싱한다. 변환 시간은 측정에서 제외한다.
+	const std::wstring strWide = EParserBackend::Token == eBackend ? std::wstring() : Utf8ToWide(strUtf8);
+
+	ParserContext& context = ParserContext::GetThreadInstance();
+
+	// 파싱 실패 메시지가 JSON 결과에 섞이지 않도록 출력을 버린다.
+	std::wostringstream discard;
+	std::wstreambuf* pOriginal = std::wcout.rdbuf(discard.rdbuf());
+
+	double totalSeconds = 0.0;
+	while (result.iterationCount < maxIteration && (0 == result.iterationCount || totalSeconds < minSeconds))
+	{
+		const size_t allocCount = GetThreadAllocationCount();
+		const size_t allocBytes = GetThreadAllocationBytes();
+
+		const BenchClock::time_point start = BenchClock::now();
+		ASTPtr spAST = EParserBackend::Token == eBackend ? context.Parse(std::string_view(strUtf8)) : context.Parse(strWide, eBackend);
+		totalSeconds += std::chrono::duration<double>(BenchClock::now() - start).count();
+
+		if (0 == result.iterationCount)
+		{
+			result.allocationCount = GetThreadAllocationCount() - allocCount;
+			result.allocationBytes = GetThreadAllocationBytes() - allocBytes;
+			result.bSuccess = spAST != nullptr;
+			result.nodeCount = countNodes(spAST);
+			result.peakMemoryBytes = GetPeakMemoryUsage();
+		}
+		++result.iterationCount;
+
+		if (!spAST)
+			break;
+	}
+
+	std::wcout.rdbuf(pOriginal);
+
+	result.seconds = totalSeconds / static_cast<double>(result.iterationCount);
+	return result;
+}
+
+static std::wstring toJson(const ParseBenchResult& result)
+{
+	const double inputMB = static_cast<double>(result.inputBytes) / (1024.0 * 1024.0);
+	const double inputKB = static_cast<double>(result.inputBytes) / 1024.0;
+	const double seconds = (std::max)(result.seconds, 1e-9);
+
+	// 할당 수를 세지 않는 빌드에서는 0 대신 null을 출력한다.
+	const bool bAllocationCounted = IsAllocationCountEnabled();
+	const std::wstring strAllocations = bAllocationCounted ? std::format(L"{}", result.allocationCount) : L"null";
+	const std::wstring strAllocationsPerKB = bAllocationCounted ? std::format(L"{:.3f}", 0 == result.inputBytes ? 0.0 : result.allocationCount / inputKB) : L"null";
+	const std::wstring strAllocatedBytes = bAllocationCounted ? std::format(L"{}", result.allocationBytes) : L"null";
+
+	return std::format(L"{{\"workload\": \"{}\", \"ok\": {}, \"inputBytes\": {}, \"iterations\": {}, \"seconds\": {:.6f}, \"mbPerSec\": {:.3f}, "
+		L"\"nodes\": {}, \"nodesPerSec\": {:.0f}, \"allocations\": {}, \"allocationsPerKB\": {}, \"allocatedBytes\": {}, \"peakMemoryBytes\": {}}}",
+		GetWorkloadName(result.eWorkload), result.bSuccess ? L"true" : L"false", result.inputBytes, result.iterationCount, result.seconds, inputMB / seconds,
+		result.nodeCount, result.nodeCount / seconds, strAllocations, strAllocationsPerKB, strAllocatedBytes, result.peakMemoryBytes);
+}
+
+int RunParseBenchSuite(const std::vector<std::wstring>& args)
+{
+	constexpr size_t maxScriptKB = 500 * 1024;
+
+	const std::wstring workloadName = 0 < args.size() ? args[0] : L"all";
+	const size_t scriptKB = 1 < args.size() ? static_cast<size_t>(std::stoull(args[1])) : 1024;
+	const std::wstring backendName = 2 < args.size() ? args[2] : L"token";
+	const unsigned int seed = 3 < args.size() ? static_cast<unsigned int>(std::stoul(args[3])) : 1;
+
+	if (scriptKB < 1 || scriptKB > maxScriptKB)
+	{
+		std::wcout << std::format(L"script size must be 1 ~ {} KB. size={}", maxScriptKB, scriptKB) << std::endl;
+		return 1;
+	}
+
+	EParserBackend eBackend = EParserBackend::Token;
+	if (L"spirit" == backendName)
+		eBackend = EParserBackend::Spirit;
+	else if (L"x3" == backendName)
+		eBackend = EParserBackend::SpiritX3;
+	else if (L"token" != backendName)
+	{
+		std::wcout << std::format(L"unknown backend. backend={}", backendName) << std::endl;
+		return 1;
+	}
+
+	std::vector<EBenchWorkload> workloads;
+	for (int i = 0; i < static_cast<int>(EBenchWorkload::Count); ++i)
+	{
+		const EBenchWorkload eWorkload = static_cast<EBenchWorkload>(i);
+		if (L"all" == workloadName || workloadName == GetWorkloadName(eWorkload))
+			workloads.push_back(eWorkload);
+	}
+	if (workloads.empty())
+	{
+		std::wcout << std::format(L"unknown workload. workload={}", workloadName) << std::endl;
+		return 1;
+	}
+
+	// 최대 메모리 사용량은 프로세스 단위이므로 작업을 하나씩 실행해야 작업별로 비교할 수 있다.
+	std::wcout << std::format(L"{{\"suite\": \"dsl_parse_bench\", \"version\": {}, \"backend\": \"{}\", \"scriptKB\": {}, \"seed\": {}, \"results\": [", g_resultVersion, backendName, scriptKB, seed) << std::endl;
+
+	bool bSuccess = true;
+	for (size_t i = 0; i < workloads.size(); ++i)
+	{
+		const std::string strScript = MakeWorkloadScript(workloads[i], scriptKB * 1024, seed);
+		const ParseBenchResult result = measureWorkload(workloads[i], strScript, eBackend);
+		bSuccess = bSuccess && result.bSuccess;
+
+		std::wcout << L"  " << toJson(result) << (i + 1 < workloads.size() ? L"," : L"") << std::endl;
+	}
+
+	std::wcout << L"]}" << std::endl;
+
+	return bSuccess ? 0 : 1;
+}
+
+}
@@ -0,0 +1,48 @@
+﻿#pragma once
+
+/*
+파서 처리량 벤치마크 모음. ("bench parse")
+고정된 seed로 스크립트를 생성하므로 같은 인자로 실행하면 항상 같은 입력을 파싱한다.
+결과는 JSON으로 출력해서 변경 전후의 결과를 비교할 수 있게 한다.
+
+작업 종류
+  expr     : 깊게 중첩된 표현식. 괄호, 단항 연산자, 모든 우선순위의 이항 연산자, 함수 호출
+  function : 작은 함수가 많은 스크립트. 함수 선언, if문, 할당, 함수 호출
+  table    : 큰 데이터 테이블. 숫자(정수, 실수, 16진수), 문자열, bool 리터럴
+  comment  : 주석이 많은 스크립트. 여러 줄의 주석과 빈 줄 사이에 구문이 드물게 있다.
+*/
+
+namespace dsl
+{
+	// 벤치마크 작업 종류
+	enum class EBenchWorkload
+	{
+		Expression,
+		Function,
+		Table,
+		Comment,
+
+		Count
+	};
+
+	// 작업 이름. JSON 결과와 명령행 인자에서 사용한다.
+	const wchar_t* GetWorkloadName(const EBenchWorkload eWorkload);
+
+	// 벤치마크용 UTF-8 스크립트 생성. 대략 targetLength 바이트가 될 때까지 구문을 반복한다.
+	// 같은 seed이면 항상 같은 스크립트를 만든다.
+	std::string MakeWorkloadScript(const EBenchWorkload eWorkload, const size_t targetLength, const unsigned int seed = 1);
+
+	// 파서 처리량 벤치마크 모음 실행. 결과를 JSON으로 출력한다.
+	// @args	: [workload=all] [KB=1024] [backend=token] [seed=1]
+	//			  workload는 expr, function, table, comment, all 중 하나이고, KB는 1부터 512000(500MB)까지이다.
+	//			  backend는 token, spirit, x3 중 하나이다. spirit과 x3은 wchar_t 문자열로 변환해서 파싱하며, 변환 시간은 포함하지 않는다.
+	// @return	: 프로세스 종료 코드
+	int RunParseBenchSuite(const std::vector<std::wstring>& args);
+
+	// 할당 수를 세는 빌드인지 여부. DSL_BENCH_ALLOC_COUNT를 정의하고 빌드해야 전역 operator new를 교체해서 할당 수를 센다.
+	bool IsAllocationCountEnabled();
+
+	// 현재 스레드에서 지금까지 operator new를 호출한 횟수와 요청한 바이트 수. 할당 수를 세지 않는 빌드에서는 항상 0이다.
+	size_t GetThreadAllocationCount();
+	size_t GetThreadAllocationBytes();
+}
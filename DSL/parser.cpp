@@ -1,6 +1,11 @@
 ﻿#include "pch.h"
 
+// 파서 트레이스
+// DSL_PARSER_TRACE를 정의하고 빌드하면 BOOST_SPIRIT_DEBUG로 모든 rule 시도를 std::cerr에 출력한다.
+// 파싱이 매우 느려지므로 기본값은 꺼져있다. rule별 통계만 필요하면 ParserContext::SetProfile을 사용한다.
+#ifdef DSL_PARSER_TRACE
 #define BOOST_SPIRIT_DEBUG
+#endif
 
 #include <boost/fusion/include/adapt_struct.hpp>
 #include <boost/spirit/include/qi.hpp>
@@ -11,6 +16,7 @@
 #include <boost/spirit/include/qi_operator.hpp>
 #include <boost/spirit/include/qi_auto.hpp>
 #include <boost/phoenix.hpp>
+#include <boost/iterator/iterator_adaptor.hpp>
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -20,7 +26,12 @@
 #include <chrono>
 
 #include "ast.h"
+#include "numeral.h"
+#include "lexer.h"
+#include "token_parser.h"
+#include "script_file.h"
 #include "parser.h"
+#include "parser_x3.h"
 
 using namespace boost::spirit;
 
@@ -34,11 +45,9 @@ using qi::ascii::alnum;
 using namespace boost::phoenix;
 using boost::phoenix::push_back;
 using boost::phoenix::ref;
-using boost::phoenix::construct;
-using boost::phoenix::new_;
 using boost::phoenix::bind;
 
-BOOST_FUSION_ADAPT_STRUCT(dsl::Name, name)
+BOOST_FUSION_ADAPT_STRUCT(dsl::Name, id)
 BOOST_FUSION_ADAPT_STRUCT(dsl::NameList, names)
 BOOST_FUSION_ADAPT_STRUCT(dsl::Numeral, isInteger, intValue, floatValue)
 BOOST_FUSION_ADAPT_STRUCT(dsl::Boolean, value)
@@ -62,8 +71,173 @@ BOOST_FUSION_ADAPT_STRUCT(dsl::While, expression, statDo)
 BOOST_FUSION_ADAPT_STRUCT(dsl::If, expression, block, statIf)
 BOOST_FUSION_ADAPT_STRUCT(dsl::For, name, expression1, expression2, expression3)
 
+// 숫자 리터럴 파서
+// ScanNumeral로 정수와 실수를 한 번에 구분한다. qi::double_ 과 qi::long_long을 차례로 시도하지 않는다.
+// grammar에서 dsl::numeral_ 터미널로 사용한다.
 namespace dsl
 {
+    BOOST_SPIRIT_TERMINAL(numeral_)
+
+    struct numeral_parser : qi::primitive_parser<numeral_parser>
+    {
+        template <typename Context, typename Iterator>
+        struct attribute
+        {
+            using type = NumeralValue;
+        };
+
+        template <typename Iterator, typename Context, typename Skipper, typename Attribute>
+        bool parse(Iterator& first, const Iterator& last, Context&, const Skipper& skipper, Attribute& attr) const
+        {
+            qi::skip_over(first, last, skipper);
+
+            NumeralValue value;
+            if (!ScanNumeral(first, last, &value))
+                return false;
+
+            traits::assign_to(value, attr);
+            return true;
+        }
+
+        template <typename Context>
+        info what(Context&) const
+        {
+            return info("numeral");
+        }
+    };
+}
+
+namespace boost { namespace spirit
+{
+    template <>
+    struct use_terminal<qi::domain, dsl::tag::numeral_> : mpl::true_ {};
+
+    namespace qi
+    {
+        template <typename Modifiers>
+        struct make_primitive<dsl::tag::numeral_, Modifiers>
+        {
+            using result_type = dsl::numeral_parser;
+
+            result_type operator()(unused_type, unused_type) const
+            {
+                return result_type();
+            }
+        };
+    }
+}}
+
+namespace dsl
+{
+
+// 읽은 문자 수를 세는 반복자
+// grammar가 백트래킹으로 같은 위치를 다시 읽으면 그만큼 다시 센다. ParseStats::scannedLength 측정용.
+template <typename BaseIterator>
+class scan_count_iterator : public boost::iterator_adaptor<scan_count_iterator<BaseIterator>, BaseIterator, boost::use_default, boost::forward_traversal_tag>
+{
+public:
+    scan_count_iterator() : m_pCount(nullptr) {}
+    scan_count_iterator(const BaseIterator& iter, size_t* pCount) : scan_count_iterator::iterator_adaptor_(iter), m_pCount(pCount) {}
+
+    // 지금까지 읽은 문자 수
+    size_t GetScanCount() const { return *m_pCount; }
+
+private:
+    friend class boost::iterator_core_access;
+
+    void increment()
+    {
+        ++this->base_reference();
+        ++*m_pCount;
+    }
+
+    size_t* m_pCount;
+};
+
+// 숫자 노드 생성
+struct make_numeral_impl
+{
+    using result_type = BasePtr;
+
+    BasePtr operator()(const NumeralValue& value) const
+    {
+        if (value.isInteger)
+            return MakeNode<Numeral>(value.intValue);
+        return MakeNode<Numeral>(value.floatValue);
+    }
+};
+static const boost::phoenix::function<make_numeral_impl> make_numeral;
+
+// AST 노드 생성
+// 현재 스레드의 아레나가 있으면 아레나에 할당한다. (MakeNode)
+template <typename T>
+struct make_node_impl
+{
+    using result_type = std::shared_ptr<T>;
+
+    template <typename... Args>
+    std::shared_ptr<T> operator()(const Args&... args) const
+    {
+        return MakeNode<T>(args...);
+    }
+};
+template <typename T>
+static const boost::phoenix::function<make_node_impl<T>> make_node{};
+
+// rule 프로파일
+// 프로파일용 grammar의 모든 rule이 공유한다. rule은 중첩해서 호출되므로 시작 시각과 읽은 문자 수를 스택에 쌓는다.
+struct RuleProfile
+{
+    struct Frame
+    {
+        std::chrono::steady_clock::time_point start;
+        size_t scanCount;
+    };
+
+    std::vector<RuleStats> ruleStats;
+    std::vector<unsigned int> activeCount;     // rule별 실행 중인 호출 수. 재귀 호출의 시간을 중복해서 더하지 않기 위해 사용한다.
+    std::vector<Frame> stack;
+
+    void Reset()
+    {
+        for (RuleStats& stats : ruleStats)
+            stats = RuleStats{ std::move(stats.name) };
+        activeCount.assign(ruleStats.size(), 0);
+        stack.clear();
+    }
+};
+
+// rule 프로파일러
+// qi::debug로 rule에 연결한다. rule을 시도하면 pre_parse, 끝나면 successful_parse 또는 failed_parse 상태로 호출된다.
+// 실패한 rule의 반복자는 시작 위치로 되돌아가 있으므로, 읽은 문자 수로 입력을 읽은 다음 실패했는지 확인한다.
+struct rule_profiler
+{
+    RuleProfile* pProfile;
+    size_t index;
+
+    template <typename Iterator, typename Context, typename State>
+    void operator()(const Iterator& first, const Iterator&, const Context&, const State state, const std::string&) const
+    {
+        if (qi::pre_parse == state)
+        {
+            ++pProfile->activeCount[index];
+            pProfile->stack.push_back(RuleProfile::Frame{ std::chrono::steady_clock::now(), first.GetScanCount() });
+            return;
+        }
+
+        const RuleProfile::Frame frame = pProfile->stack.back();
+        pProfile->stack.pop_back();
+
+        RuleStats& stats = pProfile->ruleStats[index];
+        ++stats.attemptCount;
+        if (0 == --pProfile->activeCount[index])
+            stats.elapsedUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - frame.start).count();
+        if (qi::successful_parse == state)
+            ++stats.successCount;
+        else if (first.GetScanCount() != frame.scanCount)
+            ++stats.backtrackCount;
+    }
+};
 
 // '공백'과 '-- 주석'을 무시하도록 스키퍼 정의
 template <typename Iterator>
@@ -87,82 +261,75 @@ struct dsl_grammar : qi::grammar<Iterator, ASTPtr(), skipper<Iterator>> {
             ("for", "for")("in", "in")("function", "function")("local", "local")("false", "false")("true", "true");
 
         // 1순위 단항 연산자 정의
-        symbol1OperatorUnary.add("not", "not")("-", "-");
+        symbol1OperatorUnary.add("not", EOperator::Not)("-", EOperator::Neg);
 
         // 2순위 이항 연산자 정의
-        symbol2OperatorBinary.add("*", "*")("/", "/")("%", "%");
+        symbol2OperatorBinary.add("*", EOperator::Mul)("/", EOperator::Div)("%", EOperator::Mod);
 
         // 3순위 이항 연산자 정의
-        symbol3OperatorBinary.add("+", "+")("-", "-");
+        symbol3OperatorBinary.add("+", EOperator::Add)("-", EOperator::Sub);
 
         // 4순위 이항 연산자 정의
-        symbol4OperatorBinary.add("<", "<")(">", ">")("<=", "<=")(">=", ">=");
+        symbol4OperatorBinary.add("<", EOperator::Less)(">", EOperator::Greater)("<=", EOperator::LessEqual)(">=", EOperator::GreaterEqual);
 
         // 5순위 이항 연산자 정의
-        symbol5OperatorBinary.add("==", "==")("!=", "!=");
+        symbol5OperatorBinary.add("==", EOperator::Equal)("!=", EOperator::NotEqual);
 
         // 6순위 이항 연산자 정의
-        symbol6OperatorBinary.add("and", "and");
+        symbol6OperatorBinary.add("and", EOperator::And);
 
         // 7순위 이항 연산자 정의
-        symbol7OperatorBinary.add("or", "or");
+        symbol7OperatorBinary.add("or", EOperator::Or);
 
         // 8순위 단항 연산자 정의
-        symbol8OperatorBinary.add("*=", "*=")("/=", "/=")("+=", "+=")("-=", "-=");
+        symbol8OperatorBinary.add("*=", EOperator::MulAssign)("/=", EOperator::DivAssign)("+=", EOperator::AddAssign)("-=", EOperator::SubAssign);
 
 
         // 이름(식별자) 규칙
         // 첫 글자는 알파벳 또는 언더스코어. 나머지 글자는 알파벳 or 숫자 or 언더스코어. 그리고 symbolKeyword에 포함되는 이름이면 안됨.
-        ruleName = lexeme[qi::as<std::wstring>()[(qi::alpha | qi::char_('_')) >> *(qi::alnum | qi::char_('_'))] - (symbolKeyword >> !(qi::alnum | qi::char_('_')))][_val = construct<BasePtr>(new_<Name>(_1))];
+        ruleName = lexeme[qi::as<std::wstring>()[(qi::alpha | qi::char_('_')) >> *(qi::alnum | qi::char_('_'))] - (symbolKeyword >> !(qi::alnum | qi::char_('_')))][_val = make_node<Name>(_1)];
 
         // 이름 리스트 규칙
         // 콤마로 구분되는 이름 리스트
-        ruleNameList = (ruleName % ',')[_val = construct<BasePtr>(new_<NameList>(_1))];
+        ruleNameList = (ruleName % ',')[_val = make_node<NameList>(_1)];
 
         // bool 규칙
-        // true 또는 false
-        ruleBoolean = lit("false")[_val = construct<BasePtr>(new_<Boolean>(false))] 
-                    | lit("true")[_val = construct<BasePtr>(new_<Boolean>(true))];
+        // true 또는 false. trueValue 같은 이름의 앞부분과 매칭되지 않도록 뒤에 이름 글자가 이어지면 안됨.
+        ruleBoolean = lexeme[lit("false") >> !(qi::alnum | qi::char_('_'))][_val = make_node<Boolean>(false)] 
+                    | lexeme[lit("true") >> !(qi::alnum | qi::char_('_'))][_val = make_node<Boolean>(true)];
 
         // 문자열 규칙
         // " " 로 둘러쌓인 문자열
-        ruleLiteralString = lexeme[qi::as<std::wstring>()['"' >> *(qi::char_ - '"') >> '"']][_val = construct<BasePtr>(new_<LiteralString>(_1))];
-
-        // 정수 규칙
-        ruleInteger = qi::long_long[_val = construct<BasePtr>(new_<Numeral>(_1))];
-
-        // 실수 규칙
-        ruleFloat = qi::double_[_val = construct<BasePtr>(new_<Numeral>(_1))];
+        ruleLiteralString = lexeme[qi::as<std::wstring>()['"' >> *(qi::char_ - '"') >> '"']][_val = make_node<LiteralString>(_1)];
 
         // 숫자 규칙
-        // 실수를 먼저 시도하고, 실패하면 정수로 파싱. 이는 "3.14"와 같은 실수가 "3"과 "14"로 분리되는 것을 방지
-        // 현재 문제: 모든 숫자가 실수로 파싱됨.
-        ruleNumeral = ruleFloat | ruleInteger;
+        // 정수("123", "0x1F")와 실수("3.14", ".5", "1e10")를 한 번에 구분해서 파싱.
+        // 예전 qi::double_ 규칙과 같이 바로 앞에 붙은 '+' 부호("+5")를 허용한다. '-'는 단항 연산자로 파싱한다.
+        ruleNumeral = lexeme[-lit('+') >> numeral_][_val = make_numeral(_1)];
 
         // 최하위 표현식 규칙
         // 이름, 숫자, bool, 문자열, 괄호로 둘러쌓인 표현식
-        // 참고: 순서가 유의미함. FunctionCall은 Name 앞에 있어야 test() 같은 문자열이 함수호출로 제대로 인식됨. 그리고 "(ruleExpression)" 은 가장 마지막에 있어야 함.
+        // 참고: 이름과 함수호출은 ruleNameOrFunctionCall 하나로 처리하므로 이름을 두 번 파싱하지 않음. 그리고 "(ruleExpression)" 은 가장 마지막에 있어야 함.
         rulePrimaryExpression =   ruleNumeral[_val = _1] 
                                 | ruleBoolean[_val = _1]
                                 | ruleLiteralString[_val = _1]
-                                | ruleFunctionCall[_val = _1]
-                                | ruleName[_val = _1]
+                                | ruleNameOrFunctionCall[_val = _1]
                                 | (lit('(') >> ruleExpression >> lit(')'))[_val = _1];
 
         // 1순위 단항연산자 표현식 규칙
         // 단항연산자 표현식을 먼저 검사하고, 매칭되지 않는다면 최하위 표현식인지 검사한다.
-        rule1OperatorUnary = (qi::as<std::wstring>()[symbol1OperatorUnary] >> rulePrimaryExpression)[_val = construct<BasePtr>(new_<UnaryExpression>(_1, _2))]
+        rule1OperatorUnary = (symbol1OperatorUnary >> rulePrimaryExpression)[_val = make_node<UnaryExpression>(_1, _2)]
                                 | rulePrimaryExpression[_val = _1];
 
         // 우선순위별 이항연산자 표현식 규칙
         // 각각의 규칙은 자신보다 우선순위가 높은 규칙을 먼저 검사한다. 우선순위가 가장 높은 규칙이 가장 먼저 검사되도록 하기 위해서이다.
-        rule2OperatorBinary = rule1OperatorUnary[_val = _1]  >> *(qi::as<std::wstring>()[symbol2OperatorBinary] >> rule1OperatorUnary) [_val = construct<BasePtr>(new_<BinaryExpression>(_val, _1, _2))];
-        rule3OperatorBinary = rule2OperatorBinary[_val = _1] >> *(qi::as<std::wstring>()[symbol3OperatorBinary] >> rule2OperatorBinary)[_val = construct<BasePtr>(new_<BinaryExpression>(_val, _1, _2))];
-        rule4OperatorBinary = rule3OperatorBinary[_val = _1] >> *(qi::as<std::wstring>()[symbol4OperatorBinary] >> rule3OperatorBinary)[_val = construct<BasePtr>(new_<BinaryExpression>(_val, _1, _2))];
-        rule5OperatorBinary = rule4OperatorBinary[_val = _1] >> *(qi::as<std::wstring>()[symbol5OperatorBinary] >> rule4OperatorBinary)[_val = construct<BasePtr>(new_<BinaryExpression>(_val, _1, _2))];
-        rule6OperatorBinary = rule5OperatorBinary[_val = _1] >> *(qi::as<std::wstring>()[symbol6OperatorBinary] >> rule5OperatorBinary)[_val = construct<BasePtr>(new_<BinaryExpression>(_val, _1, _2))];
-        rule7OperatorBinary = rule6OperatorBinary[_val = _1] >> *(qi::as<std::wstring>()[symbol7OperatorBinary] >> rule6OperatorBinary)[_val = construct<BasePtr>(new_<BinaryExpression>(_val, _1, _2))];
-        rule8OperatorBinary = rule7OperatorBinary[_val = _1] >> *(qi::as<std::wstring>()[symbol8OperatorBinary] >> rule7OperatorBinary)[_val = construct<BasePtr>(new_<BinaryExpression>(_val, _1, _2))];
+        rule2OperatorBinary = rule1OperatorUnary[_val = _1]  >> *(symbol2OperatorBinary >> rule1OperatorUnary) [_val = make_node<BinaryExpression>(_val, _1, _2)];
+        rule3OperatorBinary = rule2OperatorBinary[_val = _1] >> *(symbol3OperatorBinary >> rule2OperatorBinary)[_val = make_node<BinaryExpression>(_val, _1, _2)];
+        rule4OperatorBinary = rule3OperatorBinary[_val = _1] >> *(symbol4OperatorBinary >> rule3OperatorBinary)[_val = make_node<BinaryExpression>(_val, _1, _2)];
+        rule5OperatorBinary = rule4OperatorBinary[_val = _1] >> *(symbol5OperatorBinary >> rule4OperatorBinary)[_val = make_node<BinaryExpression>(_val, _1, _2)];
+        rule6OperatorBinary = rule5OperatorBinary[_val = _1] >> *(symbol6OperatorBinary >> rule5OperatorBinary)[_val = make_node<BinaryExpression>(_val, _1, _2)];
+        rule7OperatorBinary = rule6OperatorBinary[_val = _1] >> *(symbol7OperatorBinary >> rule6OperatorBinary)[_val = make_node<BinaryExpression>(_val, _1, _2)];
+        rule8OperatorBinary = rule7OperatorBinary[_val = _1] >> *(symbol8OperatorBinary >> rule7OperatorBinary)[_val = make_node<BinaryExpression>(_val, _1, _2)];
 
         // 표현식 규칙
         // 표현식은 단항 연산자, 이항 연산자, 이름, 숫자, bool, 함수 호출 등을 말한다.
@@ -170,74 +337,100 @@ struct dsl_grammar : qi::grammar<Iterator, ASTPtr(), skipper<Iterator>> {
 
         // 표현식 리스트 규칙
         // 콤마로 구분되는 표현식 리스트
-        ruleExpressionList = (ruleExpression % ',')[_val = construct<BasePtr>(new_<ExpressionList>(_1))];
+        ruleExpressionList = (ruleExpression % ',')[_val = make_node<ExpressionList>(_1)];
 
         // 함수 선언 규칙
         // "function 함수이름 함수파라미터 함수본문 end"
-        ruleFunctionDefinition = (lit("function") >> ruleName >> ruleFunctionParameter >> ruleBlock >> lit("end"))[_val = construct<BasePtr>(new_<FunctionDefinition>(_1, _2, _3))];
+        ruleFunctionDefinition = (lit("function") >> ruleName >> ruleFunctionParameter >> ruleBlock >> lit("end"))[_val = make_node<FunctionDefinition>(_1, _2, _3)];
 
         // 함수 파라미터 규칙
         // "( )" 또는 "( 파라미터 리스트 )"
-        ruleFunctionParameter = (lit('(') >> lit(')'))[_val = construct<BasePtr>(new_<FunctionParameter>())]
-                              | (lit('(') >> ruleNameList >> lit(')'))[_val = construct<BasePtr>(new_<FunctionParameter>(_1))];
+        ruleFunctionParameter = (lit('(') >> lit(')'))[_val = make_node<FunctionParameter>()]
+                              | (lit('(') >> ruleNameList >> lit(')'))[_val = make_node<FunctionParameter>(_1)];
 
         // 함수 인자 규칙
         // "( )" 또는 "( 인자 리스트 )"
-        ruleFunctionArgument = (lit('(') >> lit(')'))[_val = construct<BasePtr>(new_<FunctionArgument>())]
-                              | (lit('(') >> ruleExpressionList >> lit(')'))[_val = construct<BasePtr>(new_<FunctionArgument>(_1))];
+        ruleFunctionArgument = (lit('(') >> lit(')'))[_val = make_node<FunctionArgument>()]
+                              | (lit('(') >> ruleExpressionList >> lit(')'))[_val = make_node<FunctionArgument>(_1)];
 
-        // 함수 호출 규칙
-        // "함수이름 함수인자"
-        ruleFunctionCall = (ruleName >> ruleFunctionArgument)[_val = construct<BasePtr>(new_<FunctionCall>(_1, _2))];
+        // 이름 또는 함수 호출 규칙
+        // "이름" 또는 "함수이름 함수인자". 이름을 먼저 파싱하고, 함수인자가 이어지면 함수 호출 노드로 감싼다.
+        ruleNameOrFunctionCall = ruleName[_val = _1] >> -ruleFunctionArgument[_val = make_node<FunctionCall>(_val, _1)];
         
-        // 변수 할당 규칙
-        // "변수이름 = 표현식"
-        ruleAssignment = (ruleName >> lit('=') >> ruleExpression)[_val = construct<BasePtr>(new_<Assignment>(_1, _2))];
+        // 변수 할당 미리 읽기 규칙
+        // 이름 다음에 '='가 오는지('=='는 제외)만 확인한다. 속성이 없으므로 ruleName과 달리 문자열과 Name 노드를 만들지 않는다.
+        ruleAssignmentLookahead = lexeme[((qi::alpha | qi::char_('_')) >> *(qi::alnum | qi::char_('_'))) - (symbolKeyword >> !(qi::alnum | qi::char_('_')))] >> lit('=') >> !lit('=');
+
+        // 변수 할당 또는 표현식 규칙
+        // "변수이름 = 표현식" 또는 "표현식". 이름 다음에 '='가 오는지 먼저 확인하고, 그런 경우만 변수 할당으로 파싱한다.
+        // 변수 할당을 시도했다가 실패한 다음 표현식을 처음부터 다시 파싱하지 않도록, 미리 읽는 부분은 이름과 '=' 뿐이다.
+        // 괄호로 감싼 이름 "(a) = 3"은 토큰 파서와 같이 할당으로 인정하지 않는다.
+        ruleAssignmentOrExpression = (&ruleAssignmentLookahead >> ruleName >> lit('=') >> ruleExpression)[_val = make_node<Assignment>(_1, _2)]
+                                   | ruleExpression[_val = _1];
 
         // If문 규칙
-        ruleIf = (lit("if") >> ruleExpression >> lit("then") >> ruleBlock >> lit("end"))[_val = construct<BasePtr>(new_<If>(_1, _2, nullptr))];
+        ruleIf = (lit("if") >> ruleExpression >> lit("then") >> ruleBlock >> lit("end"))[_val = make_node<If>(_1, _2, nullptr)];
 
         // 구문 규칙
         // 구문은 if문, for문, 함수선언, 변수선언, 표현식 등을 말한다.
         ruleStatement =  ruleFunctionDefinition[_val = _1]
-                       | ruleAssignment[_val = _1]
                        | ruleIf[_val = _1]
-                       | ruleExpression[_val = _1];
+                       | ruleAssignmentOrExpression[_val = _1];
 
         // 블록 규칙
         // 블록은 구문이 1개 이상 나열되어 있는것을 말한다.
-        ruleBlock = (ruleStatement % qi::eps)[_val = construct<BasePtr>(new_<Block>(_1))];
+        ruleBlock = (ruleStatement % qi::eps)[_val = make_node<Block>(_1)];
 
         // 프로그램
-        ruleAST = ruleBlock[_val = construct<ASTPtr>(new_<AST>(_1))];
+        ruleAST = ruleBlock[_val = make_node<AST>(_1)];
 
-        BOOST_SPIRIT_DEBUG_NODES((ruleName)(ruleNameList)(ruleBoolean)(ruleLiteralString)(ruleInteger)(ruleFloat)(ruleNumeral));
+        BOOST_SPIRIT_DEBUG_NODES((ruleName)(ruleNameList)(ruleBoolean)(ruleLiteralString)(ruleNumeral));
         BOOST_SPIRIT_DEBUG_NODES((rulePrimaryExpression)(ruleExpression)(ruleExpressionList));
         BOOST_SPIRIT_DEBUG_NODES((rule1OperatorUnary)(rule2OperatorBinary)(rule3OperatorBinary)(rule4OperatorBinary)(rule5OperatorBinary)(rule6OperatorBinary)(rule7OperatorBinary)(rule8OperatorBinary));
-        BOOST_SPIRIT_DEBUG_NODES((ruleFunctionDefinition)(ruleFunctionParameter)(ruleFunctionArgument)(ruleFunctionCall));
-        BOOST_SPIRIT_DEBUG_NODES((ruleAssignment)(ruleIf)(ruleStatement));
+        BOOST_SPIRIT_DEBUG_NODES((ruleFunctionDefinition)(ruleFunctionParameter)(ruleFunctionArgument)(ruleNameOrFunctionCall));
+        BOOST_SPIRIT_DEBUG_NODES((ruleAssignmentOrExpression)(ruleIf)(ruleStatement));
         BOOST_SPIRIT_DEBUG_NODES((ruleBlock)(ruleAST));
     }
 
+    // 모든 rule에 프로파일러를 연결한다. 연결한 다음에는 되돌릴 수 없으므로 프로파일용 grammar에만 사용한다.
+    void EnableProfile(RuleProfile& profile)
+    {
+        qi::rule<Iterator, BasePtr(), skipper<Iterator>>* rules[] =
+        {
+            &ruleName, &ruleNameList, &ruleBoolean, &ruleLiteralString, &ruleNumeral,
+            &rule1OperatorUnary, &rule2OperatorBinary, &rule3OperatorBinary, &rule4OperatorBinary, &rule5OperatorBinary, &rule6OperatorBinary, &rule7OperatorBinary, &rule8OperatorBinary,
+            &rulePrimaryExpression, &ruleExpression, &ruleExpressionList,
+            &ruleFunctionDefinition, &ruleFunctionParameter, &ruleFunctionArgument, &ruleNameOrFunctionCall,
+            &ruleAssignmentOrExpression, &ruleIf, &ruleStatement, &ruleBlock,
+        };
+
+        for (qi::rule<Iterator, BasePtr(), skipper<Iterator>>* pRule : rules)
+        {
+            qi::debug(*pRule, rule_profiler{ &profile, profile.ruleStats.size() });
+            profile.ruleStats.push_back(RuleStats{ pRule->name() });
+        }
+
+        qi::debug(ruleAST, rule_profiler{ &profile, profile.ruleStats.size() });
+        profile.ruleStats.push_back(RuleStats{ ruleAST.name() });
+    }
+
 
     /* 심볼(키워드) */
     qi::symbols<char, std::string> symbolKeyword;
-    qi::symbols<char, std::string> symbol1OperatorUnary;
-    qi::symbols<char, std::string> symbol2OperatorBinary;
-    qi::symbols<char, std::string> symbol3OperatorBinary;
-    qi::symbols<char, std::string> symbol4OperatorBinary;
-    qi::symbols<char, std::string> symbol5OperatorBinary;
-    qi::symbols<char, std::string> symbol6OperatorBinary;
-    qi::symbols<char, std::string> symbol7OperatorBinary;
-    qi::symbols<char, std::string> symbol8OperatorBinary;
+    qi::symbols<char, EOperator> symbol1OperatorUnary;
+    qi::symbols<char, EOperator> symbol2OperatorBinary;
+    qi::symbols<char, EOperator> symbol3OperatorBinary;
+    qi::symbols<char, EOperator> symbol4OperatorBinary;
+    qi::symbols<char, EOperator> symbol5OperatorBinary;
+    qi::symbols<char, EOperator> symbol6OperatorBinary;
+    qi::symbols<char, EOperator> symbol7OperatorBinary;
+    qi::symbols<char, EOperator> symbol8OperatorBinary;
 
     /* 파싱 rule */
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleName;
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleNameList;
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleBoolean;
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleLiteralString;
-    qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleInteger;
-    qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleFloat;
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleNumeral;
 
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> rule1OperatorUnary;
@@ -256,9 +449,10 @@ struct dsl_grammar : qi::grammar<Iterator, ASTPtr(), skipper<Iterator>> {
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleFunctionDefinition;
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleFunctionParameter;
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleFunctionArgument;
-    qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleFunctionCall;
+    qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleNameOrFunctionCall;
     
-    qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleAssignment;
+    qi::rule<Iterator, skipper<Iterator>> ruleAssignmentLookahead;
+    qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleAssignmentOrExpression;
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleIf;
 
     qi::rule<Iterator, BasePtr(), skipper<Iterator>> ruleStatement;
@@ -269,6 +463,203 @@ struct dsl_grammar : qi::grammar<Iterator, ASTPtr(), skipper<Iterator>> {
 
 
 
+// 파서 컨텍스트 구현
+// grammar와 skipper, 토큰 배열을 함께 보관하며, 컨텍스트가 살아있는 동안 재사용된다.
+struct ParserContext::Impl
+{
+    using Iterator = scan_count_iterator<std::wstring::const_iterator>;
+
+    skipper<Iterator> skip;
+    dsl_grammar<Iterator> grammar;
+
+    TokenList tokens;
+
+    // 프로파일 모드에서 사용하는 grammar. 처음 사용할 때 만든다.
+    std::unique_ptr<dsl_grammar<Iterator>> upProfileGrammar;
+    RuleProfile profile;
+};
+
+// 파싱 실패 정보 출력
+// @stopOffset  : 파싱이 멈춘 위치
+// @bMatched    : 앞부분은 파싱에 성공했는지 여부
+static void printParseFailure(const std::wstring_view strScript, const size_t stopOffset, const bool bMatched)
+{
+    std::wcout << L"Parsing Failed..." << std::endl;
+    std::wcout << L"Parsing Success: " << (bMatched ? L"true" : L"false") << std::endl;
+    std::wcout << L"Parsing Location: " << stopOffset << L"/" << strScript.length() << std::endl;
+    if (stopOffset < strScript.length()) {
+        std::wcout << L"Failed Location: " << strScript.substr(stopOffset, 20) << std::endl;
+    }
+}
+
+static void printParseFailure(const std::string_view strUtf8Script, const size_t stopOffset, const bool bMatched)
+{
+    std::wcout << L"Parsing Failed..." << std::endl;
+    std::wcout << L"Parsing Success: " << (bMatched ? L"true" : L"false") << std::endl;
+    std::wcout << L"Parsing Location: " << stopOffset << L"/" << strUtf8Script.length() << std::endl;
+    if (stopOffset < strUtf8Script.length()) {
+        std::wcout << L"Failed Location: " << Utf8ToWide(strUtf8Script.substr(stopOffset, 20)) << std::endl;
+    }
+}
+
+ParserContext::ParserContext()
+    : m_upImpl(std::make_unique<Impl>())
+    , m_bProfile(false)
+    , m_bNodeArena(true)
+{
+}
+
+ParserContext::~ParserContext()
+{
+}
+
+// 현재 스레드 전용 컨텍스트. 스레드에서 처음 호출될 때 grammar가 생성된다.
+ParserContext& ParserContext::GetThreadInstance()
+{
+    static thread_local ParserContext context;
+    return context;
+}
+
+// 스크립트를 파싱해서 AST를 만든다.
+// 파싱하는 동안 스크립트의 상수 풀을 현재 스레드의 풀로 지정한다. 모든 백엔드의 LiteralString이 이 풀을 사용한다.
+// 노드 아레나도 같은 방식으로 지정하므로 모든 백엔드의 노드가 스크립트의 아레나에 할당된다.
+ASTPtr ParserContext::Parse(const std::wstring& strScript, const EParserBackend eBackend /*= EParserBackend::Token*/)
+{
+    m_lastStats = ParseStats();
+    m_lastStats.inputLength = strScript.length();
+    m_lastFunctions.clear();
+
+    ConstantPoolPtr spPool = std::make_shared<ConstantPool>();
+    ConstantPool::Scope poolScope(spPool);
+    const ASTArenaPtr spArena = m_bNodeArena ? ASTArena::Create() : nullptr;
+    ASTArena::Scope arenaScope(spArena);
+
+    if (EParserBackend::Spirit == eBackend)
+        return attachScriptData(parseSpirit(strScript), spPool, spArena);
+
+    if (EParserBackend::SpiritX3 == eBackend)
+    {
+        size_t stopOffset = 0;
+        bool bMatched = false;
+        ASTPtr prog = ParseX3(strScript, stopOffset, bMatched);
+        if (!prog)
+            printParseFailure(std::wstring_view(strScript), stopOffset, bMatched);
+        return attachScriptData(prog, spPool, spArena);
+    }
+
+    return attachScriptData(parseToken(std::wstring_view(strScript)), spPool, spArena);
+}
+
+// UTF-8 스크립트를 파싱해서 AST를 만든다.
+ASTPtr ParserContext::Parse(std::string_view strUtf8Script, const bool bLazyFunctionBody /*= false*/)
+{
+    m_lastStats = ParseStats();
+    m_lastStats.inputLength = strUtf8Script.length();
+    m_lastFunctions.clear();
+
+    // 지연 파싱하는 함수 본문도 같은 풀을 사용한다. (LazyFunctionBody)
+    ConstantPoolPtr spPool = std::make_shared<ConstantPool>();
+    ConstantPool::Scope poolScope(spPool);
+    const ASTArenaPtr spArena = m_bNodeArena ? ASTArena::Create() : nullptr;
+    ASTArena::Scope arenaScope(spArena);
+
+    if (!bLazyFunctionBody)
+        return attachScriptData(parseToken(strUtf8Script), spPool, spArena);
+
+    // 지연 파싱하는 함수 본문은 복사한 텍스트를 공유한다. 지연 파싱하는 함수가 없다면 파싱이 끝날 때 해제된다.
+    std::shared_ptr<const std::string> spSource = std::make_shared<const std::string>(strUtf8Script);
+    return attachScriptData(parseToken(std::string_view(*spSource), spSource), spPool, spArena);
+}
+
+ASTPtr ParserContext::attachScriptData(ASTPtr prog, const ConstantPoolPtr& spPool, const ASTArenaPtr& spArena)
+{
+    m_lastStats.literalCount = spPool->GetLiteralCount();
+    m_lastStats.constantCount = spPool->GetConstantCount();
+    m_lastStats.literalBytesSaved = spPool->GetSavedBytes();
+    if (spArena)
+    {
+        m_lastStats.arenaUsedBytes = spArena->GetUsedBytes();
+        m_lastStats.arenaReservedBytes = spArena->GetReservedBytes();
+    }
+
+    if (prog)
+    {
+        prog->constants = spPool;
+        prog->arena = spArena;
+    }
+
+    return prog;
+}
+
+// 렉서로 토큰 배열을 만든 다음 토큰 파서로 AST를 만든다.
+// wchar_t 문자열과 UTF-8 문자열에 같은 코드를 사용한다.
+template <typename StringView>
+ASTPtr ParserContext::parseToken(const StringView strScript, std::shared_ptr<const std::string> spLazySource /*= nullptr*/)
+{
+    size_t errorOffset = 0;
+    if (!Tokenize(strScript, m_upImpl->tokens, errorOffset))
+    {
+        printParseFailure(strScript, errorOffset, false);
+        return nullptr;
+    }
+
+    TokenParser parser(strScript, m_upImpl->tokens);
+    if (spLazySource)
+        parser.SetLazyFunctionBody(std::move(spLazySource));
+    ASTPtr prog = parser.ParseAST();
+
+    // 렉서는 모든 문자를 한 번씩 읽는다. 토큰 파서가 다시 읽은 토큰의 문자 수를 더한다.
+    m_lastStats.scannedLength = strScript.length() + parser.GetRescanLength();
+    m_lastStats.tokenCount = m_upImpl->tokens.size();
+    m_lastStats.consumedTokenCount = parser.GetConsumedTokenCount();
+    m_lastStats.lazyFunctionCount = parser.GetLazyFunctionCount();
+
+    if (!prog)
+    {
+        printParseFailure(strScript, parser.GetStopOffset(), parser.HasMatched());
+        return nullptr;
+    }
+
+    m_lastFunctions = parser.TakeFunctions();
+    return prog;
+}
+
+// Spirit grammar로 문자열을 직접 파싱한다.
+ASTPtr ParserContext::parseSpirit(const std::wstring& strScript)
+{
+    using Iterator = Impl::Iterator;
+
+    ASTPtr prog;
+
+    Iterator iter(strScript.begin(), &m_lastStats.scannedLength);
+    const Iterator end(strScript.end(), &m_lastStats.scannedLength);
+
+    bool r = false;
+    if (m_bProfile)
+    {
+        if (!m_upImpl->upProfileGrammar)
+        {
+            m_upImpl->upProfileGrammar = std::make_unique<dsl_grammar<Iterator>>();
+            m_upImpl->upProfileGrammar->EnableProfile(m_upImpl->profile);
+        }
+
+        m_upImpl->profile.Reset();
+        r = phrase_parse(iter, end, *m_upImpl->upProfileGrammar, m_upImpl->skip, prog);
+        m_lastStats.ruleStats = m_upImpl->profile.ruleStats;
+    }
+    else
+    {
+        r = phrase_parse(iter, end, m_upImpl->grammar, m_upImpl->skip, prog);
+    }
+
+    if (r && iter == end)
+        return prog;
+
+    printParseFailure(strScript, iter.base() - strScript.begin(), r);
+    return nullptr;
+}
+
+
 void dsl::Parser2Test()
 {
     std::wstring filePath = L"D:/project/DSL_cursor/Script/dsl1.dsl";
@@ -287,71 +678,34 @@ void dsl::Parser2Test()
     std::wcout << L"Input file content:" << std::endl;
     std::wcout << input.c_str() << std::endl;
 
-    using It = std::wstring::iterator;
-    It iter = input.begin(), end = input.end();
-
-    skipper<It> skip;
-
-    ASTPtr prog;
-    dsl_grammar<It> grammar;
-    
-
-    bool r = phrase_parse(iter, end, grammar, skip, prog);
-
-    if (r && iter == end) {
-        std::wcout << L"AST Parsing Success!" << std::endl;
-
-        prog->Print();
-    }
-    else {
-        std::wcout << L"Parsing Failed..." << std::endl;
-        std::wcout << L"Parsing Success: " << (r ? L"true" : L"false") << std::endl;
-        std::wcout << L"Parsing Location: " << (iter - input.begin()) << L"/" << input.length() << std::endl;
-        if (iter != end) {
-            std::wcout << L"Failed Location: ";
-            for (int i = 0; i < 20 && iter != end; ++i, ++iter) {
-                std::wcout << *iter;
-            }
-            std::wcout << std::endl;
-        }
-    }
+    ParseScript(input);
 }
 
-ASTPtr dsl::ParseScript(std::wstring& strScript)
+ASTPtr dsl::ParseScript(const std::wstring& strScript, const EParserBackend eBackend /*= EParserBackend::Token*/)
 {
-    skipper<std::wstring::iterator> skip;
-
-    ASTPtr prog;
-    dsl_grammar<std::wstring::iterator> grammar;
+    // grammar는 스레드별 컨텍스트에서 재사용한다.
+    ASTPtr prog = ParserContext::GetThreadInstance().Parse(strScript, eBackend);
+    if (!prog)
+        return nullptr;
 
+    std::wcout << L"AST Parsing Success!" << std::endl;
 
-    std::wstring::iterator iter = strScript.begin();
-    bool r = phrase_parse(strScript.begin(), strScript.end(), grammar, skip, prog);
+    prog->Print();
 
-    if (r && iter == strScript.end()) {
-        std::wcout << L"AST Parsing Success!" << std::endl;
+    return prog;
+}
 
-        prog->Print();
+ASTPtr dsl::ParseScript(std::string_view strUtf8Script)
+{
+    ASTPtr prog = ParserContext::GetThreadInstance().Parse(strUtf8Script);
+    if (!prog)
+        return nullptr;
 
-        return prog;
-    }
-    else 
-    {
-        std::wcout << L"Parsing Failed..." << std::endl;
-        std::wcout << L"Parsing Success: " << (r ? L"true" : L"false") << std::endl;
-        std::wcout << L"Parsing Location: " << (iter - strScript.begin()) << L"/" << strScript.length() << std::endl;
-        if (iter != strScript.end()) {
-            std::wcout << L"Failed Location: ";
-            for (int i = 0; i < 20 && iter != strScript.end(); ++i, ++iter) {
-                std::wcout << *iter;
-            }
-            std::wcout << std::endl;
-        }
+    std::wcout << L"AST Parsing Success!" << std::endl;
 
-        return nullptr;
-    }
+    prog->Print();
 
-    return nullptr;
+    return prog;
 }
 
-}
\ No newline at end of file
+}
@@ -7,6 +7,110 @@ namespace dsl
 	void Parser2Test();
 
 
-	ASTPtr ParseScript(std::wstring& strScript);
+	// 파서 구현 종류
+	enum class EParserBackend
+	{
+		Token,		// 렉서로 토큰을 만든 다음 토큰 파서로 AST를 만든다. (기본값)
+		Spirit,		// Boost.Spirit Qi grammar로 문자열을 직접 파싱한다.
+		SpiritX3,	// Boost.Spirit X3 grammar로 문자열을 직접 파싱한다. Qi grammar와 같은 AST를 만든다. (parser_x3.h)
+	};
 
-}
\ No newline at end of file
+
+	// rule별 프로파일 통계 (Spirit 백엔드)
+	struct RuleStats
+	{
+		std::string name;					// rule 이름
+		size_t attemptCount = 0;			// 시도한 횟수
+		size_t successCount = 0;			// 매칭에 성공한 횟수
+		size_t backtrackCount = 0;			// 입력을 읽은 다음 실패한 횟수. 호출한 쪽은 rule을 시도하기 전 위치로 되돌아가서 다시 읽는다. (건너뛴 공백 포함)
+		double elapsedUs = 0.0;				// 누적 시간. 하위 rule의 시간을 포함하고, 재귀 호출은 가장 바깥 호출만 더한다.
+	};
+
+
+	// 파싱 통계
+	struct ParseStats
+	{
+		size_t inputLength = 0;				// 입력 문자 수
+		size_t scannedLength = 0;			// 파서가 읽은 문자 수. 백트래킹으로 다시 읽은 문자를 포함한다. (X3 백엔드는 기록하지 않음)
+		size_t tokenCount = 0;				// 토큰 수 (Token 백엔드)
+		size_t consumedTokenCount = 0;		// 토큰을 소비한 횟수. 백트래킹으로 다시 소비한 토큰을 포함한다. (Token 백엔드)
+		size_t lazyFunctionCount = 0;		// 본문 파싱을 미룬 함수 수
+		size_t literalCount = 0;			// 문자열 리터럴 수. 지연 파싱한 함수 본문의 리터럴은 포함하지 않는다.
+		size_t constantCount = 0;			// 상수 풀의 버퍼 수 (중복을 제거한 리터럴 수)
+		size_t literalBytesSaved = 0;		// 중복된 리터럴이 상수 풀의 버퍼를 공유해서 줄어든 문자열 크기 (bytes)
+		size_t arenaUsedBytes = 0;			// 노드 아레나에 할당한 바이트 수. 아레나를 사용하지 않았다면 0
+		size_t arenaReservedBytes = 0;		// 노드 아레나의 블록 크기 합
+		std::vector<RuleStats> ruleStats;	// rule별 통계. 프로파일 모드의 Spirit 백엔드에서만 기록한다.
+
+		// 입력 문자 1개당 읽은 문자 수. 1에 가까울수록 다시 읽는 문자가 적다.
+		double GetScanRatio() const { return 0 == inputLength ? 0.0 : static_cast<double>(scannedLength) / static_cast<double>(inputLength); }
+	};
+
+
+	// 파서 컨텍스트
+	// grammar와 skipper는 rule 객체 30여개와 symbols 트리를 생성하기 때문에 생성 비용이 크다.
+	// 컨텍스트는 생성할 때 grammar를 한 번만 만들고, 이후의 모든 파싱에서 재사용한다.
+	class ParserContext
+	{
+	public:
+		ParserContext();
+		~ParserContext();
+
+		ParserContext(const ParserContext&) = delete;
+		ParserContext& operator=(const ParserContext&) = delete;
+
+		// 현재 스레드 전용 컨텍스트를 얻는다.
+		// 스레드마다 별도의 grammar를 가지므로 병렬로 파싱하더라도 rule 상태를 공유하지 않는다.
+		static ParserContext& GetThreadInstance();
+
+	public:
+		// 스크립트를 파싱해서 AST를 만든다. 실패하면 nullptr를 반환한다.
+		ASTPtr Parse(const std::wstring& strScript, const EParserBackend eBackend = EParserBackend::Token);
+
+		// UTF-8 스크립트를 파싱해서 AST를 만든다. Token 백엔드만 지원한다.
+		// wchar_t 문자열로 변환하지 않고 바이트 단위로 파싱한다. 통계의 길이는 바이트 단위이다.
+		// bLazyFunctionBody가 true이면 함수 본문은 처음 사용할 때 파싱한다. 이 때 함수 본문이 참조할 수 있도록 텍스트를 복사해서 보관한다.
+		ASTPtr Parse(std::string_view strUtf8Script, const bool bLazyFunctionBody = false);
+
+		// 마지막 Parse 호출의 파싱 통계
+		const ParseStats& GetLastStats() const { return m_lastStats; }
+
+		// 마지막 Parse 호출에서 만든 함수 정의. AST를 전위 순회한 순서와 같다.
+		// Token 백엔드만 파싱하면서 기록한다. Spirit 백엔드이거나 파싱에 실패했다면 비어있다.
+		const std::vector<FunctionDefinitionCPtr>& GetLastFunctions() const { return m_lastFunctions; }
+		std::vector<FunctionDefinitionCPtr> TakeLastFunctions() { return std::move(m_lastFunctions); }
+
+		// 프로파일 모드에서는 Spirit 백엔드가 rule별 시도, 성공, 백트래킹 횟수와 시간을 ParseStats::ruleStats에 기록한다.
+		// 프로파일용 grammar는 처음 사용할 때 따로 만든다. 프로파일 모드가 아닐 때의 파싱에는 비용이 없다.
+		void SetProfile(const bool bProfile) { m_bProfile = bProfile; }
+		bool IsProfile() const { return m_bProfile; }
+
+		// 노드 아레나 사용 여부. (기본값 true)
+		// 사용하면 스크립트의 모든 노드를 스크립트 전용 아레나에 할당하고, 마지막 노드가 해제될 때 한 번에 해제한다. (ast_arena.h)
+		void SetNodeArena(const bool bNodeArena) { m_bNodeArena = bNodeArena; }
+		bool IsNodeArena() const { return m_bNodeArena; }
+
+	private:
+		template <typename StringView>
+		ASTPtr parseToken(const StringView strScript, std::shared_ptr<const std::string> spLazySource = nullptr);
+		ASTPtr parseSpirit(const std::wstring& strScript);
+
+		// AST에 상수 풀과 노드 아레나를 연결하고 통계를 기록한다.
+		ASTPtr attachScriptData(ASTPtr prog, const ConstantPoolPtr& spPool, const ASTArenaPtr& spArena);
+
+	private:
+		// grammar 타입은 parser.cpp 안에서만 정의한다.
+		struct Impl;
+		std::unique_ptr<Impl> m_upImpl;
+
+		ParseStats m_lastStats;
+		std::vector<FunctionDefinitionCPtr> m_lastFunctions;
+		bool m_bProfile;
+		bool m_bNodeArena;
+	};
+
+
+	ASTPtr ParseScript(const std::wstring& strScript, const EParserBackend eBackend = EParserBackend::Token);
+	ASTPtr ParseScript(std::string_view strUtf8Script);
+
+}
@@ -0,0 +1,226 @@
+﻿#include "pch.h"
+
+#include <boost/spirit/home/x3.hpp>
+
+#include "ast.h"
+#include "numeral.h"
+#include "parser_x3.h"
+
+namespace x3 = boost::spirit::x3;
+
+namespace dsl
+{
+namespace x3_grammar
+{
+
+using x3::_val;
+using x3::_attr;
+using x3::_pass;
+using x3::lexeme;
+using x3::standard_wide::lit;
+
+// 문자 분류는 dsl_grammar와 같다. 이름과 문자열 안의 문자는 standard(0~255) 인코딩, 공백은 ascii 인코딩을 사용한다.
+using x3::standard::alpha;
+using x3::standard::alnum;
+using x3::standard::char_;
+
+// 숫자 리터럴 파서. dsl_grammar의 numeral_ 과 같이 ScanNumeral로 정수와 실수를 한 번에 구분한다.
+struct numeral_parser : x3::parser<numeral_parser>
+{
+	using attribute_type = NumeralValue;
+	static bool const has_attribute = true;
+
+	template <typename Iterator, typename Context, typename RContext, typename Attribute>
+	bool parse(Iterator& first, const Iterator& last, const Context& context, RContext&, Attribute& attr) const
+	{
+		x3::skip_over(first, last, context);
+
+		NumeralValue value;
+		if (!ScanNumeral(first, last, &value))
+			return false;
+
+		x3::traits::move_to(value, attr);
+		return true;
+	}
+};
+static const numeral_parser numeral_ = {};
+
+// 키워드 심볼. dsl_grammar의 symbol 정의와 같다.
+using wide_symbols = x3::symbols_parser<boost::spirit::char_encoding::standard_wide, std::wstring>;
+
+// 연산자 심볼. 값은 연산자 코드이다. dsl_grammar의 symbol 정의와 같다.
+using operator_symbols = x3::symbols_parser<boost::spirit::char_encoding::standard_wide, EOperator>;
+
+static const wide_symbols symbolKeyword({ L"and", L"or", L"not", L"break", L"goto", L"do", L"end", L"while", L"repeat", L"return", L"until", L"if", L"then", L"elseif", L"else", L"for", L"in", L"function", L"local", L"false", L"true" });
+static const operator_symbols symbol1OperatorUnary({ { L"not", EOperator::Not }, { L"-", EOperator::Neg } });
+static const operator_symbols symbol2OperatorBinary({ { L"*", EOperator::Mul }, { L"/", EOperator::Div }, { L"%", EOperator::Mod } });
+static const operator_symbols symbol3OperatorBinary({ { L"+", EOperator::Add }, { L"-", EOperator::Sub } });
+static const operator_symbols symbol4OperatorBinary({ { L"<", EOperator::Less }, { L">", EOperator::Greater }, { L"<=", EOperator::LessEqual }, { L">=", EOperator::GreaterEqual } });
+static const operator_symbols symbol5OperatorBinary({ { L"==", EOperator::Equal }, { L"!=", EOperator::NotEqual } });
+static const operator_symbols symbol6OperatorBinary({ { L"and", EOperator::And } });
+static const operator_symbols symbol7OperatorBinary({ { L"or", EOperator::Or } });
+static const operator_symbols symbol8OperatorBinary({ { L"*=", EOperator::MulAssign }, { L"/=", EOperator::DivAssign }, { L"+=", EOperator::AddAssign }, { L"-=", EOperator::SubAssign } });
+
+// semantic action
+// 하위 규칙의 결과를 그대로 사용한다.
+static const auto assign = [](auto& ctx) { _val(ctx) = _attr(ctx); };
+
+// 노드를 만든다. 하위 규칙의 결과를 생성자 인자로 전달한다.
+template <typename Node>
+static const auto make = [](auto& ctx) { _val(ctx) = MakeNode<Node>(_attr(ctx)); };
+
+// 인자가 없는 노드
+template <typename Node>
+static const auto makeEmpty = [](auto& ctx) { _val(ctx) = MakeNode<Node>(); };
+
+// 이항연산자 노드. 왼쪽 항은 지금까지 만든 노드이다.
+static const auto makeBinary = [](auto& ctx)
+{
+	auto& attr = _attr(ctx);
+	_val(ctx) = MakeNode<BinaryExpression>(_val(ctx), boost::fusion::at_c<0>(attr), boost::fusion::at_c<1>(attr));
+};
+
+static const auto makeUnary = [](auto& ctx)
+{
+	auto& attr = _attr(ctx);
+	_val(ctx) = MakeNode<UnaryExpression>(boost::fusion::at_c<0>(attr), boost::fusion::at_c<1>(attr));
+};
+
+static const auto makeNumeral = [](auto& ctx)
+{
+	const NumeralValue& value = _attr(ctx);
+	if (value.isInteger)
+		_val(ctx) = MakeNode<Numeral>(value.intValue);
+	else
+		_val(ctx) = MakeNode<Numeral>(value.floatValue);
+};
+
+static const auto makeFunctionDefinition = [](auto& ctx)
+{
+	auto& attr = _attr(ctx);
+	_val(ctx) = MakeNode<FunctionDefinition>(boost::fusion::at_c<0>(attr), boost::fusion::at_c<1>(attr), boost::fusion::at_c<2>(attr));
+};
+
+static const auto makeFunctionCall = [](auto& ctx) { _val(ctx) = MakeNode<FunctionCall>(_val(ctx), _attr(ctx)); };
+
+static const auto makeIf = [](auto& ctx)
+{
+	auto& attr = _attr(ctx);
+	_val(ctx) = MakeNode<If>(boost::fusion::at_c<0>(attr), boost::fusion::at_c<1>(attr), nullptr);
+};
+
+// 변수 할당 노드
+static const auto makeAssignment = [](auto& ctx)
+{
+	auto& attr = _attr(ctx);
+	_val(ctx) = MakeNode<Assignment>(boost::fusion::at_c<0>(attr), boost::fusion::at_c<1>(attr));
+};
+
+// '공백'과 '-- 주석'을 무시하는 스키퍼
+static const auto skipper = x3::ascii::space | (lit(L"--") >> *(char_ - L'\n') >> -char_(L'\n'));
+
+// 규칙 선언
+x3::rule<class identifier_class, std::wstring> const identifier = "identifier";
+x3::rule<class name_class, BasePtr> const ruleName = "ruleName";
+x3::rule<class name_list_class, BasePtr> const ruleNameList = "ruleNameList";
+x3::rule<class boolean_class, BasePtr> const ruleBoolean = "ruleBoolean";
+x3::rule<class literal_string_class, BasePtr> const ruleLiteralString = "ruleLiteralString";
+x3::rule<class numeral_class, BasePtr> const ruleNumeral = "ruleNumeral";
+
+x3::rule<class primary_expression_class, BasePtr> const rulePrimaryExpression = "rulePrimaryExpression";
+x3::rule<class operator_unary1_class, BasePtr> const rule1OperatorUnary = "rule1OperatorUnary";
+x3::rule<class operator_binary2_class, BasePtr> const rule2OperatorBinary = "rule2OperatorBinary";
+x3::rule<class operator_binary3_class, BasePtr> const rule3OperatorBinary = "rule3OperatorBinary";
+x3::rule<class operator_binary4_class, BasePtr> const rule4OperatorBinary = "rule4OperatorBinary";
+x3::rule<class operator_binary5_class, BasePtr> const rule5OperatorBinary = "rule5OperatorBinary";
+x3::rule<class operator_binary6_class, BasePtr> const rule6OperatorBinary = "rule6OperatorBinary";
+x3::rule<class operator_binary7_class, BasePtr> const rule7OperatorBinary = "rule7OperatorBinary";
+x3::rule<class operator_binary8_class, BasePtr> const rule8OperatorBinary = "rule8OperatorBinary";
+x3::rule<class expression_class, BasePtr> const ruleExpression = "ruleExpression";
+x3::rule<class expression_list_class, BasePtr> const ruleExpressionList = "ruleExpressionList";
+
+x3::rule<class function_definition_class, BasePtr> const ruleFunctionDefinition = "ruleFunctionDefinition";
+x3::rule<class function_parameter_class, BasePtr> const ruleFunctionParameter = "ruleFunctionParameter";
+x3::rule<class function_argument_class, BasePtr> const ruleFunctionArgument = "ruleFunctionArgument";
+x3::rule<class name_or_function_call_class, BasePtr> const ruleNameOrFunctionCall = "ruleNameOrFunctionCall";
+
+x3::rule<class assignment_or_expression_class, BasePtr> const ruleAssignmentOrExpression = "ruleAssignmentOrExpression";
+x3::rule<class if_class, BasePtr> const ruleIf = "ruleIf";
+x3::rule<class statement_class, BasePtr> const ruleStatement = "ruleStatement";
+x3::rule<class block_class, BasePtr> const ruleBlock = "ruleBlock";
+x3::rule<class ast_class, ASTPtr> const ruleAST = "ruleAST";
+
+// 규칙 정의. 각 규칙의 설명은 dsl_grammar를 참고한다.
+static const auto nameChar = alnum | char_(L'_');
+
+const auto identifier_def = (alpha | char_(L'_')) >> *nameChar;
+const auto ruleName_def = lexeme[identifier - (symbolKeyword >> !nameChar)][make<Name>];
+const auto ruleNameList_def = (ruleName % L',')[make<NameList>];
+const auto ruleBoolean_def = lexeme[lit(L"false") >> !nameChar][([](auto& ctx) { _val(ctx) = MakeNode<Boolean>(false); })]
+						   | lexeme[lit(L"true") >> !nameChar][([](auto& ctx) { _val(ctx) = MakeNode<Boolean>(true); })];
+const auto ruleLiteralString_def = lexeme[L'"' >> x3::as_parser(*(char_ - L'"')) >> L'"'][([](auto& ctx) { _val(ctx) = MakeNode<LiteralString>(std::wstring(_attr(ctx).begin(), _attr(ctx).end())); })];
+const auto ruleNumeral_def = lexeme[-lit(L'+') >> numeral_][makeNumeral];
+
+const auto rulePrimaryExpression_def = ruleNumeral[assign]
+									 | ruleBoolean[assign]
+									 | ruleLiteralString[assign]
+									 | ruleNameOrFunctionCall[assign]
+									 | (lit(L'(') >> ruleExpression >> lit(L')'))[assign];
+
+const auto rule1OperatorUnary_def = (symbol1OperatorUnary >> rulePrimaryExpression)[makeUnary]
+								  | rulePrimaryExpression[assign];
+
+const auto rule2OperatorBinary_def = rule1OperatorUnary[assign] >> *(symbol2OperatorBinary >> rule1OperatorUnary)[makeBinary];
+const auto rule3OperatorBinary_def = rule2OperatorBinary[assign] >> *(symbol3OperatorBinary >> rule2OperatorBinary)[makeBinary];
+const auto rule4OperatorBinary_def = rule3OperatorBinary[assign] >> *(symbol4OperatorBinary >> rule3OperatorBinary)[makeBinary];
+const auto rule5OperatorBinary_def = rule4OperatorBinary[assign] >> *(symbol5OperatorBinary >> rule4OperatorBinary)[makeBinary];
+const auto rule6OperatorBinary_def = rule5OperatorBinary[assign] >> *(symbol6OperatorBinary >> rule5OperatorBinary)[makeBinary];
+const auto rule7OperatorBinary_def = rule6OperatorBinary[assign] >> *(symbol7OperatorBinary >> rule6OperatorBinary)[makeBinary];
+const auto rule8OperatorBinary_def = rule7OperatorBinary[assign] >> *(symbol8OperatorBinary >> rule7OperatorBinary)[makeBinary];
+
+const auto ruleExpression_def = rule8OperatorBinary[assign];
+const auto ruleExpressionList_def = (ruleExpression % L',')[make<ExpressionList>];
+
+const auto ruleFunctionDefinition_def = (lit(L"function") >> ruleName >> ruleFunctionParameter >> ruleBlock >> lit(L"end"))[makeFunctionDefinition];
+const auto ruleFunctionParameter_def = (lit(L'(') >> lit(L')'))[makeEmpty<FunctionParameter>]
+									 | (lit(L'(') >> ruleNameList >> lit(L')'))[make<FunctionParameter>];
+const auto ruleFunctionArgument_def = (lit(L'(') >> lit(L')'))[makeEmpty<FunctionArgument>]
+									| (lit(L'(') >> ruleExpressionList >> lit(L')'))[make<FunctionArgument>];
+const auto ruleNameOrFunctionCall_def = ruleName[assign] >> -ruleFunctionArgument[makeFunctionCall];
+
+// 이름 다음에 '='가 오는 경우만 할당으로 파싱한다. ('=='는 할당이 아니다.) 괄호로 감싼 이름은 할당할 수 없다.
+// 미리 읽기는 속성이 없는 식이므로 ruleName과 달리 문자열과 Name 노드를 만들지 않는다.
+static const auto assignmentLookahead = lexeme[((alpha | char_(L'_')) >> *nameChar) - (symbolKeyword >> !nameChar)] >> lit(L'=') >> !lit(L'=');
+const auto ruleAssignmentOrExpression_def = (&assignmentLookahead >> ruleName >> lit(L'=') >> ruleExpression)[makeAssignment]
+										  | ruleExpression[assign];
+const auto ruleIf_def = (lit(L"if") >> ruleExpression >> lit(L"then") >> ruleBlock >> lit(L"end"))[makeIf];
+const auto ruleStatement_def = ruleFunctionDefinition[assign]
+							 | ruleIf[assign]
+							 | ruleAssignmentOrExpression[assign];
+const auto ruleBlock_def = (ruleStatement % x3::eps)[make<Block>];
+const auto ruleAST_def = ruleBlock[make<AST>];
+
+BOOST_SPIRIT_DEFINE(identifier, ruleName, ruleNameList, ruleBoolean, ruleLiteralString, ruleNumeral);
+BOOST_SPIRIT_DEFINE(rulePrimaryExpression, rule1OperatorUnary, rule2OperatorBinary, rule3OperatorBinary, rule4OperatorBinary, rule5OperatorBinary, rule6OperatorBinary, rule7OperatorBinary, rule8OperatorBinary);
+BOOST_SPIRIT_DEFINE(ruleExpression, ruleExpressionList);
+BOOST_SPIRIT_DEFINE(ruleFunctionDefinition, ruleFunctionParameter, ruleFunctionArgument, ruleNameOrFunctionCall);
+BOOST_SPIRIT_DEFINE(ruleAssignmentOrExpression, ruleIf, ruleStatement, ruleBlock, ruleAST);
+
+}
+
+// X3 grammar로 스크립트를 파싱한다.
+ASTPtr ParseX3(std::wstring_view strScript, size_t& stopOffset, bool& bMatched)
+{
+	ASTPtr prog;
+
+	std::wstring_view::const_iterator iter = strScript.begin();
+	bMatched = x3::phrase_parse(iter, strScript.end(), x3_grammar::ruleAST, x3_grammar::skipper, prog);
+	stopOffset = iter - strScript.begin();
+
+	if (bMatched && iter == strScript.end())
+		return prog;
+
+	return nullptr;
+}
+
+}
@@ -0,0 +1,19 @@
+﻿#pragma once
+
+/*
+Boost.Spirit X3 grammar.
+dsl_grammar(Qi)와 같은 규칙으로 같은 AST를 만든다. EParserBackend::SpiritX3 으로 선택한다.
+
+Qi grammar와 다른 점
+  - rule은 type erasure 없이 정적으로 조합된다. 실행시간에 rule 객체나 grammar를 생성하지 않는다.
+  - semantic action은 Phoenix 대신 람다를 사용한다.
+  - grammar를 이 파일에서만 정의하므로, 파서를 수정해도 parser.cpp를 다시 컴파일하지 않는다.
+*/
+
+namespace dsl
+{
+	// X3 grammar로 스크립트를 파싱한다. 모든 입력을 소비하지 못하면 nullptr를 반환한다.
+	// @stopOffset	: 파싱이 멈춘 위치
+	// @bMatched	: 앞부분이라도 파싱에 성공했는지 여부
+	ASTPtr ParseX3(std::wstring_view strScript, size_t& stopOffset, bool& bMatched);
+}
@@ -5,16 +5,24 @@
 #include <memory>
 #include <functional>
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <sstream>
 #include <fstream>
+#include <filesystem>
 #include <thread>
 #include <chrono>
 #include <vector>
+#include <deque>
+#include <array>
+#include <algorithm>
+#include <limits>
 #include <set>
 #include <map>
 #include <unordered_set>
 #include <unordered_map>
 #include <mutex>
+#include <atomic>
 #include <shared_mutex>
 #include <any>
 #include <type_traits>
@@ -0,0 +1,405 @@
+﻿#include "pch.h"
+
+#include <bit>
+#include <atomic>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DSL_SCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define DSL_SCAN_X86 0
+#endif
+
+// gcc/clang은 함수마다 사용할 명령어 집합을 지정해야 한다. MSVC는 지정하지 않아도 된다.
+#if defined(__GNUC__) || defined(__clang__)
+#define DSL_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define DSL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DSL_TARGET_SSE42
+#define DSL_TARGET_AVX2
+#endif
+
+#include "scan.h"
+
+namespace dsl
+{
+
+// 스캔 종류
+enum class EScanKind
+{
+	Space,		// 공백이 아닌 글자에서 멈춤
+	LineEnd,	// '\n'에서 멈춤
+	Quote,		// '"'에서 멈춤
+	Name,		// 이름에 사용할 수 없는 글자에서 멈춤
+};
+
+
+/* 스칼라 */
+
+template <EScanKind eKind, typename CharT>
+static bool isScanStop(const CharT c)
+{
+	if constexpr (EScanKind::Space == eKind)
+		return !IsSpaceChar(c);
+	else if constexpr (EScanKind::LineEnd == eKind)
+		return CharT('\n') == c;
+	else if constexpr (EScanKind::Quote == eKind)
+		return CharT('"') == c;
+	else
+		return !IsNameChar(c);
+}
+
+template <EScanKind eKind, typename CharT>
+static const CharT* scanScalar(const CharT* p, const CharT* end)
+{
+	while (p < end && !isScanStop<eKind>(*p))
+		++p;
+	return p;
+}
+
+
+#if DSL_SCAN_X86
+
+/* SSE4.2 (128비트) */
+
+// 글자 크기(1, 2, 4바이트)별 128비트 레인 연산
+template <size_t LaneSize> struct LaneSse;
+
+template <> struct LaneSse<1>
+{
+	DSL_TARGET_SSE42 static __m128i Set(const int c) { return _mm_set1_epi8(static_cast<char>(c)); }
+	DSL_TARGET_SSE42 static __m128i Eq(const __m128i a, const __m128i b) { return _mm_cmpeq_epi8(a, b); }
+	DSL_TARGET_SSE42 static __m128i Sub(const __m128i a, const __m128i b) { return _mm_sub_epi8(a, b); }
+	DSL_TARGET_SSE42 static __m128i MinU(const __m128i a, const __m128i b) { return _mm_min_epu8(a, b); }
+
+	// [lo, lo + count] 범위에 있는 레인을 모두 1로 채운다. (부호 없는 비교)
+	DSL_TARGET_SSE42 static __m128i InRange(const __m128i v, const int lo, const int count)
+	{
+		const __m128i d = Sub(v, Set(lo));
+		return Eq(MinU(d, Set(count)), d);
+	}
+};
+
+template <> struct LaneSse<2>
+{
+	DSL_TARGET_SSE42 static __m128i Set(const int c) { return _mm_set1_epi16(static_cast<short>(c)); }
+	DSL_TARGET_SSE42 static __m128i Eq(const __m128i a, const __m128i b) { return _mm_cmpeq_epi16(a, b); }
+	DSL_TARGET_SSE42 static __m128i Sub(const __m128i a, const __m128i b) { return _mm_sub_epi16(a, b); }
+	DSL_TARGET_SSE42 static __m128i MinU(const __m128i a, const __m128i b) { return _mm_min_epu16(a, b); }
+
+	// [lo, lo + count] 범위에 있는 레인을 모두 1로 채운다. (부호 없는 비교)
+	DSL_TARGET_SSE42 static __m128i InRange(const __m128i v, const int lo, const int count)
+	{
+		const __m128i d = Sub(v, Set(lo));
+		return Eq(MinU(d, Set(count)), d);
+	}
+};
+
+template <> struct LaneSse<4>
+{
+	DSL_TARGET_SSE42 static __m128i Set(const int c) { return _mm_set1_epi32(c); }
+	DSL_TARGET_SSE42 static __m128i Eq(const __m128i a, const __m128i b) { return _mm_cmpeq_epi32(a, b); }
+	DSL_TARGET_SSE42 static __m128i Sub(const __m128i a, const __m128i b) { return _mm_sub_epi32(a, b); }
+	DSL_TARGET_SSE42 static __m128i MinU(const __m128i a, const __m128i b) { return _mm_min_epu32(a, b); }
+
+	// [lo, lo + count] 범위에 있는 레인을 모두 1로 채운다. (부호 없는 비교)
+	DSL_TARGET_SSE42 static __m128i InRange(const __m128i v, const int lo, const int count)
+	{
+		const __m128i d = Sub(v, Set(lo));
+		return Eq(MinU(d, Set(count)), d);
+	}
+};
+
+// 멈춰야 하는 글자의 바이트 마스크
+template <EScanKind eKind, typename CharT>
+DSL_TARGET_SSE42 static unsigned int stopMaskSse(const __m128i v)
+{
+	using Lane = LaneSse<sizeof(CharT)>;
+
+	if constexpr (EScanKind::LineEnd == eKind)
+	{
+		return static_cast<unsigned int>(_mm_movemask_epi8(Lane::Eq(v, Lane::Set('\n'))));
+	}
+	else if constexpr (EScanKind::Quote == eKind)
+	{
+		return static_cast<unsigned int>(_mm_movemask_epi8(Lane::Eq(v, Lane::Set('"'))));
+	}
+	else if constexpr (EScanKind::Space == eKind)
+	{
+		const __m128i space = _mm_or_si128(Lane::Eq(v, Lane::Set(' ')), Lane::InRange(v, '\t', '\r' - '\t'));
+		return ~static_cast<unsigned int>(_mm_movemask_epi8(space)) & 0xFFFFu;
+	}
+	else
+	{
+		// 0x20을 OR하면 대문자가 소문자가 된다.
+		const __m128i alpha = Lane::InRange(_mm_or_si128(v, Lane::Set(0x20)), 'a', 'z' - 'a');
+		const __m128i digit = Lane::InRange(v, '0', '9' - '0');
+		const __m128i name = _mm_or_si128(_mm_or_si128(alpha, digit), Lane::Eq(v, Lane::Set('_')));
+		return ~static_cast<unsigned int>(_mm_movemask_epi8(name)) & 0xFFFFu;
+	}
+}
+
+template <EScanKind eKind, typename CharT>
+DSL_TARGET_SSE42 static const CharT* scanSse42(const CharT* p, const CharT* end)
+{
+	constexpr size_t laneCount = sizeof(__m128i) / sizeof(CharT);
+
+	while (static_cast<size_t>(end - p) >= laneCount)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		const unsigned int mask = stopMaskSse<eKind, CharT>(v);
+		if (0 != mask)
+			return p + std::countr_zero(mask) / sizeof(CharT);
+
+		p += laneCount;
+	}
+
+	return scanScalar<eKind>(p, end);
+}
+
+
+/* AVX2 (256비트) */
+
+// 글자 크기(1, 2, 4바이트)별 256비트 레인 연산
+template <size_t LaneSize> struct LaneAvx2;
+
+template <> struct LaneAvx2<1>
+{
+	DSL_TARGET_AVX2 static __m256i Set(const int c) { return _mm256_set1_epi8(static_cast<char>(c)); }
+	DSL_TARGET_AVX2 static __m256i Eq(const __m256i a, const __m256i b) { return _mm256_cmpeq_epi8(a, b); }
+	DSL_TARGET_AVX2 static __m256i Sub(const __m256i a, const __m256i b) { return _mm256_sub_epi8(a, b); }
+	DSL_TARGET_AVX2 static __m256i MinU(const __m256i a, const __m256i b) { return _mm256_min_epu8(a, b); }
+
+	// [lo, lo + count] 범위에 있는 레인을 모두 1로 채운다. (부호 없는 비교)
+	DSL_TARGET_AVX2 static __m256i InRange(const __m256i v, const int lo, const int count)
+	{
+		const __m256i d = Sub(v, Set(lo));
+		return Eq(MinU(d, Set(count)), d);
+	}
+};
+
+template <> struct LaneAvx2<2>
+{
+	DSL_TARGET_AVX2 static __m256i Set(const int c) { return _mm256_set1_epi16(static_cast<short>(c)); }
+	DSL_TARGET_AVX2 static __m256i Eq(const __m256i a, const __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+	DSL_TARGET_AVX2 static __m256i Sub(const __m256i a, const __m256i b) { return _mm256_sub_epi16(a, b); }
+	DSL_TARGET_AVX2 static __m256i MinU(const __m256i a, const __m256i b) { return _mm256_min_epu16(a, b); }
+
+	// [lo, lo + count] 범위에 있는 레인을 모두 1로 채운다. (부호 없는 비교)
+	DSL_TARGET_AVX2 static __m256i InRange(const __m256i v, const int lo, const int count)
+	{
+		const __m256i d = Sub(v, Set(lo));
+		return Eq(MinU(d, Set(count)), d);
+	}
+};
+
+template <> struct LaneAvx2<4>
+{
+	DSL_TARGET_AVX2 static __m256i Set(const int c) { return _mm256_set1_epi32(c); }
+	DSL_TARGET_AVX2 static __m256i Eq(const __m256i a, const __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+	DSL_TARGET_AVX2 static __m256i Sub(const __m256i a, const __m256i b) { return _mm256_sub_epi32(a, b); }
+	DSL_TARGET_AVX2 static __m256i MinU(const __m256i a, const __m256i b) { return _mm256_min_epu32(a, b); }
+
+	// [lo, lo + count] 범위에 있는 레인을 모두 1로 채운다. (부호 없는 비교)
+	DSL_TARGET_AVX2 static __m256i InRange(const __m256i v, const int lo, const int count)
+	{
+		const __m256i d = Sub(v, Set(lo));
+		return Eq(MinU(d, Set(count)), d);
+	}
+};
+
+// 멈춰야 하는 글자의 바이트 마스크
+template <EScanKind eKind, typename CharT>
+DSL_TARGET_AVX2 static unsigned int stopMaskAvx2(const __m256i v)
+{
+	using Lane = LaneAvx2<sizeof(CharT)>;
+
+	if constexpr (EScanKind::LineEnd == eKind)
+	{
+		return static_cast<unsigned int>(_mm256_movemask_epi8(Lane::Eq(v, Lane::Set('\n'))));
+	}
+	else if constexpr (EScanKind::Quote == eKind)
+	{
+		return static_cast<unsigned int>(_mm256_movemask_epi8(Lane::Eq(v, Lane::Set('"'))));
+	}
+	else if constexpr (EScanKind::Space == eKind)
+	{
+		const __m256i space = _mm256_or_si256(Lane::Eq(v, Lane::Set(' ')), Lane::InRange(v, '\t', '\r' - '\t'));
+		return ~static_cast<unsigned int>(_mm256_movemask_epi8(space));
+	}
+	else
+	{
+		// 0x20을 OR하면 대문자가 소문자가 된다.
+		const __m256i alpha = Lane::InRange(_mm256_or_si256(v, Lane::Set(0x20)), 'a', 'z' - 'a');
+		const __m256i digit = Lane::InRange(v, '0', '9' - '0');
+		const __m256i name = _mm256_or_si256(_mm256_or_si256(alpha, digit), Lane::Eq(v, Lane::Set('_')));
+		return ~static_cast<unsigned int>(_mm256_movemask_epi8(name));
+	}
+}
+
+template <EScanKind eKind, typename CharT>
+DSL_TARGET_AVX2 static const CharT* scanAvx2(const CharT* p, const CharT* end)
+{
+	constexpr size_t laneCount = sizeof(__m256i) / sizeof(CharT);
+
+	while (static_cast<size_t>(end - p) >= laneCount)
+	{
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		const unsigned int mask = stopMaskAvx2<eKind, CharT>(v);
+		if (0 != mask)
+			return p + std::countr_zero(mask) / sizeof(CharT);
+
+		p += laneCount;
+	}
+
+	return scanScalar<eKind>(p, end);
+}
+
+#endif // DSL_SCAN_X86
+
+
+/* 실행 시점 선택 */
+
+// CPU 검사
+static EScanLevel detectScanLevel()
+{
+#if DSL_SCAN_X86
+#if defined(_MSC_VER)
+	int info[4] = {};
+	__cpuid(info, 1);
+	const bool bSse42 = 0 != (info[2] & (1 << 20));
+	const bool bOsxsave = 0 != (info[2] & (1 << 27));
+
+	bool bAvx2 = false;
+	if (bOsxsave && 6 == (_xgetbv(0) & 6))	// OS가 ymm 레지스터를 저장하는지 확인
+	{
+		__cpuidex(info, 7, 0);
+		bAvx2 = 0 != (info[1] & (1 << 5));
+	}
+#else
+	__builtin_cpu_init();
+	const bool bSse42 = __builtin_cpu_supports("sse4.2");
+	const bool bAvx2 = __builtin_cpu_supports("avx2");
+#endif
+
+	if (bAvx2)
+		return EScanLevel::AVX2;
+	if (bSse42)
+		return EScanLevel::SSE42;
+#endif
+
+	return EScanLevel::Scalar;
+}
+
+// 글자 타입별 스캔 함수 테이블
+template <typename CharT>
+struct ScanKernels
+{
+	using FuncScan = const CharT* (*)(const CharT*, const CharT*);
+
+	FuncScan pfnSpace;
+	FuncScan pfnLineEnd;
+	FuncScan pfnQuote;
+	FuncScan pfnName;
+};
+
+template <typename CharT>
+static ScanKernels<CharT> makeScanKernels(const EScanLevel eLevel)
+{
+#if DSL_SCAN_X86
+	if (EScanLevel::AVX2 == eLevel)
+		return { &scanAvx2<EScanKind::Space, CharT>, &scanAvx2<EScanKind::LineEnd, CharT>, &scanAvx2<EScanKind::Quote, CharT>, &scanAvx2<EScanKind::Name, CharT> };
+	if (EScanLevel::SSE42 == eLevel)
+		return { &scanSse42<EScanKind::Space, CharT>, &scanSse42<EScanKind::LineEnd, CharT>, &scanSse42<EScanKind::Quote, CharT>, &scanSse42<EScanKind::Name, CharT> };
+#endif
+
+	return { &scanScalar<EScanKind::Space, CharT>, &scanScalar<EScanKind::LineEnd, CharT>, &scanScalar<EScanKind::Quote, CharT>, &scanScalar<EScanKind::Name, CharT> };
+}
+
+EScanLevel GetSupportedScanLevel()
+{
+	static const EScanLevel eSupportedLevel = detectScanLevel();
+	return eSupportedLevel;
+}
+
+// 현재 스캔 수준. 기본값은 CPU가 지원하는 가장 높은 수준이다.
+static std::atomic<EScanLevel>& getScanLevelRef()
+{
+	static std::atomic<EScanLevel> eLevel(GetSupportedScanLevel());
+	return eLevel;
+}
+
+template <typename CharT>
+static ScanKernels<CharT>& getScanKernels()
+{
+	static ScanKernels<CharT> kernels = makeScanKernels<CharT>(GetScanLevel());
+	return kernels;
+}
+
+EScanLevel GetScanLevel()
+{
+	return getScanLevelRef();
+}
+
+void SetScanLevel(const EScanLevel eLevel)
+{
+	const EScanLevel eSupportedLevel = GetSupportedScanLevel();
+	const EScanLevel eNewLevel = (eLevel < eSupportedLevel) ? eLevel : eSupportedLevel;
+
+	getScanLevelRef() = eNewLevel;
+	getScanKernels<char>() = makeScanKernels<char>(eNewLevel);
+	getScanKernels<wchar_t>() = makeScanKernels<wchar_t>(eNewLevel);
+}
+
+const wchar_t* GetScanLevelName(const EScanLevel eLevel)
+{
+	switch (eLevel)
+	{
+	case EScanLevel::Scalar: return L"scalar";
+	case EScanLevel::SSE42: return L"sse4.2";
+	case EScanLevel::AVX2: return L"avx2";
+	}
+	return L"unknown";
+}
+
+
+/* 스캔 함수 */
+
+template <typename CharT>
+const CharT* ScanSpace(const CharT* p, const CharT* end)
+{
+	return getScanKernels<CharT>().pfnSpace(p, end);
+}
+
+template <typename CharT>
+const CharT* ScanLineEnd(const CharT* p, const CharT* end)
+{
+	return getScanKernels<CharT>().pfnLineEnd(p, end);
+}
+
+template <typename CharT>
+const CharT* ScanQuote(const CharT* p, const CharT* end)
+{
+	return getScanKernels<CharT>().pfnQuote(p, end);
+}
+
+template <typename CharT>
+const CharT* ScanNameChars(const CharT* p, const CharT* end)
+{
+	return getScanKernels<CharT>().pfnName(p, end);
+}
+
+// UTF-8(char)과 wchar_t 스크립트용으로 인스턴스화
+template const char* ScanSpace<char>(const char*, const char*);
+template const char* ScanLineEnd<char>(const char*, const char*);
+template const char* ScanQuote<char>(const char*, const char*);
+template const char* ScanNameChars<char>(const char*, const char*);
+template const wchar_t* ScanSpace<wchar_t>(const wchar_t*, const wchar_t*);
+template const wchar_t* ScanLineEnd<wchar_t>(const wchar_t*, const wchar_t*);
+template const wchar_t* ScanQuote<wchar_t>(const wchar_t*, const wchar_t*);
+template const wchar_t* ScanNameChars<wchar_t>(const wchar_t*, const wchar_t*);
+
+}
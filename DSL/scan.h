@@ -0,0 +1,51 @@
+﻿#pragma once
+
+/*
+렉서에서 사용하는 문자 스캔 함수.
+긴 공백, 주석, 문자열, 이름을 SIMD 명령어로 한 번에 여러 글자씩 검사한다.
+사용할 명령어 집합은 실행 시점에 CPU를 검사해서 선택하며, 지원하지 않으면 스칼라 코드를 사용한다.
+*/
+
+namespace dsl
+{
+	// 스캔 명령어 집합
+	enum class EScanLevel
+	{
+		Scalar,
+		SSE42,
+		AVX2,
+	};
+
+	// CPU가 지원하는 가장 높은 스캔 명령어 집합
+	EScanLevel GetSupportedScanLevel();
+
+	// 현재 사용중인 스캔 명령어 집합
+	EScanLevel GetScanLevel();
+
+	// 스캔 명령어 집합 변경 (벤치마크용). CPU가 지원하는 수준보다 높게 설정할 수 없다.
+	// 다른 스레드가 렉서를 사용하지 않을 때 호출해야 한다.
+	void SetScanLevel(const EScanLevel eLevel);
+
+	const wchar_t* GetScanLevelName(const EScanLevel eLevel);
+
+
+	// 문자 분류. dsl_grammar와 같이 ascii 기준으로 분류한다.
+	template <typename CharT> inline bool IsSpaceChar(const CharT c) { return CharT(' ') == c || (CharT('\t') <= c && c <= CharT('\r')); }
+	template <typename CharT> inline bool IsDigitChar(const CharT c) { return CharT('0') <= c && c <= CharT('9'); }
+	template <typename CharT> inline bool IsAlphaChar(const CharT c) { return (CharT('a') <= c && c <= CharT('z')) || (CharT('A') <= c && c <= CharT('Z')); }
+	template <typename CharT> inline bool IsNameStartChar(const CharT c) { return IsAlphaChar(c) || CharT('_') == c; }
+	template <typename CharT> inline bool IsNameChar(const CharT c) { return IsAlphaChar(c) || IsDigitChar(c) || CharT('_') == c; }
+
+
+	// [p, end) 에서 공백이 아닌 첫 글자의 위치. 없으면 end.
+	template <typename CharT> const CharT* ScanSpace(const CharT* p, const CharT* end);
+
+	// [p, end) 에서 첫 '\n'의 위치. 없으면 end. ('-- 주석'의 끝을 찾을 때 사용)
+	template <typename CharT> const CharT* ScanLineEnd(const CharT* p, const CharT* end);
+
+	// [p, end) 에서 첫 '"'의 위치. 없으면 end. (문자열의 끝을 찾을 때 사용)
+	template <typename CharT> const CharT* ScanQuote(const CharT* p, const CharT* end);
+
+	// [p, end) 에서 이름에 사용할 수 없는 첫 글자의 위치. 없으면 end.
+	template <typename CharT> const CharT* ScanNameChars(const CharT* p, const CharT* end);
+}
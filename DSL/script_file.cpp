@@ -0,0 +1,226 @@
+﻿#include "pch.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "script_file.h"
+
+namespace dsl
+{
+
+ScriptFile::ScriptFile()
+	: m_bOpen(false)
+	, m_pView(nullptr)
+	, m_viewSize(0)
+{
+}
+
+ScriptFile::~ScriptFile()
+{
+	Close();
+}
+
+// 파일을 연다.
+// 파일 전체를 읽기 전용으로 매핑한다. 매핑한 다음에는 파일 핸들이 필요없으므로 바로 닫는다.
+bool ScriptFile::Open(const std::wstring& filePath)
+{
+	Close();
+
+	size_t fileSize = 0;
+	void* pView = nullptr;
+
+#ifdef _WIN32
+	HANDLE hFile = ::CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (INVALID_HANDLE_VALUE == hFile)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!::GetFileSizeEx(hFile, &size))
+	{
+		::CloseHandle(hFile);
+		return false;
+	}
+	fileSize = static_cast<size_t>(size.QuadPart);
+
+	// 크기가 0인 파일은 매핑할 수 없다.
+	if (0 < fileSize)
+	{
+		HANDLE hMapping = ::CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (nullptr != hMapping)
+		{
+			pView = ::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+			::CloseHandle(hMapping);
+		}
+	}
+	::CloseHandle(hFile);
+#else
+	const int fd = ::open(WideToUtf8(filePath).c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat fileStat;
+	if (0 != ::fstat(fd, &fileStat))
+	{
+		::close(fd);
+		return false;
+	}
+	fileSize = static_cast<size_t>(fileStat.st_size);
+
+	if (0 < fileSize)
+	{
+		pView = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (MAP_FAILED == pView)
+			pView = nullptr;
+		else
+			::madvise(pView, fileSize, MADV_SEQUENTIAL);
+	}
+	::close(fd);
+#endif
+
+	if (0 < fileSize && nullptr == pView)
+		return false;
+
+	m_bOpen = true;
+	m_pView = pView;
+	m_viewSize = fileSize;
+	m_strText = std::string_view(static_cast<const char*>(pView), fileSize);
+
+	// UTF-8 BOM 제거
+	if (m_strText.starts_with("\xEF\xBB\xBF"))
+		m_strText.remove_prefix(3);
+
+	return true;
+}
+
+void ScriptFile::Close()
+{
+	if (nullptr != m_pView)
+	{
+#ifdef _WIN32
+		::UnmapViewOfFile(m_pView);
+#else
+		::munmap(m_pView, m_viewSize);
+#endif
+	}
+
+	m_bOpen = false;
+	m_pView = nullptr;
+	m_viewSize = 0;
+	m_strText = std::string_view();
+}
+
+
+// UTF-8 문자열을 wchar_t 문자열로 변환한다.
+// wchar_t가 2바이트(Windows)이면 BMP 밖의 문자는 surrogate pair로 변환한다.
+std::wstring Utf8ToWide(const std::string_view strUtf8)
+{
+	std::wstring str;
+	str.reserve(strUtf8.size());
+
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(strUtf8.data());
+	const unsigned char* const end = p + strUtf8.size();
+
+	while (p < end)
+	{
+		// ascii
+		if (*p < 0x80)
+		{
+			str.push_back(static_cast<wchar_t>(*p++));
+			continue;
+		}
+
+		// 시작 바이트로 길이와 최소값(overlong 검사용)을 구한다.
+		size_t length = 0;
+		char32_t codePoint = 0;
+		char32_t minCodePoint = 0;
+		if (0xC0 == (*p & 0xE0))		{ length = 2; codePoint = *p & 0x1F; minCodePoint = 0x80; }
+		else if (0xE0 == (*p & 0xF0))	{ length = 3; codePoint = *p & 0x0F; minCodePoint = 0x800; }
+		else if (0xF0 == (*p & 0xF8))	{ length = 4; codePoint = *p & 0x07; minCodePoint = 0x10000; }
+
+		bool bValid = (0 != length && static_cast<size_t>(end - p) >= length);
+		for (size_t i = 1; bValid && i < length; ++i)
+		{
+			if (0x80 != (p[i] & 0xC0))
+				bValid = false;
+			else
+				codePoint = (codePoint << 6) | (p[i] & 0x3F);
+		}
+
+		if (!bValid || codePoint < minCodePoint || 0x10FFFF < codePoint || (0xD800 <= codePoint && codePoint <= 0xDFFF))
+		{
+			str.push_back(static_cast<wchar_t>(0xFFFD));
+			++p;
+			continue;
+		}
+		p += length;
+
+		if constexpr (sizeof(wchar_t) == 2)
+		{
+			if (0x10000 <= codePoint)
+			{
+				codePoint -= 0x10000;
+				str.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+				str.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+				continue;
+			}
+		}
+
+		str.push_back(static_cast<wchar_t>(codePoint));
+	}
+
+	return str;
+}
+
+// wchar_t 문자열을 UTF-8 문자열로 변환한다.
+std::string WideToUtf8(const std::wstring_view str)
+{
+	std::string strUtf8;
+	strUtf8.reserve(str.size());
+
+	for (size_t i = 0; i < str.size(); ++i)
+	{
+		char32_t codePoint = static_cast<char32_t>(str[i]);
+
+		// surrogate pair (wchar_t가 2바이트인 경우)
+		if (0xD800 <= codePoint && codePoint <= 0xDBFF && i + 1 < str.size())
+		{
+			const char32_t low = static_cast<char32_t>(str[i + 1]);
+			if (0xDC00 <= low && low <= 0xDFFF)
+			{
+				codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+				++i;
+			}
+		}
+
+		if (codePoint < 0x80)
+		{
+			strUtf8.push_back(static_cast<char>(codePoint));
+		}
+		else if (codePoint < 0x800)
+		{
+			strUtf8.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+			strUtf8.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+		else if (codePoint < 0x10000)
+		{
+			strUtf8.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+			strUtf8.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+			strUtf8.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+		else
+		{
+			strUtf8.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+			strUtf8.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+			strUtf8.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+			strUtf8.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+	}
+
+	return strUtf8;
+}
+
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+/*
+스크립트 파일 로드.
+파일을 메모리에 매핑해서 UTF-8 바이트를 그대로 파서에 전달한다. wchar_t 문자열로 복사하거나 로케일 변환을 하지 않는다.
+*/
+
+namespace dsl
+{
+	// 읽기 전용으로 메모리에 매핑된 스크립트 파일
+	class ScriptFile
+	{
+	public:
+		ScriptFile();
+		~ScriptFile();
+
+		ScriptFile(const ScriptFile&) = delete;
+		ScriptFile& operator=(const ScriptFile&) = delete;
+
+	public:
+		// 파일을 연다. 이미 열려있는 파일은 닫는다.
+		bool Open(const std::wstring& filePath);
+		void Close();
+
+		bool IsOpen() const { return m_bOpen; }
+
+		// 파일 내용. UTF-8 BOM은 제외한다. 파일이 닫히면 더 이상 사용할 수 없다.
+		std::string_view GetText() const { return m_strText; }
+
+	private:
+		bool				m_bOpen;
+		void*				m_pView;		// 매핑된 메모리 시작 주소 (빈 파일이면 nullptr)
+		size_t				m_viewSize;
+		std::string_view	m_strText;
+	};
+
+
+	// UTF-8 문자열을 wchar_t 문자열로 변환한다. 잘못된 바이트는 U+FFFD로 변환한다.
+	std::wstring Utf8ToWide(const std::string_view strUtf8);
+
+	// wchar_t 문자열을 UTF-8 문자열로 변환한다.
+	std::string WideToUtf8(const std::wstring_view str);
+}
@@ -0,0 +1,148 @@
+﻿#include "pch.h"
+
+#include "ast.h"
+#include "token_parser.h"
+#include "script_file.h"
+#include "stream_parser.h"
+
+namespace dsl
+{
+
+// chunk는 첫 chunk에서 UTF-8 BOM을 확인할 수 있도록 4 bytes 이상이어야 한다.
+StreamParser::StreamParser(const size_t chunkSize /*= DefaultChunkSize*/)
+	: m_chunkSize((std::max)(chunkSize, static_cast<size_t>(4)))
+	, m_statementCount(0)
+	, m_inputLength(0)
+	, m_maxBufferSize(0)
+	, m_errorOffset(0)
+{
+}
+
+// 입력 스트림을 끝까지 파싱한다.
+// 버퍼에는 아직 구문으로 만들지 못한 부분만 남겨두고, 새 chunk를 뒤에 붙인다.
+// 마지막 chunk가 아니면 버퍼의 마지막 줄바꿈까지만 토큰으로 분리한다. (토큰이 chunk 경계에서 잘리지 않도록)
+bool StreamParser::Parse(std::istream& input, const StatementCallback& callback)
+{
+	m_statementCount = 0;
+	m_inputLength = 0;
+	m_maxBufferSize = 0;
+	m_errorOffset = 0;
+	m_spConstantPool = std::make_shared<ConstantPool>();
+
+	ConstantPool::Scope poolScope(m_spConstantPool);
+
+	std::string buffer;
+	size_t baseOffset = 0;		// buffer[0]의 입력에서의 위치
+	bool bEof = false;
+
+	while (true)
+	{
+		// chunk 읽기
+		// 버퍼에 남은 구문이 chunk보다 크면 그만큼 읽어서 같은 구문을 다시 파싱하는 횟수를 줄인다.
+		const size_t oldSize = buffer.size();
+		const size_t chunkSize = (std::max)(m_chunkSize, oldSize);
+		buffer.resize(oldSize + chunkSize);
+		input.read(buffer.data() + oldSize, static_cast<std::streamsize>(chunkSize));
+		const size_t readSize = static_cast<size_t>(input.gcount());
+		buffer.resize(oldSize + readSize);
+		bEof = !input;
+
+		// UTF-8 BOM 제거
+		if (0 == m_inputLength && std::string_view(buffer).starts_with("\xEF\xBB\xBF"))
+		{
+			buffer.erase(0, 3);
+			baseOffset = 3;
+		}
+		m_inputLength += readSize;
+		m_maxBufferSize = (std::max)(m_maxBufferSize, buffer.size());
+
+		// 토큰으로 분리할 범위
+		std::string_view strText(buffer);
+		if (!bEof)
+		{
+			const size_t lineEnd = strText.rfind('\n');
+			if (std::string_view::npos == lineEnd)
+				continue;
+			strText = strText.substr(0, lineEnd + 1);
+		}
+
+		size_t errorOffset = 0;
+		if (!Tokenize(strText, m_tokens, errorOffset))
+		{
+			// 여러 줄에 걸친 문자열이 잘린 경우에는 문자열 앞까지만 파싱하고 나머지는 다음 chunk와 함께 파싱한다.
+			if (bEof || '"' != strText[errorOffset])
+				return fail(strText, errorOffset, baseOffset);
+
+			strText = strText.substr(0, errorOffset);
+			Tokenize(strText, m_tokens, errorOffset);
+		}
+
+		// 완성된 구문을 전달한다.
+		// 구문을 파싱하면서 End 토큰을 봤다면 다음 chunk에 구문이 이어질 수 있으므로 다음 chunk를 읽은 다음 다시 파싱한다.
+		TokenParser parser(strText, m_tokens);
+		const size_t endPos = m_tokens.size() - 1;
+		size_t consumed = m_tokens[0].GetStart();		// 구문으로 만든 부분의 길이
+		while (!parser.IsEnd())
+		{
+			const size_t startPos = parser.GetPosition();
+			BasePtr spStatement = parser.ParseStatement();
+
+			if (!bEof && parser.GetFurthestPosition() + 1 >= endPos)
+			{
+				consumed = m_tokens[startPos].GetStart();
+				break;
+			}
+
+			if (!spStatement)
+				return fail(strText, parser.GetStopOffset(), baseOffset);
+
+			++m_statementCount;
+			if (!callback(spStatement))
+				return true;
+
+			consumed = m_tokens[parser.GetPosition()].GetStart();
+		}
+
+		if (bEof)
+			break;
+
+		buffer.erase(0, consumed);
+		baseOffset += consumed;
+	}
+
+	// ruleBlock은 구문이 1개 이상 있어야 한다.
+	if (0 == m_statementCount)
+		return fail(std::string_view(buffer), buffer.size(), baseOffset);
+
+	return true;
+}
+
+// 스크립트 파일을 파싱한다.
+bool StreamParser::ParseFile(const std::wstring& filePath, const StatementCallback& callback)
+{
+	std::ifstream file(std::filesystem::path(filePath), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		std::wcout << std::format(L"스크립트 파일 열기 실패. fileName = {}", filePath) << std::endl;
+		return false;
+	}
+
+	return Parse(file, callback);
+}
+
+// 파싱 실패 정보 출력
+// @offset		: 버퍼에서 파싱이 멈춘 위치
+// @baseOffset	: 버퍼 시작 위치의 입력에서의 위치
+bool StreamParser::fail(const std::string_view strText, const size_t offset, const size_t baseOffset)
+{
+	m_errorOffset = baseOffset + offset;
+
+	std::wcout << L"Parsing Failed..." << std::endl;
+	std::wcout << L"Parsing Location: " << m_errorOffset << L"/" << m_inputLength << std::endl;
+	if (offset < strText.length())
+		std::wcout << L"Failed Location: " << Utf8ToWide(strText.substr(offset, 20)) << std::endl;
+
+	return false;
+}
+
+}
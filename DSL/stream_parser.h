@@ -0,0 +1,68 @@
+﻿#pragma once
+
+#include "lexer.h"
+
+/*
+스트리밍 파서.
+입력을 chunk 단위로 읽으면서 최상위 구문(ruleBlock의 구문)이 완성될 때마다 콜백으로 전달한다.
+전체 스크립트를 메모리에 올리거나 하나의 Block을 만들지 않으므로, 메모리 사용량은 가장 큰 구문의 크기를 따라간다.
+
+입력은 UTF-8 이며 Token 백엔드로 파싱한다.
+구문이 완성되었는지는 파서가 버퍼 끝(End 토큰)을 보지 않고 구문을 끝냈는지로 판단한다.
+버퍼 끝을 본 구문은 다음 chunk를 읽은 다음 다시 파싱하므로, 결과는 전체를 한 번에 파싱한 것과 같다.
+*/
+
+namespace dsl
+{
+	class StreamParser
+	{
+	public:
+		// 구문 콜백. false를 반환하면 파싱을 중단한다.
+		using StatementCallback = std::function<bool(const BasePtr& spStatement)>;
+
+		static constexpr size_t DefaultChunkSize = 64 * 1024;
+
+	public:
+		explicit StreamParser(const size_t chunkSize = DefaultChunkSize);
+
+		StreamParser(const StreamParser&) = delete;
+		StreamParser& operator=(const StreamParser&) = delete;
+
+	public:
+		// 입력 스트림을 끝까지 파싱한다. 구문이 완성될 때마다 callback을 호출한다.
+		// 파싱에 실패하기 전에 완성된 구문은 이미 callback으로 전달되었을 수 있다.
+		// @return	: 성공 여부. callback이 중단시킨 경우에도 true를 반환한다.
+		bool Parse(std::istream& input, const StatementCallback& callback);
+
+		// 스크립트 파일을 파싱한다.
+		bool ParseFile(const std::wstring& filePath, const StatementCallback& callback);
+
+		// 마지막 Parse 호출에서 전달한 구문 수
+		size_t GetStatementCount() const { return m_statementCount; }
+
+		// 마지막 Parse 호출에서 읽은 입력 바이트 수
+		size_t GetInputLength() const { return m_inputLength; }
+
+		// 마지막 Parse 호출에서 버퍼가 가장 컸을 때의 크기(bytes)
+		size_t GetMaxBufferSize() const { return m_maxBufferSize; }
+
+		// 파싱에 실패한 위치 (입력에서의 byte offset)
+		size_t GetErrorOffset() const { return m_errorOffset; }
+
+		// 마지막 Parse 호출의 상수 풀. 전달한 구문의 리터럴은 이 풀의 버퍼를 공유한다.
+		const ConstantPoolPtr& GetConstantPool() const { return m_spConstantPool; }
+
+	private:
+		bool fail(const std::string_view strText, const size_t offset, const size_t baseOffset);
+
+	private:
+		size_t		m_chunkSize;
+		TokenList	m_tokens;		// 버퍼의 토큰 배열. chunk마다 재사용한다.
+
+		size_t		m_statementCount;
+		size_t		m_inputLength;
+		size_t		m_maxBufferSize;
+		size_t		m_errorOffset;
+		ConstantPoolPtr	m_spConstantPool;
+	};
+}
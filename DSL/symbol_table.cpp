@@ -0,0 +1,75 @@
+﻿#include "pch.h"
+
+#include "symbol_table.h"
+
+namespace dsl
+{
+
+SymbolTable::SymbolTable()
+{
+}
+
+// 프로세스 전체에서 하나뿐인 심볼 테이블
+SymbolTable& SymbolTable::GetInstance()
+{
+	static SymbolTable instance;
+	return instance;
+}
+
+// 이미 발급한 이름은 shared lock만 잡고 찾는다. 파싱하는 동안 대부분의 이름은 이미 발급되어 있다.
+SymbolId SymbolTable::Intern(std::wstring_view strName)
+{
+	{
+		std::shared_lock lock(m_slock);
+
+		const auto iter = m_idMap.find(strName);
+		if (iter != m_idMap.end())
+			return iter->second;
+	}
+
+	std::unique_lock lock(m_slock);
+
+	// lock을 놓은 사이에 다른 스레드가 발급했을 수 있다.
+	const auto iter = m_idMap.find(strName);
+	if (iter != m_idMap.end())
+		return iter->second;
+
+	const SymbolId id = static_cast<SymbolId>(m_names.size());
+	const std::wstring& strStored = m_names.emplace_back(strName);
+	m_idMap.emplace(strStored, id);
+
+	return id;
+}
+
+SymbolId SymbolTable::Find(std::wstring_view strName) const
+{
+	std::shared_lock lock(m_slock);
+
+	const auto iter = m_idMap.find(strName);
+	if (iter == m_idMap.end())
+		return InvalidSymbolId;
+
+	return iter->second;
+}
+
+// 반환한 참조는 테이블이 커져도 유효하다.
+const std::wstring& SymbolTable::GetName(const SymbolId id) const
+{
+	static const std::wstring empty;
+
+	std::shared_lock lock(m_slock);
+
+	if (id >= m_names.size())
+		return empty;
+
+	return m_names[id];
+}
+
+size_t SymbolTable::GetCount() const
+{
+	std::shared_lock lock(m_slock);
+
+	return m_names.size();
+}
+
+}
@@ -0,0 +1,59 @@
+﻿#pragma once
+
+/*
+식별자 심볼 테이블.
+스크립트의 이름(변수, 함수)을 프로세스 전체에서 하나뿐인 32비트 ID로 바꾼다. (interning)
+같은 이름은 어느 스크립트, 어느 스레드에서 파싱하더라도 같은 ID를 가진다.
+AST의 Name 노드는 문자열 대신 ID를 가지며, DSLManager와 Environment는 ID로 함수와 변수를 찾는다.
+발급한 ID와 문자열은 프로세스가 끝날 때까지 유지된다.
+*/
+
+namespace dsl
+{
+	using SymbolId = unsigned int;
+
+	// 발급하지 않은 ID
+	inline constexpr SymbolId InvalidSymbolId = (std::numeric_limits<SymbolId>::max)();
+
+
+	// 심볼 테이블. 모든 함수는 thread-safe 하다.
+	class SymbolTable
+	{
+	public:
+		static SymbolTable& GetInstance();
+
+		SymbolTable(const SymbolTable&) = delete;
+		SymbolTable& operator=(const SymbolTable&) = delete;
+
+	public:
+		// 이름의 ID를 얻는다. 처음 보는 이름이면 새 ID를 발급한다.
+		SymbolId Intern(std::wstring_view strName);
+
+		// 이름의 ID를 찾는다. 발급한 적이 없으면 InvalidSymbolId를 반환한다.
+		// 함수, 변수를 이름으로 찾을 때 사용한다. 없는 이름으로 테이블이 커지지 않는다.
+		SymbolId Find(std::wstring_view strName) const;
+
+		// ID의 이름. 발급하지 않은 ID이면 빈 문자열을 반환한다.
+		const std::wstring& GetName(const SymbolId id) const;
+
+		// 발급한 ID 수
+		size_t GetCount() const;
+
+	private:
+		SymbolTable();
+
+	private:
+		mutable std::shared_mutex m_slock;
+
+		// ID별 이름. deque는 원소를 추가해도 기존 원소의 주소가 바뀌지 않으므로 m_idMap의 key가 이름을 참조할 수 있다.
+		std::deque<std::wstring> m_names;
+
+		// Key=이름, Value=ID
+		std::unordered_map<std::wstring_view, SymbolId> m_idMap;
+	};
+
+
+	inline SymbolId InternSymbol(std::wstring_view strName) { return SymbolTable::GetInstance().Intern(strName); }
+	inline SymbolId FindSymbol(std::wstring_view strName) { return SymbolTable::GetInstance().Find(strName); }
+	inline const std::wstring& GetSymbolName(const SymbolId id) { return SymbolTable::GetInstance().GetName(id); }
+}
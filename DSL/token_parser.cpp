@@ -0,0 +1,674 @@
+﻿#include "pch.h"
+
+#include "ast.h"
+#include "ast_normalize.h"
+#include "numeral.h"
+#include "script_file.h"
+#include "token_parser.h"
+
+namespace dsl
+{
+
+// 이항 연산자 테이블
+// 결합력(binding power)이 클수록 먼저 결합한다. 0이면 이항 연산자가 아니다.
+// dsl_grammar의 symbol2OperatorBinary(결합력 7) ~ symbol8OperatorBinary(결합력 1) 와 같다.
+static constexpr int g_maxBindingPower = 7;
+
+struct OperatorBinary
+{
+	unsigned char bindingPower = 0;
+	EOperator eOperator = EOperator::None;
+};
+
+static const std::array<OperatorBinary, static_cast<size_t>(ETokenSymbol::Count)> g_symbolOperatorBinary = []()
+{
+	std::array<OperatorBinary, static_cast<size_t>(ETokenSymbol::Count)> table{};
+	auto set = [&table](const ETokenSymbol eSymbol, const int bindingPower, const EOperator eOperator) { table[static_cast<size_t>(eSymbol)] = OperatorBinary{ static_cast<unsigned char>(bindingPower), eOperator }; };
+
+	set(ETokenSymbol::Mul, 7, EOperator::Mul);
+	set(ETokenSymbol::Div, 7, EOperator::Div);
+	set(ETokenSymbol::Mod, 7, EOperator::Mod);
+	set(ETokenSymbol::Add, 6, EOperator::Add);
+	set(ETokenSymbol::Sub, 6, EOperator::Sub);
+	set(ETokenSymbol::Less, 5, EOperator::Less);
+	set(ETokenSymbol::Greater, 5, EOperator::Greater);
+	set(ETokenSymbol::LessEqual, 5, EOperator::LessEqual);
+	set(ETokenSymbol::GreaterEqual, 5, EOperator::GreaterEqual);
+	set(ETokenSymbol::Equal, 4, EOperator::Equal);
+	set(ETokenSymbol::NotEqual, 4, EOperator::NotEqual);
+	set(ETokenSymbol::MulAssign, 1, EOperator::MulAssign);
+	set(ETokenSymbol::DivAssign, 1, EOperator::DivAssign);
+	set(ETokenSymbol::AddAssign, 1, EOperator::AddAssign);
+	set(ETokenSymbol::SubAssign, 1, EOperator::SubAssign);
+	return table;
+}();
+
+static const std::array<OperatorBinary, static_cast<size_t>(ETokenKeyword::Count)> g_keywordOperatorBinary = []()
+{
+	std::array<OperatorBinary, static_cast<size_t>(ETokenKeyword::Count)> table{};
+	table[static_cast<size_t>(ETokenKeyword::And)] = OperatorBinary{ 3, EOperator::And };
+	table[static_cast<size_t>(ETokenKeyword::Or)] = OperatorBinary{ 2, EOperator::Or };
+	return table;
+}();
+
+// 토큰의 이항 연산자. 이항 연산자가 아니면 결합력 0
+static OperatorBinary getOperatorBinary(const Token& token)
+{
+	if (ETokenType::Symbol == token.eType)
+		return g_symbolOperatorBinary[token.id];
+	if (ETokenType::Keyword == token.eType)
+		return g_keywordOperatorBinary[token.id];
+	return OperatorBinary{};
+}
+
+// 토큰의 이항 연산자 결합력
+static int getBindingPower(const Token& token)
+{
+	return getOperatorBinary(token).bindingPower;
+}
+
+// 우선순위별 이항 연산자. dsl_grammar의 symbol{level}OperatorBinary 와 같다. (level 2 ~ 8)
+static bool isOperatorBinary(const Token& token, const int level)
+{
+	const int bindingPower = getBindingPower(token);
+	return 0 != bindingPower && g_maxBindingPower + 2 - level == bindingPower;
+}
+
+// 1순위 단항 연산자. dsl_grammar의 symbol1OperatorUnary 와 같다.
+static bool isOperatorUnary(const Token& token)
+{
+	return token.IsKeyword(ETokenKeyword::Not) || token.IsSymbol(ETokenSymbol::Sub);
+}
+
+// 단항 연산자 토큰의 연산자 코드
+static EOperator getOperatorUnary(const Token& token)
+{
+	return token.IsKeyword(ETokenKeyword::Not) ? EOperator::Not : EOperator::Neg;
+}
+
+LazyFunctionBody::LazyFunctionBody(std::shared_ptr<const std::string> spUtf8Source, const size_t offset, const size_t length)
+	: m_spUtf8Source(std::move(spUtf8Source))
+	, m_spConstantPool(ConstantPool::GetCurrent())
+	, m_offset(offset)
+	, m_length(length)
+	, m_bNormalize(false)
+	, m_bMaterialized(false)
+{
+}
+
+// 본문을 파싱해서 Block을 반환한다.
+// 파싱에 실패하더라도 다시 시도하지 않는다. 같은 텍스트는 항상 같은 결과이기 때문이다.
+const BasePtr& LazyFunctionBody::Materialize()
+{
+	std::call_once(m_once, [this]()
+		{
+			const std::string_view strBody = std::string_view(*m_spUtf8Source).substr(m_offset, m_length);
+			ConstantPool::Scope poolScope(m_spConstantPool);
+
+			// 본문은 여러 스레드에서 파싱할 수 있으므로 스크립트의 아레나를 사용하지 않고 힙에 할당한다.
+			ASTArena::Scope arenaScope(nullptr);
+
+			TokenList tokens;
+			size_t errorOffset = 0;
+			if (Tokenize(strBody, tokens, errorOffset))
+			{
+				TokenParser parser(strBody, tokens);
+				if (ASTPtr spAST = parser.ParseAST())
+				{
+					m_spBlock = spAST->block;
+					if (m_bNormalize)
+						NormalizeAST(m_spBlock);
+				}
+				else
+					errorOffset = parser.GetStopOffset();
+			}
+
+			if (!m_spBlock)
+			{
+				std::wcout << L"Function Body Parsing Failed..." << std::endl;
+				std::wcout << L"Parsing Location: " << m_offset + errorOffset << L"/" << m_spUtf8Source->length() << std::endl;
+				if (errorOffset < strBody.length())
+					std::wcout << L"Failed Location: " << Utf8ToWide(strBody.substr(errorOffset, 20)) << std::endl;
+			}
+
+			// 모든 본문을 파싱하면 스크립트 텍스트가 해제된다.
+			m_spUtf8Source.reset();
+			m_spConstantPool.reset();
+			m_bMaterialized.store(true, std::memory_order_release);
+		});
+
+	return m_spBlock;
+}
+
+TokenParser::TokenParser(std::wstring_view strScript, const TokenList& tokens, const EExpressionParser eExpressionParser /*= EExpressionParser::Precedence*/)
+	: m_strScript(strScript)
+	, m_bUtf8(false)
+	, m_tokens(tokens)
+	, m_pos(0)
+	, m_eExpressionParser(eExpressionParser)
+	, m_maxPos(0)
+	, m_consumedTokenCount(0)
+	, m_rescanLength(0)
+	, m_lazyFunctionCount(0)
+{
+}
+
+TokenParser::TokenParser(std::string_view strUtf8Script, const TokenList& tokens, const EExpressionParser eExpressionParser /*= EExpressionParser::Precedence*/)
+	: m_strUtf8Script(strUtf8Script)
+	, m_bUtf8(true)
+	, m_tokens(tokens)
+	, m_pos(0)
+	, m_eExpressionParser(eExpressionParser)
+	, m_maxPos(0)
+	, m_consumedTokenCount(0)
+	, m_rescanLength(0)
+	, m_lazyFunctionCount(0)
+{
+}
+
+// AST를 만든다.
+ASTPtr TokenParser::ParseAST()
+{
+	m_pos = 0;
+	m_maxPos = 0;
+	m_consumedTokenCount = 0;
+	m_rescanLength = 0;
+	m_lazyFunctionCount = 0;
+	m_functions.clear();
+
+	BasePtr spBlock = parseBlock();
+	if (!spBlock)
+		return nullptr;
+
+	// 모든 토큰을 소비해야 성공이다.
+	if (ETokenType::End != peek().eType)
+		return nullptr;
+
+	return MakeNode<AST>(spBlock);
+}
+
+size_t TokenParser::GetStopOffset() const
+{
+	return peek().offset;
+}
+
+// 토큰 문자열. UTF-8 스크립트는 이 때 wchar_t 문자열로 변환한다.
+std::wstring TokenParser::getText(const Token& token) const
+{
+	if (m_bUtf8)
+		return Utf8ToWide(m_strUtf8Script.substr(token.offset, token.length));
+
+	return std::wstring(m_strScript.substr(token.offset, token.length));
+}
+
+// 현재 토큰을 소비하고 반환한다.
+// 이미 소비했던 위치라면 백트래킹으로 다시 읽는 것이므로 통계에 더한다.
+const Token& TokenParser::next()
+{
+	const Token& token = m_tokens[m_pos++];
+
+	++m_consumedTokenCount;
+	if (m_pos <= m_maxPos)
+		m_rescanLength += token.length;
+	else
+		m_maxPos = m_pos;
+
+	return token;
+}
+
+bool TokenParser::acceptKeyword(const ETokenKeyword eKeyword)
+{
+	if (!peek().IsKeyword(eKeyword))
+		return false;
+
+	next();
+	return true;
+}
+
+bool TokenParser::acceptSymbol(const ETokenSymbol eSymbol)
+{
+	if (!peek().IsSymbol(eSymbol))
+		return false;
+
+	next();
+	return true;
+}
+
+// 이름(식별자) 규칙
+// 키워드는 렉서에서 Keyword 토큰으로 분리되므로 Name 토큰만 확인하면 된다.
+BasePtr TokenParser::parseName()
+{
+	if (ETokenType::Name != peek().eType)
+		return nullptr;
+
+	return MakeNode<Name>(getText(next()));
+}
+
+// 이름 리스트 규칙
+// 콤마로 구분되는 이름 리스트
+BasePtr TokenParser::parseNameList()
+{
+	std::vector<BasePtr> names;
+
+	BasePtr spName = parseName();
+	if (!spName)
+		return nullptr;
+	names.push_back(spName);
+
+	while (true)
+	{
+		const size_t pos = m_pos;
+		if (!acceptSymbol(ETokenSymbol::Comma))
+			break;
+
+		spName = parseName();
+		if (!spName)
+		{
+			m_pos = pos;
+			break;
+		}
+		names.push_back(spName);
+	}
+
+	return MakeNode<NameList>(names);
+}
+
+// bool 규칙
+BasePtr TokenParser::parseBoolean()
+{
+	if (acceptKeyword(ETokenKeyword::False))
+		return MakeNode<Boolean>(false);
+	if (acceptKeyword(ETokenKeyword::True))
+		return MakeNode<Boolean>(true);
+
+	return nullptr;
+}
+
+// 문자열 규칙
+BasePtr TokenParser::parseLiteralString()
+{
+	if (ETokenType::String != peek().eType)
+		return nullptr;
+
+	return MakeNode<LiteralString>(getText(next()));
+}
+
+// 숫자 규칙
+// 정수와 실수를 구분해서 만든다.
+BasePtr TokenParser::parseNumeral()
+{
+	if (ETokenType::Number != peek().eType)
+		return nullptr;
+
+	const Token& token = next();
+
+	NumeralValue value;
+	if (m_bUtf8)
+	{
+		const char* first = m_strUtf8Script.data() + token.offset;
+		ScanNumeral(first, first + token.length, &value);
+	}
+	else
+	{
+		const wchar_t* first = m_strScript.data() + token.offset;
+		ScanNumeral(first, first + token.length, &value);
+	}
+
+	if (value.isInteger)
+		return MakeNode<Numeral>(value.intValue);
+	return MakeNode<Numeral>(value.floatValue);
+}
+
+// 최하위 표현식 규칙
+// 이름, 숫자, bool, 문자열, 괄호로 둘러쌓인 표현식
+// 각 규칙은 첫 토큰의 종류가 서로 다르므로 첫 토큰만 보고 규칙을 선택한다.
+BasePtr TokenParser::parsePrimaryExpression()
+{
+	// 바로 앞에 '+' 부호가 붙은 숫자 ("+5"). dsl_grammar의 ruleNumeral과 같이 부호와 숫자 사이에 공백이 없어야 한다.
+	if (peek().IsSymbol(ETokenSymbol::Add) && ETokenType::Number == peekNext().eType && peek().offset + peek().length == peekNext().offset)
+	{
+		next();
+		return parseNumeral();
+	}
+
+	switch (peek().eType)
+	{
+	case ETokenType::Number:	return parseNumeral();
+	case ETokenType::Keyword:	return parseBoolean();
+	case ETokenType::String:	return parseLiteralString();
+	case ETokenType::Name:		return parseNameOrFunctionCall();
+	default:					break;
+	}
+
+	const size_t pos = m_pos;
+	if (acceptSymbol(ETokenSymbol::LParen))
+	{
+		BasePtr spExpression = parseExpression();
+		if (spExpression && acceptSymbol(ETokenSymbol::RParen))
+			return spExpression;
+	}
+
+	m_pos = pos;
+	return nullptr;
+}
+
+// 1순위 단항연산자 표현식 규칙
+// 단항연산자 표현식을 먼저 검사하고, 매칭되지 않는다면 최하위 표현식인지 검사한다.
+BasePtr TokenParser::parseOperatorUnary()
+{
+	const size_t pos = m_pos;
+	if (isOperatorUnary(peek()))
+	{
+		const Token& opToken = next();
+		if (BasePtr spPrimaryExpression = parsePrimaryExpression())
+			return MakeNode<UnaryExpression>(getOperatorUnary(opToken), spPrimaryExpression);
+
+		m_pos = pos;
+	}
+
+	return parsePrimaryExpression();
+}
+
+// 우선순위별 이항연산자 표현식 규칙 (Cascade)
+// 자신보다 우선순위가 높은 규칙(level - 1)으로 피연산자를 파싱한다.
+// dsl_grammar의 rule8OperatorBinary ~ rule2OperatorBinary 와 같은 방식이며, 비교용으로 남겨둔다.
+BasePtr TokenParser::parseOperatorBinary(const int level)
+{
+	if (level <= 1)
+		return parseOperatorUnary();
+
+	BasePtr spLeft = parseOperatorBinary(level - 1);
+	if (!spLeft)
+		return nullptr;
+
+	while (isOperatorBinary(peek(), level))
+	{
+		const size_t pos = m_pos;
+		const Token& opToken = next();
+
+		BasePtr spRight = parseOperatorBinary(level - 1);
+		if (!spRight)
+		{
+			m_pos = pos;
+			break;
+		}
+
+		spLeft = MakeNode<BinaryExpression>(spLeft, getOperatorBinary(opToken).eOperator, spRight);
+	}
+
+	return spLeft;
+}
+
+// 이항연산자 표현식 규칙 (Precedence climbing)
+// 결합력이 minBindingPower 이상인 연산자만 결합한다.
+// 오른쪽 피연산자는 결합력 + 1 부터 파싱하므로 같은 우선순위는 왼쪽부터 결합하고, Cascade와 같은 트리를 만든다.
+// 리터럴 하나를 파싱할 때 우선순위 단계 수만큼 규칙을 내려가지 않아도 된다.
+BasePtr TokenParser::parseOperatorPrecedence(const int minBindingPower)
+{
+	BasePtr spLeft = parseOperatorUnary();
+	if (!spLeft)
+		return nullptr;
+
+	while (true)
+	{
+		const int bindingPower = getBindingPower(peek());
+		if (0 == bindingPower || bindingPower < minBindingPower)
+			break;
+
+		const size_t pos = m_pos;
+		const Token& opToken = next();
+
+		BasePtr spRight = parseOperatorPrecedence(bindingPower + 1);
+		if (!spRight)
+		{
+			m_pos = pos;
+			break;
+		}
+
+		spLeft = MakeNode<BinaryExpression>(spLeft, getOperatorBinary(opToken).eOperator, spRight);
+	}
+
+	return spLeft;
+}
+
+// 표현식 규칙
+BasePtr TokenParser::parseExpression()
+{
+	if (EExpressionParser::Cascade == m_eExpressionParser)
+		return parseOperatorBinary(8);
+
+	return parseOperatorPrecedence(1);
+}
+
+// 표현식 리스트 규칙
+// 콤마로 구분되는 표현식 리스트
+BasePtr TokenParser::parseExpressionList()
+{
+	std::vector<BasePtr> expressions;
+
+	BasePtr spExpression = parseExpression();
+	if (!spExpression)
+		return nullptr;
+	expressions.push_back(spExpression);
+
+	while (true)
+	{
+		const size_t pos = m_pos;
+		if (!acceptSymbol(ETokenSymbol::Comma))
+			break;
+
+		spExpression = parseExpression();
+		if (!spExpression)
+		{
+			m_pos = pos;
+			break;
+		}
+		expressions.push_back(spExpression);
+	}
+
+	return MakeNode<ExpressionList>(expressions);
+}
+
+// 함수 선언 규칙
+// "function 함수이름 함수파라미터 함수본문 end"
+BasePtr TokenParser::parseFunctionDefinition()
+{
+	const size_t pos = m_pos;
+	if (acceptKeyword(ETokenKeyword::Function))
+	{
+		// 본문의 함수보다 앞에 오도록 자리를 먼저 잡는다.
+		const size_t functionIndex = m_functions.size();
+		m_functions.emplace_back();
+
+		BasePtr spName = parseName();
+		BasePtr spFunctionParameter = spName ? parseFunctionParameter() : nullptr;
+		if (spFunctionParameter && m_spLazySource)
+		{
+			if (std::shared_ptr<LazyFunctionBody> spLazyBody = parseLazyFunctionBody())
+			{
+				std::shared_ptr<FunctionDefinition> spFunctionDefinition = MakeNode<FunctionDefinition>(spName, spFunctionParameter, nullptr);
+				spFunctionDefinition->lazyBody = spLazyBody;
+				m_functions[functionIndex] = spFunctionDefinition;
+				return spFunctionDefinition;
+			}
+		}
+
+		BasePtr spBlock = spFunctionParameter ? parseBlock() : nullptr;
+		if (spBlock && acceptKeyword(ETokenKeyword::End))
+		{
+			std::shared_ptr<FunctionDefinition> spFunctionDefinition = MakeNode<FunctionDefinition>(spName, spFunctionParameter, spBlock);
+			m_functions[functionIndex] = spFunctionDefinition;
+			return spFunctionDefinition;
+		}
+
+		// 실패한 함수와 그 본문에서 파싱한 함수를 버린다.
+		m_functions.resize(functionIndex);
+	}
+
+	m_pos = pos;
+	return nullptr;
+}
+
+// 지연 파싱할 함수 본문
+// 짝이 맞는 end 까지 블록을 여는 키워드(if, do)와 end 만 세면서 건너뛴다.
+// 본문이 비어있거나, 함수 정의가 있거나, 짝이 맞는 end가 없으면 nullptr를 반환한다. 이 때는 바로 파싱해서 오류 위치를 찾는다.
+std::shared_ptr<LazyFunctionBody> TokenParser::parseLazyFunctionBody()
+{
+	if (!m_bUtf8 || peek().IsKeyword(ETokenKeyword::End))
+		return nullptr;
+
+	size_t depth = 0;
+	size_t pos = m_pos;
+	for (; ; ++pos)
+	{
+		const Token& token = m_tokens[pos];
+		if (ETokenType::End == token.eType || token.IsKeyword(ETokenKeyword::Function))
+			return nullptr;
+
+		if (token.IsKeyword(ETokenKeyword::If) || token.IsKeyword(ETokenKeyword::Do))
+			++depth;
+		else if (token.IsKeyword(ETokenKeyword::End))
+		{
+			if (0 == depth)
+				break;
+			--depth;
+		}
+	}
+
+	// 본문 범위는 파라미터의 ')' 다음부터 end 앞까지
+	const Token& lastParameterToken = m_tokens[m_pos - 1];
+	const size_t offset = lastParameterToken.offset + lastParameterToken.length;
+	std::shared_ptr<LazyFunctionBody> spLazyBody = std::make_shared<LazyFunctionBody>(m_spLazySource, offset, m_tokens[pos].offset - offset);
+
+	m_consumedTokenCount += pos + 1 - m_pos;
+	m_pos = pos + 1;
+	m_maxPos = (std::max)(m_maxPos, m_pos);
+	++m_lazyFunctionCount;
+
+	return spLazyBody;
+}
+
+// 함수 파라미터 규칙
+// "( )" 또는 "( 파라미터 리스트 )"
+BasePtr TokenParser::parseFunctionParameter()
+{
+	const size_t pos = m_pos;
+	if (acceptSymbol(ETokenSymbol::LParen))
+	{
+		if (acceptSymbol(ETokenSymbol::RParen))
+			return MakeNode<FunctionParameter>();
+
+		BasePtr spNameList = parseNameList();
+		if (spNameList && acceptSymbol(ETokenSymbol::RParen))
+			return MakeNode<FunctionParameter>(spNameList);
+	}
+
+	m_pos = pos;
+	return nullptr;
+}
+
+// 함수 인자 규칙
+// "( )" 또는 "( 인자 리스트 )"
+BasePtr TokenParser::parseFunctionArgument()
+{
+	const size_t pos = m_pos;
+	if (acceptSymbol(ETokenSymbol::LParen))
+	{
+		if (acceptSymbol(ETokenSymbol::RParen))
+			return MakeNode<FunctionArgument>();
+
+		BasePtr spExpressionList = parseExpressionList();
+		if (spExpressionList && acceptSymbol(ETokenSymbol::RParen))
+			return MakeNode<FunctionArgument>(spExpressionList);
+	}
+
+	m_pos = pos;
+	return nullptr;
+}
+
+// 이름 또는 함수 호출 규칙
+// "이름" 또는 "함수이름 함수인자". 이름을 한 번만 파싱하고 함수인자가 이어지는지 확인한다.
+BasePtr TokenParser::parseNameOrFunctionCall()
+{
+	BasePtr spName = parseName();
+	if (!spName)
+		return nullptr;
+
+	if (BasePtr spFunctionArgument = parseFunctionArgument())
+		return MakeNode<FunctionCall>(spName, spFunctionArgument);
+
+	return spName;
+}
+
+// 변수 할당 규칙
+// "변수이름 = 표현식"
+BasePtr TokenParser::parseAssignment()
+{
+	const size_t pos = m_pos;
+	if (BasePtr spName = parseName())
+	{
+		if (acceptSymbol(ETokenSymbol::Assign))
+		{
+			if (BasePtr spExpression = parseExpression())
+				return MakeNode<Assignment>(spName, spExpression);
+		}
+	}
+
+	m_pos = pos;
+	return nullptr;
+}
+
+// If문 규칙
+BasePtr TokenParser::parseIf()
+{
+	const size_t pos = m_pos;
+	const size_t functionCount = m_functions.size();
+	if (acceptKeyword(ETokenKeyword::If))
+	{
+		BasePtr spExpression = parseExpression();
+		BasePtr spBlock = (spExpression && acceptKeyword(ETokenKeyword::Then)) ? parseBlock() : nullptr;
+		if (spBlock && acceptKeyword(ETokenKeyword::End))
+			return MakeNode<If>(spExpression, spBlock, nullptr);
+	}
+
+	// 실패한 if문의 본문에서 파싱한 함수를 버린다.
+	m_functions.resize(functionCount);
+	m_pos = pos;
+	return nullptr;
+}
+
+// 구문 규칙
+// 구문은 if문, for문, 함수선언, 변수선언, 표현식 등을 말한다.
+// 첫 토큰(변수 할당은 두 번째 토큰까지)을 보고 규칙을 선택하므로 실패한 규칙을 되돌아가 다시 파싱하지 않는다.
+BasePtr TokenParser::parseStatement()
+{
+	const Token& token = peek();
+	if (token.IsKeyword(ETokenKeyword::Function))
+		return parseFunctionDefinition();
+	if (token.IsKeyword(ETokenKeyword::If))
+		return parseIf();
+
+	if (ETokenType::Name == token.eType && peekNext().IsSymbol(ETokenSymbol::Assign))
+	{
+		if (BasePtr spAssignment = parseAssignment())
+			return spAssignment;
+	}
+
+	return parseExpression();
+}
+
+// 블록 규칙
+// 블록은 구문이 1개 이상 나열되어 있는것을 말한다.
+BasePtr TokenParser::parseBlock()
+{
+	std::vector<BasePtr> statements;
+	while (BasePtr spStatement = parseStatement())
+		statements.push_back(spStatement);
+
+	if (statements.empty())
+		return nullptr;
+
+	return MakeNode<Block>(statements);
+}
+
+}
@@ -0,0 +1,161 @@
+﻿#pragma once
+
+#include "lexer.h"
+
+namespace dsl
+{
+	// 이항연산자 표현식 파싱 방식
+	enum class EExpressionParser
+	{
+		Precedence,		// 연산자 테이블을 사용하는 precedence climbing
+		Cascade,		// 우선순위 단계별 규칙을 차례로 내려가는 방식 (dsl_grammar와 같음. 비교용)
+	};
+
+	// 지연 파싱하는 함수 본문
+	// lazy 모드의 TokenParser는 함수 본문을 파싱하지 않고 소스 범위만 기록한다. 본문은 처음 사용할 때 파싱한다.
+	// 같은 스크립트의 함수들은 스크립트 텍스트를 공유한다.
+	class LazyFunctionBody
+	{
+	public:
+		LazyFunctionBody(std::shared_ptr<const std::string> spUtf8Source, const size_t offset, const size_t length);
+
+		LazyFunctionBody(const LazyFunctionBody&) = delete;
+		LazyFunctionBody& operator=(const LazyFunctionBody&) = delete;
+
+	public:
+		// 본문을 파싱해서 Block을 반환한다. 실패하면 nullptr를 반환한다.
+		// 여러 스레드에서 동시에 처음 호출하더라도 한 번만 파싱하고, 나머지 스레드는 파싱이 끝날 때까지 기다린다.
+		const BasePtr& Materialize();
+
+		// 본문을 파싱했는지 여부
+		bool IsMaterialized() const { return m_bMaterialized.load(std::memory_order_acquire); }
+
+		// 파싱한 Block. 파싱하기 전이거나 실패했다면 nullptr
+		BasePtr GetBlock() const { return IsMaterialized() ? m_spBlock : nullptr; }
+
+		// 스크립트 텍스트에서 본문의 위치와 길이 (bytes)
+		size_t GetOffset() const { return m_offset; }
+		size_t GetLength() const { return m_length; }
+
+		// 본문을 파싱할 때 래퍼 노드를 제거한다. (NormalizeAST) 이미 파싱한 본문은 바꾸지 않는다.
+		// AST를 다른 스레드에 공개하기 전에 호출한다.
+		void SetNormalize() { m_bNormalize = true; }
+
+	private:
+		std::shared_ptr<const std::string>	m_spUtf8Source;		// 스크립트 텍스트. 본문을 파싱한 다음 해제한다.
+		ConstantPoolPtr		m_spConstantPool;	// 스크립트의 상수 풀. 생성할 때 현재 스레드의 풀을 보관한다.
+		size_t				m_offset;
+		size_t				m_length;
+		bool				m_bNormalize;
+
+		std::once_flag		m_once;
+		std::atomic<bool>	m_bMaterialized;
+		BasePtr				m_spBlock;
+	};
+
+
+	// 토큰 파서
+	// 렉서가 만든 토큰 배열을 읽어서 AST를 만든다. 규칙 구성은 dsl_grammar와 같으며, 같은 AST를 만든다.
+	class TokenParser
+	{
+	public:
+		TokenParser(std::wstring_view strScript, const TokenList& tokens, const EExpressionParser eExpressionParser = EExpressionParser::Precedence);
+
+		// UTF-8 스크립트. 이름과 문자열 토큰만 AST를 만들 때 wchar_t 문자열로 변환한다.
+		TokenParser(std::string_view strUtf8Script, const TokenList& tokens, const EExpressionParser eExpressionParser = EExpressionParser::Precedence);
+
+	public:
+		// AST를 만든다. 모든 토큰을 소비하지 못하면 nullptr를 반환한다.
+		ASTPtr ParseAST();
+
+		// 파싱이 멈춘 위치(소스 offset)
+		size_t GetStopOffset() const;
+
+		// 앞부분이라도 파싱에 성공했는지 여부
+		bool HasMatched() const { return m_pos > 0; }
+
+		// 토큰을 소비한 횟수. 백트래킹으로 다시 소비한 토큰도 포함한다.
+		size_t GetConsumedTokenCount() const { return m_consumedTokenCount; }
+
+		// 백트래킹으로 다시 소비한 토큰의 문자 수
+		size_t GetRescanLength() const { return m_rescanLength; }
+
+		// 함수 본문을 지연 파싱한다. (UTF-8 스크립트만 지원)
+		// 함수 본문은 짝이 맞는 end 까지 키워드만 세면서 건너뛰고, 소스 범위를 LazyFunctionBody로 기록한다.
+		// 본문 안에 함수 정의가 있으면 바로 파싱한다. 중첩 함수도 로드할 때 등록해야 하기 때문이다.
+		// @spUtf8Source	: 파싱하는 스크립트 텍스트. 생성자에 전달한 strUtf8Script와 같은 버퍼여야 한다.
+		void SetLazyFunctionBody(std::shared_ptr<const std::string> spUtf8Source) { m_spLazySource = std::move(spUtf8Source); }
+
+		// 본문 파싱을 미룬 함수 수
+		size_t GetLazyFunctionCount() const { return m_lazyFunctionCount; }
+
+		// 파싱하면서 만든 함수 정의. AST를 전위 순회한 순서와 같다. (바깥 함수가 안쪽 함수보다 앞에 있다.)
+		// 사용자 함수를 등록할 때 AST를 다시 순회하지 않기 위해서 사용한다.
+		const std::vector<FunctionDefinitionCPtr>& GetFunctions() const { return m_functions; }
+		std::vector<FunctionDefinitionCPtr> TakeFunctions() { return std::move(m_functions); }
+
+	public:
+		// 최상위 구문을 하나씩 파싱한다. (StreamParser)
+		// 현재 위치에서 구문 하나를 파싱한다. 실패하면 nullptr를 반환하고 위치는 구문 시작으로 되돌아간다.
+		BasePtr ParseStatement() { return parseStatement(); }
+
+		// 모든 토큰을 소비했는지 여부
+		bool IsEnd() const { return ETokenType::End == peek().eType; }
+
+		// 현재 토큰 위치
+		size_t GetPosition() const { return m_pos; }
+
+		// 지금까지 읽은 가장 먼 토큰 위치. 이 위치의 토큰과 그 다음 토큰까지 peek 했을 수 있다.
+		size_t GetFurthestPosition() const { return m_maxPos; }
+
+	private:
+		const Token& peek() const { return m_tokens[m_pos]; }
+		const Token& peekNext() const { return m_tokens[(std::min)(m_pos + 1, m_tokens.size() - 1)]; }
+		const Token& next();
+		std::wstring getText(const Token& token) const;
+
+		bool acceptKeyword(const ETokenKeyword eKeyword);
+		bool acceptSymbol(const ETokenSymbol eSymbol);
+
+		BasePtr parseName();
+		BasePtr parseNameList();
+		BasePtr parseBoolean();
+		BasePtr parseLiteralString();
+		BasePtr parseNumeral();
+
+		BasePtr parsePrimaryExpression();
+		BasePtr parseOperatorUnary();
+		BasePtr parseOperatorBinary(const int level);
+		BasePtr parseOperatorPrecedence(const int minBindingPower);
+		BasePtr parseExpression();
+		BasePtr parseExpressionList();
+
+		BasePtr parseFunctionDefinition();
+		std::shared_ptr<LazyFunctionBody> parseLazyFunctionBody();
+		BasePtr parseFunctionParameter();
+		BasePtr parseFunctionArgument();
+		BasePtr parseNameOrFunctionCall();
+
+		BasePtr parseAssignment();
+		BasePtr parseIf();
+		BasePtr parseStatement();
+		BasePtr parseBlock();
+
+	private:
+		std::wstring_view	m_strScript;
+		std::string_view	m_strUtf8Script;
+		bool				m_bUtf8;				// m_strUtf8Script를 사용하는지 여부
+		const TokenList&	m_tokens;
+		size_t				m_pos;		// 현재 토큰 위치
+		EExpressionParser	m_eExpressionParser;
+
+		size_t				m_maxPos;				// 지금까지 소비한 가장 먼 토큰 위치
+		size_t				m_consumedTokenCount;
+		size_t				m_rescanLength;
+
+		std::shared_ptr<const std::string>	m_spLazySource;		// nullptr가 아니면 함수 본문을 지연 파싱한다.
+		size_t				m_lazyFunctionCount;
+
+		std::vector<FunctionDefinitionCPtr>	m_functions;	// 파싱한 함수 정의. 함수를 파싱하기 시작할 때 자리를 잡아두므로 전위 순회 순서가 된다.
+	};
+}